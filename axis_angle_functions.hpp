@@ -8,10 +8,12 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 
 #include "axis_angle.hpp"
 
 #include "mat.hpp"
+#include "mat_functions.hpp"
 #include "quat.hpp"
 #include "generators.hpp"
 
@@ -19,13 +21,13 @@ namespace ee {
 namespace math {
 
 /**
- * Return the matrix describing axis_angle rotation.
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * axis_angle rotation.
  * Based on Rodrigues' rotation formula.
  */
-template <typename T>
-mat<T, 4 ,4> mat_from(const axis_angle<T>& aa) {
-    const T cos_theta = std::cos(aa.angle);
-    const T sin_theta = std::sin(aa.angle);
+template <std::size_t R, std::size_t C, typename T, typename P = precise>
+constexpr mat<T, R, C> mat_from(const axis_angle<T>& aa, P p = {}) {
+    const auto [sin_theta, cos_theta] = sincos(aa.angle, p);
 
     const T one_minus_cos_theta = T{1L} - cos_theta;
 
@@ -40,36 +42,39 @@ mat<T, 4 ,4> mat_from(const axis_angle<T>& aa) {
     const T y_sin_t = aa.axis(1) * sin_theta;
     const T z_sin_t = aa.axis(2) * sin_theta;
 
-    return {
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
         // X axis
         xx_1_minus_cos_t + cos_theta,
         xy_1_minus_cos_t + z_sin_t,
         xz_1_minus_cos_t - y_sin_t,
-        T{0L},
 
         // Y axis
         xy_1_minus_cos_t - z_sin_t,
         yy_1_minus_cos_t + cos_theta,
         yz_1_minus_cos_t + x_sin_t,
-        T{0L},
 
         // Z axis
         xz_1_minus_cos_t + y_sin_t,
         yz_1_minus_cos_t - x_sin_t,
-        zz_1_minus_cos_t + cos_theta,
-        T{0L},
+        zz_1_minus_cos_t + cos_theta});
+}
 
-        T{0L}, T{0L}, T{0L}, T{1L}};
+/**
+ * Return the matrix describing axis_angle rotation.
+ */
+template <typename T, typename P = precise>
+constexpr mat<T, 4 ,4> mat_from(const axis_angle<T>& aa, P p = {}) {
+    return mat_from<4, 4>(aa, p);
 }
 
 /**
  * Return the quaternion describing axis_angle rotation.
  */
-template <typename T>
-quat<T> quat_from(const axis_angle<T>& aa) {
-    const T ha = aa.angle * T{0.5L};
+template <typename T, typename P = precise>
+constexpr quat<T> quat_from(const axis_angle<T>& aa, P p = {}) {
+    const auto [sin_ha, cos_ha] = sincos(aa.angle * T{0.5L}, p);
 
-    return as<quat<T>>(aa.axis * std::sin(ha), std::cos(ha));
+    return as<quat<T>>(aa.axis * sin_ha, cos_ha);
 }
 
 /**
@@ -77,10 +82,9 @@ quat<T> quat_from(const axis_angle<T>& aa) {
  * To rotate several points, better creating a rotation matrix or a quaternion.
  * For right handed basis.
  */
-template <typename T>
-vec<T, 3> rotate(const axis_angle<T>& aa, const vec<T, 3>& v) {
-    const T cos_a = std::cos(aa.angle);
-    const T sin_a = std::sin(aa.angle);
+template <typename T, typename P = precise>
+constexpr vec<T, 3> rotate(const axis_angle<T>& aa, const vec<T, 3>& v, P p = {}) {
+    const auto [sin_a, cos_a] = sincos(aa.angle, p);
 
     return
         v * cos_a +
@@ -7,11 +7,196 @@
 
 #pragma once
 
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 #include "basis.hpp"
+#include "mat_functions.hpp"
 
 namespace ee {
 namespace math {
 
+namespace detail {
+
+/**
+ * Signed permutation of 3D components, known at compile time : component n
+ * of the result is component index[n] of the input, negated when sign[n] is
+ * -1. angle is -1 when the permutation changes handedness, quaternions then
+ * also negate their vector part to describe the same rotation.
+ */
+struct signed_permutation {
+    int index[3];
+    int sign[3];
+    int angle;
+};
+
+/**
+ * Rows of │I J K│ : each of I, J and K has a single non null component.
+ */
+template <typename B>
+constexpr signed_permutation permutation_of() {
+    constexpr vec<int, 3> axes[3] = {
+        B::i::template v<int>,
+        B::j::template v<int>,
+        B::k::template v<int>};
+
+    signed_permutation p{};
+
+    for (int n = 0; n < 3; ++ n) {
+        for (int c = 0; c < 3; ++ c) {
+            if (axes[n](c) != 0) {
+                p.index[n] = c;
+                p.sign[n]  = axes[n](c);
+            }
+        }
+    }
+
+    p.angle = initial_basis::is_right_handed == B::is_right_handed ? 1 : -1;
+
+    return p;
+}
+
+constexpr signed_permutation inverse(const signed_permutation& p) {
+    signed_permutation result{};
+
+    for (int n = 0; n < 3; ++ n) {
+        result.index[p.index[n]] = n;
+        result.sign[p.index[n]]  = p.sign[n];
+    }
+
+    result.angle = p.angle;
+
+    return result;
+}
+
+/**
+ * p, then q.
+ */
+constexpr signed_permutation compose(const signed_permutation& p, const signed_permutation& q) {
+    signed_permutation result{};
+
+    for (int n = 0; n < 3; ++ n) {
+        result.index[n] = p.index[q.index[n]];
+        result.sign[n]  = p.sign[q.index[n]] * q.sign[n];
+    }
+
+    result.angle = p.angle * q.angle;
+
+    return result;
+}
+
+/**
+ * Permutations as types, to be used as template arguments.
+ */
+template <typename B>
+struct to_basis_permutation {
+    constexpr static signed_permutation value = permutation_of<B>();
+};
+
+template <typename B>
+struct from_basis_permutation {
+    constexpr static signed_permutation value = inverse(permutation_of<B>());
+};
+
+template <typename P, typename Q>
+struct composed_permutation {
+    constexpr static signed_permutation value = compose(P::value, Q::value);
+};
+
+/**
+ * Index and sign of component n, homogeneous component 3 being left as is.
+ */
+template <typename P>
+constexpr int index_of(std::size_t n) {
+    return n < 3 ? P::value.index[n] : static_cast<int>(n);
+}
+
+template <typename P>
+constexpr int sign_of(std::size_t n) {
+    return n < 3 ? P::value.sign[n] : 1;
+}
+
+/**
+ * t, negated when S is negative : a sign flip, never a multiplication.
+ */
+template <int S, typename T>
+constexpr T signed_as(const T& t) {
+    if constexpr (S < 0) {
+        return - t;
+    }
+    else {
+        return t;
+    }
+}
+
+template <typename P, typename T>
+constexpr vec<T, 3> permute(const vec<T, 3>& v) {
+    return {
+        signed_as<sign_of<P>(0)>(v(index_of<P>(0))),
+        signed_as<sign_of<P>(1)>(v(index_of<P>(1))),
+        signed_as<sign_of<P>(2)>(v(index_of<P>(2)))};
+}
+
+/**
+ * Vector part as vectors, angle switched by P::value.angle.
+ */
+template <typename P, typename T>
+constexpr quat<T> permute(const quat<T>& q) {
+    constexpr int a = P::value.angle;
+
+    if constexpr (simd::is_native<quat<T>>) {
+        if (! is_constant_evaluated()) {
+            return simd::swizzle<
+                index_of<P>(0), index_of<P>(1), index_of<P>(2), 3,
+                sign_of<P>(0) * a, sign_of<P>(1) * a, sign_of<P>(2) * a, 1>(q);
+        }
+    }
+
+    return {
+        signed_as<sign_of<P>(0) * a>(q(index_of<P>(0))),
+        signed_as<sign_of<P>(1) * a>(q(index_of<P>(1))),
+        signed_as<sign_of<P>(2) * a>(q(index_of<P>(2))),
+        q(3)};
+}
+
+/**
+ * M'(r, c) = M(index r, index c), negated when signs of r and c differ, i.e.
+ * P ∙ M ∙ transpose(P) for the mat4x4 P of the permutation.
+ */
+template <typename P, std::size_t N, typename M>
+constexpr typename M::value_type permuted_at(const M& m) {
+    constexpr std::size_t r = N / M::columns;
+    constexpr std::size_t c = N % M::columns;
+
+    return signed_as<sign_of<P>(r) * sign_of<P>(c)>(m(index_of<P>(r), index_of<P>(c)));
+}
+
+template <typename P, typename T, std::size_t R, std::size_t C, typename L, std::size_t... Ns>
+constexpr mat<T, R, C, L> permute(const mat<T, R, C, L>& m, std::index_sequence<Ns...>) {
+    mat<T, R, C, L> result{};
+
+    ((result(Ns / C, Ns % C) = permuted_at<P, Ns>(m)), ...);
+
+    return result;
+}
+
+template <typename P, typename T, std::size_t R, std::size_t C, typename L>
+constexpr mat<T, R, C, L> permute(const mat<T, R, C, L>& m) {
+    if constexpr (simd::is_native_mat4<mat<T, R, C, L>> && std::is_same<T, float>::value) {
+        if (! is_constant_evaluated()) {
+            return simd::swizzle<
+                index_of<P>(0), index_of<P>(1), index_of<P>(2), 3,
+                sign_of<P>(0), sign_of<P>(1), sign_of<P>(2), 1>(m);
+        }
+    }
+
+    return permute<P>(m, std::make_index_sequence<R * C>{});
+}
+
+} // namespace detail
+
 /**
  * Express 3D cartesian coordinates in B.
  * Input cartesian coordinates must come from basis<xpos, ypos, zpos>.
@@ -22,27 +207,12 @@ namespace math {
  *  │y'│ = │Jx Jy Jz│ ∙ │y│
  *  │z'│   │Kx Ky Kz│   │z│
  *
- * But (relying on I, J, K constraints) coded in a more constant expression way.
+ * But, B being known at compile time, done as a signed permutation : only
+ * moves and sign flips, no multiplication.
  */
 template <typename B, typename T>
 constexpr vec<T, 3> to_basis(const vec<T, 3>& v) {
-    constexpr auto i = B::i::template v<int>;
-    constexpr auto j = B::j::template v<int>;
-    constexpr auto k = B::k::template v<int>;
-
-    constexpr int i_index  = (i(0) ? 0 : 0) + (i(1) ? 1 : 0) + (i(2) ? 2 : 0);
-    constexpr int i_switch =  i(0)      +      i(1)      +      i(2);
-
-    constexpr int j_index  = (j(0) ? 0 : 0) + (j(1) ? 1 : 0) + (j(2) ? 2 : 0);
-    constexpr int j_switch =  j(0)      +      j(1)      +      j(2);
-
-    constexpr int k_index  = (k(0) ? 0 : 0) + (k(1) ? 1 : 0) + (k(2) ? 2 : 0);
-    constexpr int k_switch =  k(0)      +      k(1)      +      k(2);
-
-    return {
-        i_switch * v(i_index),
-        j_switch * v(j_index),
-        k_switch * v(k_index)};
+    return detail::permute<detail::to_basis_permutation<B>>(v);
 }
 
 /**
@@ -55,7 +225,8 @@ constexpr vec<T, 3> to_basis(const vec<T, 3>& v) {
  *       │Kx Ky Kz 0│       │Iz Jz Kz 0│
  *       │ 0  0  0 1│       │ 0  0  0 1│
  *
- * But (relying on I, J, K constraints) coded in a more constant expression way.
+ * But, B being known at compile time, done as a signed permutation : only
+ * moves and sign flips, no multiplication.
  *
  * So, when we do :
  *
@@ -65,41 +236,27 @@ constexpr vec<T, 3> to_basis(const vec<T, 3>& v) {
  *
  * p' = to_basis< B >( M * from_basis< B >( p ) )
  */
-template <typename B, typename T>
-constexpr mat<T, 4, 4> to_basis(const mat<T, 4, 4>& m) {
-    constexpr auto i = B::i::template v<int>;
-    constexpr auto j = B::j::template v<int>;
-    constexpr auto k = B::k::template v<int>;
-
-    constexpr int i_index  = (i(0) ? 0 : 0) + (i(1) ? 1 : 0) + (i(2) ? 2 : 0);
-    constexpr int i_switch =  i(0)      +      i(1)      +      i(2);
-
-    constexpr int j_index  = (j(0) ? 0 : 0) + (j(1) ? 1 : 0) + (j(2) ? 2 : 0);
-    constexpr int j_switch =  j(0)      +      j(1)      +      j(2);
-
-    constexpr int k_index  = (k(0) ? 0 : 0) + (k(1) ? 1 : 0) + (k(2) ? 2 : 0);
-    constexpr int k_switch =  k(0)      +      k(1)      +      k(2);
-
-    return {
-        i_switch * i_switch * m(i_index, i_index),
-        i_switch * j_switch * m(j_index, i_index),
-        i_switch * k_switch * m(k_index, i_index),
-        i_switch            * m(   3   , i_index),
-
-        j_switch * i_switch * m(i_index, j_index),
-        j_switch * j_switch * m(j_index, j_index),
-        j_switch * k_switch * m(k_index, j_index),
-        j_switch            * m(   3   , j_index),
+template <typename B, typename T, typename L>
+constexpr mat<T, 4, 4, L> to_basis(const mat<T, 4, 4, L>& m) {
+    return detail::permute<detail::to_basis_permutation<B>>(m);
+}
 
-        k_switch * i_switch * m(i_index, k_index),
-        k_switch * j_switch * m(j_index, k_index),
-        k_switch * k_switch * m(k_index, k_index),
-        k_switch            * m(   3   , k_index),
+/**
+ * Express affine transformation mat3x4 in B.
+ * Same as the mat4x4 overload, implicit last row being 0 0 0 1.
+ */
+template <typename B, typename T, typename L>
+constexpr mat<T, 3, 4, L> to_basis(const mat<T, 3, 4, L>& m) {
+    return detail::permute<detail::to_basis_permutation<B>>(m);
+}
 
-                   i_switch * m(i_index,    3   ),
-                   j_switch * m(j_index,    3   ),
-                   k_switch * m(k_index,    3   ),
-                              m(   3   ,    3   )};
+/**
+ * Express rotation mat3x3 in B.
+ * Same as the mat4x4 overload, on its upper-left part only.
+ */
+template <typename B, typename T, typename L>
+constexpr mat<T, 3, 3, L> to_basis(const mat<T, 3, 3, L>& m) {
+    return detail::permute<detail::to_basis_permutation<B>>(m);
 }
 
 /**
@@ -111,27 +268,7 @@ constexpr mat<T, 4, 4> to_basis(const mat<T, 4, 4>& m) {
  */
 template <typename B, typename T>
 constexpr quat<T> to_basis(const quat<T>& q) {
-    constexpr auto i = B::i::template v<int>;
-    constexpr auto j = B::j::template v<int>;
-    constexpr auto k = B::k::template v<int>;
-
-    constexpr int angle_switch =
-        initial_basis::is_right_handed == B::is_right_handed ? 1 : -1;
-
-    constexpr int i_index  = (i(0) ? 0 : 0) + (i(1) ? 1 : 0) + (i(2) ? 2 : 0);
-    constexpr int i_switch = (i(0)      +      i(1)      +      i(2)) * angle_switch;
-
-    constexpr int j_index  = (j(0) ? 0 : 0) + (j(1) ? 1 : 0) + (j(2) ? 2 : 0);
-    constexpr int j_switch = (j(0)      +      j(1)      +      j(2)) * angle_switch;
-
-    constexpr int k_index  = (k(0) ? 0 : 0) + (k(1) ? 1 : 0) + (k(2) ? 2 : 0);
-    constexpr int k_switch = (k(0)      +      k(1)      +      k(2)) * angle_switch;
-
-    return {
-        i_switch * q(i_index),
-        j_switch * q(j_index),
-        k_switch * q(k_index),
-        q(3)};
+    return detail::permute<detail::to_basis_permutation<B>>(q);
 }
 
 /**
@@ -144,27 +281,12 @@ constexpr quat<T> to_basis(const quat<T>& q) {
  *  │y'│ = │Iy Jy Ky│ ∙ │y│
  *  │z'│   │Iz Jz Kz│   │z│
  *
- * But (relying on I, J, K constraints) coded in a more constant expression way.
+ * But, B being known at compile time, done as a signed permutation : only
+ * moves and sign flips, no multiplication.
  */
 template <typename B, typename T>
 constexpr vec<T, 3> from_basis(const vec<T, 3>& v) {
-    constexpr auto i = B::i::template v<int>;
-    constexpr auto j = B::j::template v<int>;
-    constexpr auto k = B::k::template v<int>;
-
-    constexpr int x_index  = (i(0) ? 0 : 0) + (j(0) ? 1 : 0) + (k(0) ? 2 : 0);
-    constexpr int x_switch =  i(0)      +      j(0)      +      k(0);
-
-    constexpr int y_index  = (i(1) ? 0 : 0) + (j(1) ? 1 : 0) + (k(1) ? 2 : 0);
-    constexpr int y_switch =  i(1)      +      j(1)      +      k(1);
-
-    constexpr int z_index  = (i(2) ? 0 : 0) + (j(2) ? 1 : 0) + (k(2) ? 2 : 0);
-    constexpr int z_switch =  i(2)      +      j(2)      +      k(2);
-
-    return {
-        x_switch * v(x_index),
-        y_switch * v(y_index),
-        z_switch * v(z_index)};
+    return detail::permute<detail::from_basis_permutation<B>>(v);
 }
 
 /**
@@ -177,7 +299,8 @@ constexpr vec<T, 3> from_basis(const vec<T, 3>& v) {
  *       │Iz Jz Kz 0│       │Kx Ky Kz 0│
  *       │ 0  0  0 1│       │ 0  0  0 1│
  *
- * But (relying on I, J, K constraints) coded in a more constant expression way.
+ * But, B being known at compile time, done as a signed permutation : only
+ * moves and sign flips, no multiplication.
  *
  * So, when we do :
  *
@@ -187,41 +310,27 @@ constexpr vec<T, 3> from_basis(const vec<T, 3>& v) {
  *
  * p' = from_basis< B >( M * to_basis< B >( p ) )
  */
-template <typename B, typename T>
-constexpr mat<T, 4, 4> from_basis(const mat<T, 4, 4>& m) {
-    constexpr auto i = B::i::template v<int>;
-    constexpr auto j = B::j::template v<int>;
-    constexpr auto k = B::k::template v<int>;
-
-    constexpr int x_index  = (i(0) ? 0 : 0) + (j(0) ? 1 : 0) + (k(0) ? 2 : 0);
-    constexpr int x_switch =  i(0)      +      j(0)      +      k(0);
-
-    constexpr int y_index  = (i(1) ? 0 : 0) + (j(1) ? 1 : 0) + (k(1) ? 2 : 0);
-    constexpr int y_switch =  i(1)      +      j(1)      +      k(1);
-
-    constexpr int z_index  = (i(2) ? 0 : 0) + (j(2) ? 1 : 0) + (k(2) ? 2 : 0);
-    constexpr int z_switch =  i(2)      +      j(2)      +      k(2);
-
-    return {
-        x_switch * x_switch * m(x_index, x_index),
-        x_switch * y_switch * m(y_index, x_index),
-        x_switch * z_switch * m(z_index, x_index),
-        x_switch            * m(   3   , x_index),
-
-        y_switch * x_switch * m(x_index, y_index),
-        y_switch * y_switch * m(y_index, y_index),
-        y_switch * z_switch * m(z_index, y_index),
-        y_switch            * m(   3   , y_index),
+template <typename B, typename T, typename L>
+constexpr mat<T, 4, 4, L> from_basis(const mat<T, 4, 4, L>& m) {
+    return detail::permute<detail::from_basis_permutation<B>>(m);
+}
 
-        z_switch * x_switch * m(x_index, z_index),
-        z_switch * y_switch * m(y_index, z_index),
-        z_switch * z_switch * m(z_index, z_index),
-        z_switch            * m(   3   , z_index),
+/**
+ * Express affine transformation mat3x4 in basis<xpos, ypos, zpos>.
+ * Same as the mat4x4 overload, implicit last row being 0 0 0 1.
+ */
+template <typename B, typename T, typename L>
+constexpr mat<T, 3, 4, L> from_basis(const mat<T, 3, 4, L>& m) {
+    return detail::permute<detail::from_basis_permutation<B>>(m);
+}
 
-                   x_switch * m(x_index,    3   ),
-                   y_switch * m(y_index,    3   ),
-                   z_switch * m(z_index,    3   ),
-                              m(   3   ,    3   )};
+/**
+ * Express rotation mat3x3 in basis<xpos, ypos, zpos>.
+ * Same as the mat4x4 overload, on its upper-left part only.
+ */
+template <typename B, typename T, typename L>
+constexpr mat<T, 3, 3, L> from_basis(const mat<T, 3, 3, L>& m) {
+    return detail::permute<detail::from_basis_permutation<B>>(m);
 }
 
 /**
@@ -233,177 +342,232 @@ constexpr mat<T, 4, 4> from_basis(const mat<T, 4, 4>& m) {
  */
 template <typename B, typename T>
 constexpr quat<T> from_basis(const quat<T>& q) {
-    constexpr auto i = B::i::template v<int>;
-    constexpr auto j = B::j::template v<int>;
-    constexpr auto k = B::k::template v<int>;
+    return detail::permute<detail::from_basis_permutation<B>>(q);
+}
 
-    constexpr int angle_switch =
-        initial_basis::is_right_handed == B::is_right_handed ? 1 : -1;
+/**
+ * Express v, m or q, coming from basis From, in basis To.
+ * Same as to_basis<To>(from_basis<From>(x)), both permutations being
+ * composed at compile time so that chained conversions cost a single one,
+ * nothing at all when From and To are the same basis. Transformation
+ * matrices of a constant expression are converted at compile time too.
+ */
+template <typename From, typename To, typename T>
+constexpr vec<T, 3> change_basis(const vec<T, 3>& v) {
+    return detail::permute<detail::composed_permutation<
+        detail::from_basis_permutation<From>, detail::to_basis_permutation<To>>>(v);
+}
 
-    constexpr int x_index  = (i(0) ? 0 : 0) + (j(0) ? 1 : 0) + (k(0) ? 2 : 0);
-    constexpr int x_switch = (i(0)      +      j(0)      +      k(0)) * angle_switch;
+template <typename From, typename To, typename T, std::size_t R, std::size_t C, typename L>
+constexpr mat<T, R, C, L> change_basis(const mat<T, R, C, L>& m) {
+    static_assert(R >= 3 && R <= 4 && C >= 3 && C <= 4, "only mat3x3, mat3x4 and mat4x4 can be converted");
 
-    constexpr int y_index  = (i(1) ? 0 : 0) + (j(1) ? 1 : 0) + (k(1) ? 2 : 0);
-    constexpr int y_switch = (i(1)      +      j(1)      +      k(1)) * angle_switch;
+    return detail::permute<detail::composed_permutation<
+        detail::from_basis_permutation<From>, detail::to_basis_permutation<To>>>(m);
+}
 
-    constexpr int z_index  = (i(2) ? 0 : 0) + (j(2) ? 1 : 0) + (k(2) ? 2 : 0);
-    constexpr int z_switch = (i(2)      +      j(2)      +      k(2)) * angle_switch;
+template <typename From, typename To, typename T>
+constexpr quat<T> change_basis(const quat<T>& q) {
+    return detail::permute<detail::composed_permutation<
+        detail::from_basis_permutation<From>, detail::to_basis_permutation<To>>>(q);
+}
 
-    return {
-        x_switch * q(x_index),
-        y_switch * q(y_index),
-        z_switch * q(z_index),
-        q(3)};
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation of angle a around xpos axis.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> mat_from(T a, xpos) {
+    const T cos_a = cos(a);
+    const T sin_a = sin(a);
+
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
+        T{1L},   T{0L}, T{0L},
+        T{0L},   cos_a, sin_a,
+        T{0L}, - sin_a, cos_a});
 }
 
 /**
  * Return the matrix describing rotation of angle a around xpos axis.
  */
 template <typename T>
-mat<T, 4, 4> mat_from(T a, xpos) {
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
+constexpr mat<T, 4, 4> mat_from(T a, xpos) {
+    return mat_from<4, 4>(a, xpos{});
+}
 
-    return {
-        T{1L},   T{0L}, T{0L}, T{0L},
-        T{0L},   cos_a, sin_a, T{0L},
-        T{0L}, - sin_a, cos_a, T{0L},
-        T{0L},   T{0L}, T{0L}, T{1L}};
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation of angle a around xneg axis.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> mat_from(T a, xneg) {
+    const T cos_a = cos(a);
+    const T sin_a = sin(a);
+
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
+        T{1L}, T{0L},   T{0L},
+        T{0L}, cos_a, - sin_a,
+        T{0L}, sin_a,   cos_a});
 }
 
 /**
  * Return the matrix describing rotation of angle a around xneg axis.
  */
 template <typename T>
-mat<T, 4, 4> mat_from(T a, xneg) {
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
+constexpr mat<T, 4, 4> mat_from(T a, xneg) {
+    return mat_from<4, 4>(a, xneg{});
+}
 
-    return {
-        T{1L}, T{0L},   T{0L}, T{0L},
-        T{0L}, cos_a, - sin_a, T{0L},
-        T{0L}, sin_a,   cos_a, T{0L},
-        T{0L}, T{0L},   T{0L}, T{1L}};
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation of angle a around ypos axis.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> mat_from(T a, ypos) {
+    const T cos_a = cos(a);
+    const T sin_a = sin(a);
+
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
+        cos_a, T{0L}, - sin_a,
+        T{0L}, T{1L},   T{0L},
+        sin_a, T{0L},   cos_a});
 }
 
 /**
  * Return the matrix describing rotation of angle a around ypos axis.
  */
 template <typename T>
-mat<T, 4, 4> mat_from(T a, ypos) {
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
+constexpr mat<T, 4, 4> mat_from(T a, ypos) {
+    return mat_from<4, 4>(a, ypos{});
+}
 
-    return {
-        cos_a, T{0L}, - sin_a, T{0L},
-        T{0L}, T{1L},   T{0L}, T{0L},
-        sin_a, T{0L},   cos_a, T{0L},
-        T{0L}, T{0L},   T{0L}, T{1L}};
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation of angle a around yneg axis.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> mat_from(T a, yneg) {
+    const T cos_a = cos(a);
+    const T sin_a = sin(a);
+
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
+          cos_a, T{0L}, sin_a,
+          T{0L}, T{1L}, T{0L},
+        - sin_a, T{0L}, cos_a});
 }
 
 /**
  * Return the matrix describing rotation of angle a around yneg axis.
  */
 template <typename T>
-mat<T, 4, 4> mat_from(T a, yneg) {
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
+constexpr mat<T, 4, 4> mat_from(T a, yneg) {
+    return mat_from<4, 4>(a, yneg{});
+}
 
-    return {
-          cos_a, T{0L}, sin_a, T{0L},
-          T{0L}, T{1L}, T{0L}, T{0L},
-        - sin_a, T{0L}, cos_a, T{0L},
-          T{0L}, T{0L}, T{0L}, T{1L}};
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation of angle a around zpos axis.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> mat_from(T a, zpos) {
+    const T cos_a = cos(a);
+    const T sin_a = sin(a);
+
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
+          cos_a, sin_a, T{0L},
+        - sin_a, cos_a, T{0L},
+          T{0L}, T{0L}, T{1L}});
 }
 
 /**
  * Return the matrix describing rotation of angle a around zpos axis.
  */
 template <typename T>
-mat<T, 4, 4> mat_from(T a, zpos) {
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
+constexpr mat<T, 4, 4> mat_from(T a, zpos) {
+    return mat_from<4, 4>(a, zpos{});
+}
 
-    return {
-          cos_a, sin_a, T{0L}, T{0L},
-        - sin_a, cos_a, T{0L}, T{0L},
-          T{0L}, T{0L}, T{1L}, T{0L},
-          T{0L}, T{0L}, T{0L}, T{1L}};
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation of angle a around zneg axis.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> mat_from(T a, zneg) {
+    const T cos_a = cos(a);
+    const T sin_a = sin(a);
+
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
+        cos_a, - sin_a, T{0L},
+        sin_a,   cos_a, T{0L},
+        T{0L},   T{0L}, T{1L}});
 }
 
 /**
  * Return the matrix describing rotation of angle a around zneg axis.
  */
 template <typename T>
-mat<T, 4, 4> mat_from(T a, zneg) {
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
-
-    return {
-        cos_a, - sin_a, T{0L}, T{0L},
-        sin_a,   cos_a, T{0L}, T{0L},
-        T{0L},   T{0L}, T{1L}, T{0L},
-        T{0L},   T{0L}, T{0L}, T{1L}};
+constexpr mat<T, 4, 4> mat_from(T a, zneg) {
+    return mat_from<4, 4>(a, zneg{});
 }
 
 /**
  * Return the quaternion describing rotation of angle a around xpos axis.
  */
 template <typename T>
-quat<T> quat_from(T a, xpos) {
+constexpr quat<T> quat_from(T a, xpos) {
     a *= T{0.5L};
 
-    return {std::sin(a), T{0L}, T{0L}, std::cos(a)};
+    return {sin(a), T{0L}, T{0L}, cos(a)};
 }
 
 /**
  * Return the quaternion describing rotation of angle a around xneg axis.
  */
 template <typename T>
-quat<T> quat_from(T a, xneg) {
+constexpr quat<T> quat_from(T a, xneg) {
     a *= T{0.5L};
 
-    return { - std::sin(a), T{0L}, T{0L}, std::cos(a)};
+    return { - sin(a), T{0L}, T{0L}, cos(a)};
 }
 
 /**
  * Return the quaternion describing rotation of angle a around ypos axis.
  */
 template <typename T>
-quat<T> quat_from(T a, ypos) {
+constexpr quat<T> quat_from(T a, ypos) {
     a *= T{0.5L};
 
-    return {T{0L}, std::sin(a), T{0L}, std::cos(a)};
+    return {T{0L}, sin(a), T{0L}, cos(a)};
 }
 
 /**
  * Return the quaternion describing rotation of angle a around yneg axis.
  */
 template <typename T>
-quat<T> quat_from(T a, yneg) {
+constexpr quat<T> quat_from(T a, yneg) {
     a *= T{0.5L};
 
-    return {T{0L}, - std::sin(a), T{0L}, std::cos(a)};
+    return {T{0L}, - sin(a), T{0L}, cos(a)};
 }
 
 /**
  * Return the quaternion describing rotation of angle a around zpos axis.
  */
 template <typename T>
-quat<T> quat_from(T a, zpos) {
+constexpr quat<T> quat_from(T a, zpos) {
     a *= T{0.5L};
 
-    return quat<T>{T{0L}, T{0L}, std::sin(a), std::cos(a)};
+    return quat<T>{T{0L}, T{0L}, sin(a), cos(a)};
 }
 
 /**
  * Return the quaternion describing rotation of angle a around zneg axis.
  */
 template <typename T>
-quat<T> quat_from(T a, zneg) {
+constexpr quat<T> quat_from(T a, zneg) {
     a *= T{0.5L};
 
-    return quat<T>{T{0L}, T{0L}, - std::sin(a), std::cos(a)};
+    return quat<T>{T{0L}, T{0L}, - sin(a), cos(a)};
 }
 
 /**
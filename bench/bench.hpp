@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+namespace ee {
+namespace math {
+namespace bench {
+
+/**
+ * Prevent the compiler from optimizing away a value or the computations that
+ * produced it.
+ */
+template <typename T>
+inline void do_not_optimize(const T& v) {
+    asm volatile("" : : "r,m"(v) : "memory");
+}
+
+/**
+ * Prevent the compiler from assuming memory is unchanged between iterations.
+ */
+inline void clobber() {
+    asm volatile("" : : : "memory");
+}
+
+/**
+ * Return the average duration in nanoseconds of one call to f, best of a few
+ * runs of n calls.
+ */
+template <typename F>
+double ns_per_op(F&& f, std::size_t n, std::size_t runs = 5) {
+    using clock = std::chrono::steady_clock;
+
+    double best = 0.0;
+
+    for (std::size_t r = 0; r < runs; ++ r) {
+        const auto start = clock::now();
+
+        for (std::size_t i = 0; i < n; ++ i) {
+            f();
+            clobber();
+        }
+
+        const std::chrono::duration<double, std::nano> d = clock::now() - start;
+        const double ns = d.count() / static_cast<double>(n);
+
+        if (r == 0 || ns < best) {
+            best = ns;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Print a "name : reference vs candidate" line with the resulting speedup.
+ */
+inline void report(const char* name, double reference_ns, double candidate_ns) {
+    std::printf("%-32s %10.3f ns %10.3f ns %8.2fx\n",
+        name, reference_ns, candidate_ns, reference_ns / candidate_ns);
+}
+
+} // namespace bench
+} // namespace math
+} // namespace ee
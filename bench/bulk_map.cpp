@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Vertex buffer transformation : one affine_map / projective_map call per
+ * point against the bulk overloads, in points per second. Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -I.. bulk_map.cpp
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "../axis_angle_functions.hpp"
+#include "../mat_batch_functions.hpp"
+#include "../mat_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+struct vertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+void report(const char* name, std::size_t n, double reference_ns, double candidate_ns) {
+    std::printf("%-32s %10.1f M/s %10.1f M/s %8.2fx\n", name,
+        n / reference_ns * 1e3, n / candidate_ns * 1e3, reference_ns / candidate_ns);
+}
+
+template <typename T>
+void run(const char* affine_name, const char* projective_name) {
+    constexpr std::size_t n = 1 << 14;
+    constexpr std::size_t runs = 2000;
+
+    volatile T angle = T{0.7L};
+
+    mat<T, 4, 4> m = mat_from(axis_angle<T>{vec<T, 3>{T{0.0L}, T{0.6L}, T{0.8L}}, angle});
+    m(0, 3) = T{1.0L};
+    m(3, 2) = T{0.1L};
+
+    std::vector<vec<T, 3>> in(n), out(n);
+
+    for (std::size_t i = 0; i < n; ++ i) {
+        in[i] = vec<T, 3>{T(i % 100), T{1.0L}, T(i % 7)};
+    }
+
+    const double ref_affine = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < n; ++ i) {
+            out[i] = affine_map(m, in[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs);
+
+    const double cand_affine = bench::ns_per_op([&] {
+        affine_map(m, in.data(), out.data(), n);
+        bench::do_not_optimize(out.data());
+    }, runs);
+
+    const double ref_projective = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < n; ++ i) {
+            out[i] = projective_map(m, in[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs);
+
+    const double cand_projective = bench::ns_per_op([&] {
+        projective_map(m, in.data(), out.data(), n);
+        bench::do_not_optimize(out.data());
+    }, runs);
+
+    report(affine_name, n, ref_affine, cand_affine);
+    report(projective_name, n, ref_projective, cand_projective);
+}
+
+void run_strided() {
+    constexpr std::size_t n = 1 << 14;
+    constexpr std::size_t runs = 2000;
+
+    volatile float angle = 0.7f;
+
+    mat<float, 4, 4> m = mat_from(axis_angle<float>{vec<float, 3>{0.0f, 0.6f, 0.8f}, angle});
+    m(0, 3) = 1.0f;
+
+    std::vector<vertex> vertices(n);
+
+    for (std::size_t i = 0; i < n; ++ i) {
+        vertices[i].position[0] = static_cast<float>(i % 100);
+        vertices[i].position[1] = 1.0f;
+        vertices[i].position[2] = static_cast<float>(i % 7);
+    }
+
+    const double ref = bench::ns_per_op([&] {
+        for (auto& v : vertices) {
+            const auto p = affine_map(m, vec<float, 3>{v.position[0], v.position[1], v.position[2]});
+
+            v.position[0] = p(0);
+            v.position[1] = p(1);
+            v.position[2] = p(2);
+        }
+
+        bench::do_not_optimize(vertices.data());
+    }, runs);
+
+    const double cand = bench::ns_per_op([&] {
+        float* p = vertices[0].position;
+
+        affine_map<3>(m, p, sizeof(vertex), p, sizeof(vertex), n);
+        bench::do_not_optimize(vertices.data());
+    }, runs);
+
+    report("float, in place, 32B stride", n, ref, cand);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-32s %14s %14s %9s\n", "", "per point", "bulk", "speedup");
+
+    run<float>("float affine_map", "float projective_map");
+    run<double>("double affine_map", "double projective_map");
+    run_strided();
+
+    return 0;
+}
@@ -0,0 +1,281 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * ee_math_bench_compare : regression gate against a stored baseline.
+ * Usage : ee_math_bench_compare BASELINE [--threshold R] [--alpha P]
+ *         [--repetitions N] [--cpu N] [--filter TEXT] [--json FILE]
+ * BASELINE is a file written by ee_math_bench --json. Each benchmark of it
+ * still existing is run again, pinned to a cpu, and its samples are compared
+ * to the baseline ones with a one-sided Mann-Whitney U test. A benchmark
+ * regresses when it is slower with p below alpha (default 0.01) and its
+ * median is more than threshold (default 0.05, 5 %) above the baseline one.
+ * Exits with 1 if any regresses, --json writes the new results, e.g. to
+ * update the baseline.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "suite.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+struct baseline_entry {
+    std::string name;
+    std::string type;
+    std::vector<double> samples;
+};
+
+/**
+ * String value of key in text from pos, empty if missing before end.
+ */
+std::string string_value(const std::string& text, const char* key, std::size_t pos, std::size_t end) {
+    const std::size_t k = text.find(std::string("\"") + key + "\"", pos);
+
+    if (k >= end) {
+        return {};
+    }
+
+    const std::size_t begin = text.find('"', text.find(':', k) + 1) + 1;
+
+    return text.substr(begin, text.find('"', begin) - begin);
+}
+
+/**
+ * Entries of a file written by write_json, only reading what it writes.
+ */
+std::vector<baseline_entry> load_baseline(const char* path) {
+    std::ifstream file(path);
+    std::stringstream buffer;
+
+    buffer << file.rdbuf();
+
+    const std::string text = buffer.str();
+    std::vector<baseline_entry> result;
+
+    for (std::size_t pos = text.find("\"name\""); pos != std::string::npos; ) {
+        const std::size_t next = text.find("\"name\"", pos + 1);
+        const std::size_t end  = next == std::string::npos ? text.size() : next;
+
+        baseline_entry entry{string_value(text, "name", pos, end), string_value(text, "type", pos, end), {}};
+
+        const std::size_t samples = text.find("\"samples\"", pos);
+
+        if (samples < end) {
+            const char* c = text.c_str() + text.find('[', samples) + 1;
+
+            for (;;) {
+                char* last = nullptr;
+                const double v = std::strtod(c, &last);
+
+                if (last == c) {
+                    break;
+                }
+
+                entry.samples.push_back(v);
+                c = last + std::strspn(last, ", \n");
+            }
+        }
+
+        if (! entry.samples.empty()) {
+            result.push_back(std::move(entry));
+        }
+
+        pos = next;
+    }
+
+    return result;
+}
+
+double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+
+    const std::size_t n = v.size();
+
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2.0;
+}
+
+/**
+ * One-sided Mann-Whitney U test p-value of current being greater than
+ * baseline : normal approximation with tie and continuity corrections, fine
+ * from about 8 samples each.
+ */
+double mann_whitney_greater(const std::vector<double>& baseline, const std::vector<double>& current) {
+    const double n1 = static_cast<double>(current.size());
+    const double n2 = static_cast<double>(baseline.size());
+    const double n  = n1 + n2;
+
+    // (value, from current) pairs, ranked with average ranks over ties.
+    std::vector<std::pair<double, bool>> all;
+
+    for (double v : current) {
+        all.emplace_back(v, true);
+    }
+
+    for (double v : baseline) {
+        all.emplace_back(v, false);
+    }
+
+    std::sort(all.begin(), all.end());
+
+    double r1   = 0.0;
+    double ties = 0.0;
+
+    for (std::size_t i = 0; i < all.size(); ) {
+        std::size_t j = i;
+
+        while (j < all.size() && all[j].first == all[i].first) {
+            ++ j;
+        }
+
+        const double rank = (static_cast<double>(i + j) + 1.0) / 2.0;
+        const double t    = static_cast<double>(j - i);
+
+        for (std::size_t k = i; k < j; ++ k) {
+            r1 += all[k].second ? rank : 0.0;
+        }
+
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    const double u     = r1 - n1 * (n1 + 1.0) / 2.0;
+    const double mean  = n1 * n2 / 2.0;
+    const double sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0))));
+
+    if (sigma == 0.0) {
+        return u > mean ? 0.0 : 1.0;
+    }
+
+    return 0.5 * std::erfc((u - mean - 0.5) / sigma / std::sqrt(2.0));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* baseline_path = nullptr;
+    const char* json = nullptr;
+    const char* filter = "";
+    double threshold = 0.05;
+    double alpha = 0.01;
+    std::size_t repetitions = 15;
+    int cpu = -1;
+
+    for (int i = 1; i < argc; ++ i) {
+        if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::atof(argv[++ i]);
+        }
+        else if (std::strcmp(argv[i], "--alpha") == 0 && i + 1 < argc) {
+            alpha = std::atof(argv[++ i]);
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::max<std::size_t>(std::strtoul(argv[++ i], nullptr, 10), 2);
+        }
+        else if (std::strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            cpu = std::atoi(argv[++ i]);
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++ i];
+        }
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json = argv[++ i];
+        }
+        else if (baseline_path == nullptr && argv[i][0] != '-') {
+            baseline_path = argv[i];
+        }
+        else {
+            baseline_path = nullptr;
+
+            break;
+        }
+    }
+
+    if (baseline_path == nullptr) {
+        std::fprintf(stderr, "usage : %s BASELINE [--threshold R] [--alpha P] [--repetitions N] [--cpu N] "
+            "[--filter TEXT] [--json FILE]\n", argv[0]);
+
+        return 2;
+    }
+
+    const std::vector<baseline_entry> baseline = load_baseline(baseline_path);
+
+    if (baseline.empty()) {
+        std::fprintf(stderr, "no benchmark samples in %s\n", baseline_path);
+
+        return 2;
+    }
+
+    if (bench::pin_to_cpu(cpu) < 0) {
+        std::fprintf(stderr, "warning : cpu affinity not set, results may be noisier\n");
+    }
+
+    const std::vector<bench::benchmark> benchmarks = bench::benchmarks();
+    bench::perf_counters counters;
+
+    std::vector<std::pair<const bench::benchmark*, bench::measurement>> results;
+    std::size_t regressions = 0;
+
+    std::printf("%-40s %-6s %10s %10s %8s %8s\n", "name", "type", "base ns", "ns", "change", "p");
+
+    for (const baseline_entry& entry : baseline) {
+        if (entry.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        const auto b = std::find_if(benchmarks.begin(), benchmarks.end(), [&](const bench::benchmark& c) {
+            return c.name == entry.name && entry.type == c.type;
+        });
+
+        if (b == benchmarks.end()) {
+            std::printf("%-40s %-6s %10s\n", entry.name.c_str(), entry.type.c_str(), "removed");
+
+            continue;
+        }
+
+        results.emplace_back(&*b, bench::measure(*b, repetitions, counters));
+
+        const std::vector<double>& samples = results.back().second.samples;
+
+        const double base   = median(entry.samples);
+        const double change = median(samples) / base - 1.0;
+        const double p      = mann_whitney_greater(entry.samples, samples);
+        const bool regresses = p < alpha && change > threshold;
+
+        regressions += regresses ? 1 : 0;
+
+        std::printf("%-40s %-6s %10.3f %10.3f %+7.1f%% %8.4f%s\n", entry.name.c_str(), entry.type.c_str(),
+            base, median(samples), change * 100.0, p, regresses ? "  REGRESSION" : "");
+    }
+
+    if (json != nullptr) {
+        std::FILE* file = std::fopen(json, "w");
+
+        if (file == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", json);
+
+            return 2;
+        }
+
+        bench::write_json(file, counters.available(), results);
+        std::fclose(file);
+    }
+
+    std::printf("%zu regression(s) beyond %.1f %% at alpha %.3g\n", regressions, threshold * 100.0, alpha);
+
+    return regressions == 0 ? 0 : 1;
+}
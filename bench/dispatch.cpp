@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Runtime dispatch : batch functions run with each tier up to the best one of
+ * the CPU, in millions of elements per second. Built for the baseline target,
+ * as a binary shipped to mixed hosts would be :
+ * g++ -std=c++17 -O2 -DEE_MATH_DISPATCH=1 -I.. dispatch.cpp
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "../mat_batch_functions.hpp"
+#include "../vec_batch_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+constexpr std::size_t count = 4096;
+constexpr std::size_t runs = 200;
+
+constexpr simd_tier tiers[] = {simd_tier::scalar, simd_tier::sse2, simd_tier::sse4_2, simd_tier::avx2,
+    simd_tier::avx512};
+
+/**
+ * Millions of elements per second of f over count elements, for each tier.
+ */
+template <typename F>
+void run(const char* name, F f) {
+    std::printf("%-24s", name);
+
+    for (simd_tier tier : tiers) {
+        if (set_simd_tier(tier) != tier) {
+            break;
+        }
+
+        const double ns = bench::ns_per_op(f, runs) / count;
+
+        std::printf(" %10.1f", 1e3 / ns);
+    }
+
+    std::printf("\n");
+}
+
+template <typename T>
+void run_all(const char* type) {
+    std::vector<mat<T, 4, 4>> a(count);
+    std::vector<mat<T, 4, 4>> b(count);
+    std::vector<mat<T, 4, 4>> m(count);
+    std::vector<vec<T, 3>> v(count);
+    std::vector<vec<T, 3>> w(count);
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        for (std::size_t k = 0; k < 16; ++ k) {
+            a[i].data[k] = T(((i * 16 + k) * 7919) % 1000) / T{1000L} + (k % 5 == 0 ? T{2L} : T{0L});
+            b[i].data[k] = T(((i * 16 + k) * 104729) % 1000) / T{1000L};
+        }
+
+        v[i] = vec<T, 3>{T(i), T{1L}, T{0.5L} * T(i)};
+    }
+
+    const mat<T, 4, 4> P = a[1];
+
+    std::printf("%-24s", type);
+
+    for (simd_tier tier : tiers) {
+        std::printf(" %10s", simd_tier_name(tier));
+    }
+
+    std::printf("\n");
+
+    run("multiply(mat4x4)", [&] {
+        multiply(a.data(), b.data(), m.data(), count);
+        bench::do_not_optimize(m.data());
+    });
+
+    run("inv(mat4x4)", [&] {
+        inv(a.data(), m.data(), count);
+        bench::do_not_optimize(m.data());
+    });
+
+    run("affine_map(vec3)", [&] {
+        affine_map(P, v.data(), w.data(), count);
+        bench::do_not_optimize(w.data());
+    });
+
+    run("projective_map(vec3)", [&] {
+        projective_map(P, v.data(), w.data(), count);
+        bench::do_not_optimize(w.data());
+    });
+
+    run("normalize(vec3)", [&] {
+        normalize(v.data(), w.data(), count);
+        bench::do_not_optimize(w.data());
+    });
+}
+
+} // namespace
+
+int main() {
+    std::printf("M/s, cpu tier %s\n", simd_tier_name(cpu_simd_tier()));
+
+    run_all<float>("float");
+    run_all<double>("double");
+
+    return 0;
+}
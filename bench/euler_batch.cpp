@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * IMU log ingestion : per sample Tait-Bryan and Euler conversions against
+ * the batched ones of euler_angles_batch_functions.hpp. Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -DEE_MATH_SIMD=1 -I.. euler_batch.cpp
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "../euler_angles_batch_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+/**
+ * Per sample average of single and batched conversions of in to out.
+ */
+template <typename In, typename Out, typename Single, typename Batched>
+void run(const char* name, const std::vector<In>& in, std::vector<Out>& out, Single single, Batched batched) {
+    constexpr std::size_t runs = 50;
+
+    const double single_ns = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < in.size(); ++ i) {
+            out[i] = single(in[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs) / in.size();
+
+    const double batched_ns = bench::ns_per_op([&] {
+        batched(in.data(), out.data(), in.size());
+        bench::do_not_optimize(out.data());
+    }, runs) / in.size();
+
+    bench::report(name, single_ns, batched_ns);
+}
+
+template <typename T>
+void run_all(const char* type) {
+    constexpr std::size_t count = 16384;
+
+    std::vector<tait_bryan_angles<T>> tba(count);
+    std::vector<euler_angles<T>> ea(count);
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        const T a = T(i) * T{0.0123L};
+
+        tba[i] = tait_bryan_angles<T>{- a, T{0.3L} * a, T{2L} * a};
+        ea[i] = euler_angles<T>{a, T{0.5L} * a, - a};
+    }
+
+    std::vector<quat<T>> q(count);
+    std::vector<mat<T, 3, 3>> m3(count);
+    std::vector<mat<T, 4, 4>> m4(count);
+    std::vector<tait_bryan_angles<T>> tba_out(count);
+
+    std::printf("%s\n", type);
+
+    run("quat_from(tait_bryan_angles)", tba, q,
+        [](const tait_bryan_angles<T>& e) { return quat_from(e); },
+        [](const tait_bryan_angles<T>* in, quat<T>* out, std::size_t n) { quat_from(in, out, n); });
+
+    run("mat_from<3,3>(tait_bryan_angles)", tba, m3,
+        [](const tait_bryan_angles<T>& e) { return mat_from<3, 3>(e); },
+        [](const tait_bryan_angles<T>* in, mat<T, 3, 3>* out, std::size_t n) { mat_from(in, out, n); });
+
+    run("quat_from(euler_angles)", ea, q,
+        [](const euler_angles<T>& e) { return quat_from(e); },
+        [](const euler_angles<T>* in, quat<T>* out, std::size_t n) { quat_from(in, out, n); });
+
+    run("mat_from(euler_angles)", ea, m4,
+        [](const euler_angles<T>& e) { return mat_from(e); },
+        [](const euler_angles<T>* in, mat<T, 4, 4>* out, std::size_t n) { mat_from(in, out, n); });
+
+    quat_from(tba.data(), q.data(), count);
+
+    run("tait_bryan_angles_from(quat)", q, tba_out,
+        [](const quat<T>& r) { return tait_bryan_angles_from(r); },
+        [](const quat<T>* in, tait_bryan_angles<T>* out, std::size_t n) { tait_bryan_angles_from(in, out, n); });
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-32s %13s %13s %9s\n", "", "single", "batched", "speedup");
+
+    run_all<float>("float");
+    run_all<double>("double");
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Long componentwise expressions over mat<double, 4, 4> : eager operators
+ * against lazy evaluation. Besides timings, prints the component loads and
+ * stores each form implies : eager operators go through one temporary per
+ * operation, the lazy form reads each operand and writes the result once.
+ * Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -ffp-contract=off -I.. lazy_expr.cpp
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "../lazy.hpp"
+#include "../operators.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+using mat4 = mat<double, 4, 4>;
+
+void report(const char* name, std::size_t eager_memory_ops, std::size_t lazy_memory_ops,
+    double eager_ns, double lazy_ns) {
+    std::printf("%-24s %5zu %5zu %10.3f ns %10.3f ns %8.2fx\n",
+        name, eager_memory_ops, lazy_memory_ops, eager_ns, lazy_ns, eager_ns / lazy_ns);
+}
+
+} // namespace
+
+int main() {
+    constexpr std::size_t n = 4096;
+    constexpr std::size_t runs = 500;
+    constexpr std::size_t size = mat4::size;
+
+    std::vector<mat4> a(n), b(n), c(n), d(n), e(n), out(n);
+
+    for (std::size_t i = 0; i < n; ++ i) {
+        for (std::size_t k = 0; k < size; ++ k) {
+            a[i].data[k] = double(i + k);
+            b[i].data[k] = double(i) - double(k);
+            c[i].data[k] = 0.5 * double(k);
+            d[i].data[k] = double(i % 13);
+            e[i].data[k] = 1.0 + double(k % 3);
+        }
+    }
+
+    volatile double vs = 1.5, vt = -0.25, vu = 3.0, vv = 7.0;
+    const double s = vs, t = vt, u = vu, v = vv;
+
+    std::printf("%-24s %5s %5s %13s %13s %9s\n", "per mat4", "eager", "lazy", "eager", "lazy", "speedup");
+    std::printf("%-24s %11s\n", "", "loads+stores");
+
+    // a * s + b : 2 operations.
+    {
+        const double eager = bench::ns_per_op([&] {
+            for (std::size_t i = 0; i < n; ++ i) {
+                out[i] = a[i] * s + b[i];
+            }
+
+            bench::do_not_optimize(out.data());
+        }, runs) / n;
+
+        const double lazy_ns = bench::ns_per_op([&] {
+            for (std::size_t i = 0; i < n; ++ i) {
+                out[i] = lazy(a[i]) * s + b[i];
+            }
+
+            bench::do_not_optimize(out.data());
+        }, runs) / n;
+
+        report("a * s + b", size * (2 + 3), size * 3, eager, lazy_ns);
+    }
+
+    // a * s + b - c * t : 4 operations.
+    {
+        const double eager = bench::ns_per_op([&] {
+            for (std::size_t i = 0; i < n; ++ i) {
+                out[i] = a[i] * s + b[i] - c[i] * t;
+            }
+
+            bench::do_not_optimize(out.data());
+        }, runs) / n;
+
+        const double lazy_ns = bench::ns_per_op([&] {
+            for (std::size_t i = 0; i < n; ++ i) {
+                out[i] = lazy(a[i]) * s + b[i] - c[i] * t;
+            }
+
+            bench::do_not_optimize(out.data());
+        }, runs) / n;
+
+        report("a * s + b - c * t", size * (2 * 2 + 2 * 3), size * 4, eager, lazy_ns);
+    }
+
+    // a * s + b - c * t + d * u - e / v : 8 operations.
+    {
+        const double eager = bench::ns_per_op([&] {
+            for (std::size_t i = 0; i < n; ++ i) {
+                out[i] = a[i] * s + b[i] - c[i] * t + d[i] * u - e[i] / v;
+            }
+
+            bench::do_not_optimize(out.data());
+        }, runs) / n;
+
+        const double lazy_ns = bench::ns_per_op([&] {
+            for (std::size_t i = 0; i < n; ++ i) {
+                out[i] = lazy(a[i]) * s + b[i] - c[i] * t + d[i] * u - e[i] / v;
+            }
+
+            bench::do_not_optimize(out.data());
+        }, runs) / n;
+
+        report("... + d * u - e / v", size * (4 * 2 + 4 * 3), size * 6, eager, lazy_ns);
+    }
+
+    return 0;
+}
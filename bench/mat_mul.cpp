@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * 4x4 matrix product : generic triple loop against the native kernel.
+ * Build with EE_MATH_SIMD=1, e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -DEE_MATH_SIMD=1 -I.. mat_mul.cpp
+ */
+
+#include <cstddef>
+
+#include "../operators.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+// Same loop as the generic operator*, kept here since the operator now
+// dispatches to the native kernel.
+template <typename T, std::size_t R, std::size_t LC, std::size_t RC>
+mat<T, R, RC> generic_mul(const mat<T, R, LC>& lhs, const mat<T, LC, RC>& rhs) {
+    mat<T, R, RC> result{};
+
+    for (std::size_t k = 0; k < RC; ++ k) {
+        for (std::size_t j = 0; j < R; ++ j) {
+            for (std::size_t i = 0; i < LC; ++ i) {
+                result(j, k) += lhs(j, i) * rhs(i, k);
+            }
+        }
+    }
+
+    return result;
+}
+
+template <typename T, std::size_t R, std::size_t C>
+vec<T, R> generic_mul(const mat<T, R, C>& lhs, const vec<T, C>& rhs) {
+    vec<T, R> result{};
+
+    for (std::size_t r = 0; r < R; ++ r) {
+        for (std::size_t c = 0; c < C; ++ c) {
+            result(r) += lhs(r, c) * rhs(c);
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+void run(const char* mm_name, const char* mv_name) {
+    constexpr std::size_t n = 10000000;
+
+    mat<T, 4, 4> a{
+        T{1.0L}, T{0.1L}, T{0.2L}, T{0.0L},
+        T{0.3L}, T{1.0L}, T{0.4L}, T{0.0L},
+        T{0.5L}, T{0.6L}, T{1.0L}, T{0.0L},
+        T{1.0L}, T{2.0L}, T{3.0L}, T{1.0L}};
+    mat<T, 4, 4> b = a;
+    vec<T, 4> v{T{1.0L}, T{2.0L}, T{3.0L}, T{1.0L}};
+
+    const double ref_mm = bench::ns_per_op([&] {
+        b = generic_mul(a, b);
+        bench::do_not_optimize(b);
+    }, n);
+
+    b = a;
+
+    const double cand_mm = bench::ns_per_op([&] {
+        b *= a;
+        bench::do_not_optimize(b);
+    }, n);
+
+    const double ref_mv = bench::ns_per_op([&] {
+        v = generic_mul(a, v);
+        bench::do_not_optimize(v);
+    }, n);
+
+    const double cand_mv = bench::ns_per_op([&] {
+        v = a * v;
+        bench::do_not_optimize(v);
+    }, n);
+
+    bench::report(mm_name, ref_mm, cand_mm);
+    bench::report(mv_name, ref_mv, cand_mv);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-32s %13s %13s %9s\n", "", "generic", "operator*", "speedup");
+
+    run<float>("mat<float, 4, 4> * mat", "mat<float, 4, 4> * vec");
+    run<double>("mat<double, 4, 4> * mat", "mat<double, 4, 4> * vec");
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Packs : rotation of an AoS array of points by as many quaternions, one
+ * element at a time, against gather, wide rotation and scatter, and against
+ * wide rotation of data kept in packs, in millions of rotations per second.
+ * Transposing AoS data costs about as much as a rotation, packs pay off when
+ * data stays wide through several operations. Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -I.. pack.cpp
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "../pack.hpp"
+#include "../quat_functions.hpp"
+#include "../vec_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+template <typename T, std::size_t N>
+void run(const char* type) {
+    constexpr std::size_t count = 4096;
+    constexpr std::size_t runs = 200;
+
+    std::vector<quat<T>> q(count);
+    std::vector<vec<T, 3>> v(count);
+    std::vector<vec<T, 3>> out(count);
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        const T a = T(i) * T{0.0123L};
+
+        q[i] = normalize(quat<T>{a, T{1L}, T{0.5L} * a, T{2L}});
+        v[i] = vec<T, 3>{a, T{1L} - a, T{3L}};
+    }
+
+    const double scalar_ns = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count; ++ i) {
+            out[i] = rotate(q[i], v[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs) / count;
+
+    const double wide_ns = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count; i += N) {
+            scatter(rotate(gather<N>(&q[i]), gather<N>(&v[i])), &out[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs) / count;
+
+    std::vector<quat<pack<T, N>>> wq(count / N);
+    std::vector<vec<pack<T, N>, 3>> wv(count / N);
+    std::vector<vec<pack<T, N>, 3>> wout(count / N);
+
+    for (std::size_t i = 0; i < count; i += N) {
+        wq[i / N] = gather<N>(&q[i]);
+        wv[i / N] = gather<N>(&v[i]);
+    }
+
+    const double kept_ns = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count / N; ++ i) {
+            wout[i] = rotate(wq[i], wv[i]);
+        }
+
+        bench::do_not_optimize(wout.data());
+    }, runs) / count;
+
+    std::printf("%-16s %10.2f M/s %10.2f M/s %10.2f M/s\n",
+        type, 1e3 / scalar_ns, 1e3 / wide_ns, 1e3 / kept_ns);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-16s %14s %14s %14s\n", "rotate(quat)", "scalar", "AoS to pack", "pack");
+
+    run<float, 4>("float4");
+    run<float, 8>("float8");
+    run<double, 2>("double2");
+    run<double, 4>("double4");
+
+    return 0;
+}
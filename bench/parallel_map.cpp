@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Point cloud transformation scaling : mat<double, 4, 4> affine_map,
+ * projective_map and to_basis over a thread_pool, in points per second for
+ * 1, 2, 4... threads up to the hardware concurrency. Scaling has only been
+ * checked on a single core machine so far, i.e. not measured. Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -pthread -I.. parallel_map.cpp
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "../axis_angle_functions.hpp"
+#include "../parallel_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+int main() {
+    // Large enough not to fit in the last level cache.
+    constexpr std::size_t n = std::size_t{1} << 23;
+    constexpr std::size_t runs = 5;
+
+    volatile double angle = 0.7;
+
+    mat<double, 4, 4> m = mat_from(axis_angle<double>{vec<double, 3>{0.0, 0.6, 0.8}, angle});
+    m(0, 3) = 1.0;
+    m(3, 2) = 0.1;
+
+    std::vector<vec<double, 3>> in(n), out(n);
+
+    for (std::size_t i = 0; i < n; ++ i) {
+        in[i] = vec<double, 3>{double(i % 100), 1.0, double(i % 7)};
+    }
+
+    const std::size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::printf("%8s %14s %14s %14s %9s\n", "threads", "affine_map", "projective_map", "to_basis", "scaling");
+
+    double single = 0.0;
+
+    for (std::size_t threads = 1; ; threads *= 2) {
+        threads = std::min(threads, hardware);
+
+        thread_pool pool(threads);
+
+        const double affine = bench::ns_per_op([&] {
+            affine_map(pool, m, in.data(), out.data(), n);
+            bench::do_not_optimize(out.data());
+        }, runs);
+
+        const double projective = bench::ns_per_op([&] {
+            projective_map(pool, m, in.data(), out.data(), n);
+            bench::do_not_optimize(out.data());
+        }, runs);
+
+        const double change = bench::ns_per_op([&] {
+            to_basis<basis<ypos, zpos, xpos>>(pool, in.data(), out.data(), n);
+            bench::do_not_optimize(out.data());
+        }, runs);
+
+        if (threads == 1) {
+            single = affine;
+        }
+
+        std::printf("%8zu %10.1f M/s %10.1f M/s %10.1f M/s %8.2fx\n", threads,
+            n / affine * 1e3, n / projective * 1e3, n / change * 1e3, single / affine);
+
+        if (threads == hardware) {
+            break;
+        }
+    }
+
+    return 0;
+}
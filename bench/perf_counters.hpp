@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__linux__)
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ee {
+namespace math {
+namespace bench {
+
+/**
+ * Cycles and instructions retired by the calling thread, user space only.
+ * Linux perf events, unavailable elsewhere or when perf_event_paranoid or a
+ * virtual machine without PMU forbids them, in which case counts are zero.
+ */
+class perf_counters {
+public:
+    struct counts {
+        std::uint64_t cycles;
+        std::uint64_t instructions;
+    };
+
+    perf_counters() {
+#if defined(__linux__)
+        m_cycles = open(PERF_COUNT_HW_CPU_CYCLES, -1);
+
+        if (m_cycles != -1) {
+            m_instructions = open(PERF_COUNT_HW_INSTRUCTIONS, m_cycles);
+        }
+
+        if (m_instructions == -1) {
+            close();
+        }
+#endif
+    }
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    ~perf_counters() {
+        close();
+    }
+
+    bool available() const {
+        return m_cycles != -1;
+    }
+
+    void start() {
+#if defined(__linux__)
+        if (available()) {
+            ioctl(m_cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(m_cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    counts stop() {
+        counts result{0, 0};
+
+#if defined(__linux__)
+        if (available()) {
+            ioctl(m_cycles, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+            // PERF_FORMAT_GROUP : number of events, then their values in
+            // opening order.
+            std::uint64_t values[3] = {};
+
+            if (read(m_cycles, values, sizeof(values)) == sizeof(values)) {
+                result = {values[1], values[2]};
+            }
+        }
+#endif
+
+        return result;
+    }
+
+private:
+#if defined(__linux__)
+    static int open(std::uint64_t config, int group) {
+        perf_event_attr attr;
+
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.config         = config;
+        attr.disabled       = group == -1 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+        attr.read_format    = PERF_FORMAT_GROUP;
+
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+    }
+#endif
+
+    void close() {
+#if defined(__linux__)
+        if (m_instructions != -1) {
+            ::close(m_instructions);
+        }
+
+        if (m_cycles != -1) {
+            ::close(m_cycles);
+        }
+#endif
+
+        m_cycles       = -1;
+        m_instructions = -1;
+    }
+
+    int m_cycles       = -1;
+    int m_instructions = -1;
+};
+
+} // namespace bench
+} // namespace math
+} // namespace ee
@@ -0,0 +1,289 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Precision policies report : for each function and policy, the maximum
+ * error measured against a long double evaluation, relative for square roots
+ * and absolute otherwise, and the throughput in millions of calls per second.
+ * Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -DEE_MATH_SIMD=1 -I.. precision_report.cpp
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "../euler_angles_functions.hpp"
+#include "../functions.hpp"
+#include "../precision.hpp"
+#include "../scoords_functions.hpp"
+#include "../vec_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+constexpr std::size_t count = 4096;
+
+/**
+ * Maximum absolute, or relative, difference over all values.
+ */
+long double error(long double v, long double ref, bool relative) {
+    const long double d = std::fabs(v - ref);
+
+    return relative ? d / std::fabs(ref) : d;
+}
+
+template <typename T, typename U>
+long double error(const sin_cos<T>& v, const sin_cos<U>& ref, bool relative) {
+    return std::fmax(error(v.sin, ref.sin, relative), error(v.cos, ref.cos, relative));
+}
+
+template <typename T, typename U, typename B>
+long double error(const scoords_usphere<T, B>& v, const scoords_usphere<U, B>& ref, bool relative) {
+    return std::fmax(error(v.theta, ref.theta, relative), error(v.phi, ref.phi, relative));
+}
+
+template <typename V, typename W>
+long double error_of_components(const V& v, const W& ref, bool relative) {
+    long double e = 0.0L;
+    auto r = cbegin(ref);
+
+    for (auto it = cbegin(v); it != cend(v); ++ it, ++ r) {
+        e = std::fmax(e, error(*it, *r, relative));
+    }
+
+    return e;
+}
+
+template <typename T, typename U, std::size_t D>
+long double error(const vec<T, D>& v, const vec<U, D>& ref, bool relative) {
+    return error_of_components(v, ref, relative);
+}
+
+template <typename T, typename U, std::size_t R, std::size_t C>
+long double error(const mat<T, R, C>& v, const mat<U, R, C>& ref, bool relative) {
+    return error_of_components(v, ref, relative);
+}
+
+template <typename T, typename U>
+long double error(const quat<T>& v, const quat<U>& ref, bool relative) {
+    return error_of_components(v, ref, relative);
+}
+
+/**
+ * Functions and their inputs, rounded to the tested type T and given as U
+ * (T or long double for the reference evaluation).
+ */
+template <typename U, typename T>
+U at(long double v) {
+    return U(T(v));
+}
+
+struct sqrt_case {
+    static constexpr const char* name = "sqrt";
+    static constexpr bool relative = true;
+
+    template <typename U, typename T>
+    static U input(std::size_t i) { return at<U, T>((i + 1) * 0.37L); }
+
+    template <typename U, typename P>
+    static U eval(U x, P p) { return ee::math::sqrt(x, p); }
+};
+
+struct rsqrt_case {
+    static constexpr const char* name = "rsqrt";
+    static constexpr bool relative = true;
+
+    template <typename U, typename T>
+    static U input(std::size_t i) { return at<U, T>((i + 1) * 0.37L); }
+
+    template <typename U, typename P>
+    static U eval(U x, P p) { return rsqrt(x, p); }
+};
+
+struct sincos_case {
+    static constexpr const char* name = "sincos";
+    static constexpr bool relative = false;
+
+    template <typename U, typename T>
+    static U input(std::size_t i) { return at<U, T>(i * 0.0491L - 100.0L); }
+
+    template <typename U, typename P>
+    static sin_cos<U> eval(U x, P p) { return ee::math::sincos(x, p); }
+};
+
+struct atan2_case {
+    static constexpr const char* name = "atan2";
+    static constexpr bool relative = false;
+
+    template <typename U, typename T>
+    static vec<U, 2> input(std::size_t i) {
+        const long double a = i * 0.00153L;
+
+        return {at<U, T>(std::sin(3.0L * a)), at<U, T>(1.3L * std::cos(3.0L * a))};
+    }
+
+    template <typename U, typename P>
+    static U eval(const vec<U, 2>& v, P p) { return ee::math::atan2(v(0), v(1), p); }
+};
+
+struct acos_case {
+    static constexpr const char* name = "acos";
+    static constexpr bool relative = false;
+
+    template <typename U, typename T>
+    static U input(std::size_t i) { return at<U, T>(i * 2.0L / (count - 1) - 1.0L); }
+
+    template <typename U, typename P>
+    static U eval(U x, P p) { return ee::math::acos(x, p); }
+};
+
+struct mag_case {
+    static constexpr const char* name = "mag(vec3)";
+    static constexpr bool relative = true;
+
+    template <typename U, typename T>
+    static vec<U, 3> input(std::size_t i) { return {at<U, T>(i + 1.0L), at<U, T>(0.5L * i), U{3L}}; }
+
+    template <typename U, typename P>
+    static U eval(const vec<U, 3>& v, P p) { return mag(v, p); }
+};
+
+struct normalize_case {
+    static constexpr const char* name = "normalize(vec3)";
+    static constexpr bool relative = false;
+
+    template <typename U, typename T>
+    static vec<U, 3> input(std::size_t i) { return {at<U, T>(i + 1.0L), at<U, T>(0.5L * i), U{3L}}; }
+
+    template <typename U, typename P>
+    static vec<U, 3> eval(const vec<U, 3>& v, P p) { return normalize(v, p); }
+};
+
+struct euler_case {
+    static constexpr const char* name = "mat_from(euler_angles)";
+    static constexpr bool relative = false;
+
+    template <typename U, typename T>
+    static euler_angles<U> input(std::size_t i) {
+        const long double a = i * 0.0123L;
+
+        return {at<U, T>(a), at<U, T>(0.5L * a), at<U, T>(- a)};
+    }
+
+    template <typename U, typename P>
+    static mat<U, 3, 4> eval(const euler_angles<U>& ea, P p) { return mat_from<3, 4>(ea, p); }
+};
+
+struct tait_bryan_case {
+    static constexpr const char* name = "quat_from(tait_bryan)";
+    static constexpr bool relative = false;
+
+    template <typename U, typename T>
+    static tait_bryan_angles<U> input(std::size_t i) {
+        const long double a = i * 0.0123L;
+
+        return {at<U, T>(- a), at<U, T>(a), at<U, T>(2.0L * a)};
+    }
+
+    template <typename U, typename P>
+    static quat<U> eval(const tait_bryan_angles<U>& tba, P p) { return quat_from(tba, p); }
+};
+
+struct scoords_case {
+    static constexpr const char* name = "scoords_usphere_from";
+    static constexpr bool relative = false;
+
+    template <typename U, typename T>
+    static vec<U, 3> input(std::size_t i) {
+        const long double a = i * 0.00153L;
+        const long double b = i * 0.00077L;
+
+        return {at<U, T>(std::cos(a) * std::sin(b)), at<U, T>(std::sin(a) * std::sin(b)), at<U, T>(std::cos(b))};
+    }
+
+    template <typename U, typename P>
+    static scoords_usphere<U> eval(const vec<U, 3>& v, P p) { return scoords_usphere_from(v, p); }
+};
+
+/**
+ * Maximum error and millions of calls per second of one policy.
+ */
+template <typename T, typename Case, typename P>
+void run(P p) {
+    constexpr std::size_t runs = 200;
+
+    using In = decltype(Case::template input<T, T>(0));
+    using Out = decltype(Case::eval(Case::template input<T, T>(0), p));
+
+    std::vector<In> in(count);
+    std::vector<Out> out(count);
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        in[i] = Case::template input<T, T>(i);
+    }
+
+    const double ns = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count; ++ i) {
+            out[i] = Case::eval(in[i], p);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs) / count;
+
+    long double e = 0.0L;
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        const auto ref = Case::eval(Case::template input<long double, T>(i), precise{});
+
+        e = std::fmax(e, error(out[i], ref, Case::relative));
+    }
+
+    std::printf(" %10.2Le %8.1f", e, 1e3 / ns);
+}
+
+template <typename T, typename Case>
+void run() {
+    std::printf("%-24s", Case::name);
+
+    run<T, Case>(precise{});
+    run<T, Case>(fast{});
+    run<T, Case>(fastest{});
+
+    std::printf("\n");
+}
+
+template <typename T>
+void run_all(const char* type) {
+    std::printf("%-24s %19s %19s %19s\n", type, "precise", "fast", "fastest");
+
+    run<T, sqrt_case>();
+    run<T, rsqrt_case>();
+    run<T, sincos_case>();
+    run<T, atan2_case>();
+    run<T, acos_case>();
+    run<T, mag_case>();
+    run<T, normalize_case>();
+    run<T, euler_case>();
+    run<T, tait_bryan_case>();
+    run<T, scoords_case>();
+}
+
+} // namespace
+
+int main() {
+    std::printf("max error, M/s\n");
+
+    run_all<float>("float");
+    run_all<double>("double");
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Pose blending : per quaternion slerp through acos and sin against batched
+ * slerp and nlerp, AoS and SoA. Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -DEE_MATH_SIMD=1 -I.. quat_blend.cpp
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "../axis_angle_functions.hpp"
+#include "../quat_batch_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+quat<float> trig_slerp(const quat<float>& q1, const quat<float>& q2, float t) {
+    const float d = dot(q1, q2);
+    const float s = d < 0.0f ? -1.0f : 1.0f;
+    const float a = std::acos(std::fmin(d * s, 1.0f));
+    const float inv_sin_a = 1.0f / std::sin(a);
+
+    return q1 * (std::sin((1.0f - t) * a) * inv_sin_a) +
+        q2 * (std::sin(t * a) * inv_sin_a * s);
+}
+
+} // namespace
+
+int main() {
+    // A few hundred joints per skeleton, a few thousand skeletons.
+    constexpr std::size_t count = 256 * 2000;
+    constexpr std::size_t runs = 20;
+
+    std::vector<quat<float>> q1(count), q2(count), out(count);
+    std::vector<float> s1[4], s2[4], so[4];
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        const float a = static_cast<float>(i % 97) * 0.03f;
+
+        q1[i] = quat_from(axis_angle<float>{vec<float, 3>{0.0f, 0.6f, 0.8f}, a});
+        q2[i] = quat_from(axis_angle<float>{vec<float, 3>{0.8f, 0.0f, 0.6f}, 1.0f - a});
+    }
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        s1[c].resize(count);
+        s2[c].resize(count);
+        so[c].resize(count);
+
+        for (std::size_t i = 0; i < count; ++ i) {
+            s1[c][i] = q1[i](c);
+            s2[c][i] = q2[i](c);
+        }
+    }
+
+    const float* p1[4] = {s1[0].data(), s1[1].data(), s1[2].data(), s1[3].data()};
+    const float* p2[4] = {s2[0].data(), s2[1].data(), s2[2].data(), s2[3].data()};
+    float* po[4] = {so[0].data(), so[1].data(), so[2].data(), so[3].data()};
+
+    const float t = 0.3f;
+
+    const double ref = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count; ++ i) {
+            out[i] = trig_slerp(q1[i], q2[i], t);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs) / count;
+
+    const double slerp_aos = bench::ns_per_op([&] {
+        slerp(q1.data(), q2.data(), t, out.data(), count);
+        bench::do_not_optimize(out.data());
+    }, runs) / count;
+
+    const double slerp_soa = bench::ns_per_op([&] {
+        slerp(p1, p2, t, po, count);
+        bench::do_not_optimize(po);
+    }, runs) / count;
+
+    const double nlerp_aos = bench::ns_per_op([&] {
+        nlerp(q1.data(), q2.data(), t, out.data(), count);
+        bench::do_not_optimize(out.data());
+    }, runs) / count;
+
+    const double nlerp_soa = bench::ns_per_op([&] {
+        nlerp(p1, p2, t, po, count);
+        bench::do_not_optimize(po);
+    }, runs) / count;
+
+    std::printf("%-32s %13s %13s %9s\n", "", "acos/sin", "batched", "speedup");
+
+    bench::report("slerp, AoS", ref, slerp_aos);
+    bench::report("slerp, SoA", ref, slerp_soa);
+    bench::report("nlerp, AoS", ref, nlerp_aos);
+    bench::report("nlerp, SoA", ref, nlerp_soa);
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Rotating points with quaternions : going through a 4x4 matrix against
+ * rotate(q, v), per point throughput. A prebuilt matrix stays cheaper when
+ * many points share the same rotation. Build e.g. :
+ * g++ -std=c++17 -O2 -I.. quat_rotate.cpp
+ */
+
+#include <cstddef>
+#include <vector>
+
+#include "../axis_angle_functions.hpp"
+#include "../quat_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+template <typename T>
+void run(const char* one_name, const char* many_name) {
+    constexpr std::size_t n = 10000000;
+    constexpr std::size_t count = 1024;
+
+    std::vector<quat<T>> quats(count);
+    std::vector<vec<T, 3>> points(count);
+    std::vector<vec<T, 3>> out(count);
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        quats[i] = quat_from(axis_angle<T>{
+            vec<T, 3>{T{0.0L}, T{0.6L}, T{0.8L}}, T(i) * T{0.01L}});
+        points[i] = vec<T, 3>{T(i), T{1.0L}, - T(i) * T{0.5L}};
+    }
+
+    // One point per rotation, the matrix is built each time.
+    const double ref_one = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count; ++ i) {
+            out[i] = linear_map(mat_from(quats[i]), points[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, n / count) / count;
+
+    const double cand_one = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count; ++ i) {
+            out[i] = rotate(quats[i], points[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, n / count) / count;
+
+    // Many points per rotation, the matrix is built once.
+    const quat<T> q = quats[count / 2];
+
+    const double ref_many = bench::ns_per_op([&] {
+        const auto m = mat_from(q);
+
+        for (std::size_t i = 0; i < count; ++ i) {
+            out[i] = linear_map(m, points[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, n / count) / count;
+
+    const double cand_many = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < count; ++ i) {
+            out[i] = rotate(q, points[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, n / count) / count;
+
+    bench::report(one_name, ref_one, cand_one);
+    bench::report(many_name, ref_many, cand_many);
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-32s %13s %13s %9s\n", "", "mat_from", "rotate", "speedup");
+
+    run<float>("quat<float>, 1 point/quat", "quat<float>, 1024 points/quat");
+    run<double>("quat<double>, 1 point/quat", "quat<double>, 1024 points/quat");
+
+    return 0;
+}
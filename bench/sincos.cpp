@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Rotation builders : separate sin and cos calls per angle, as the builders
+ * used to do, against sincos, in millions of conversions per second.
+ * With GCC and glibc, the separate calls on a same angle are already merged
+ * into one libm sincos call, so the difference for several angles comes from
+ * the single SIMD evaluation of EE_MATH_SIMD. Build e.g. :
+ * g++ -std=c++17 -O2 -mavx2 -mfma -DEE_MATH_SIMD=1 -I.. sincos.cpp
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "../axis_angle_functions.hpp"
+#include "../euler_angles_functions.hpp"
+#include "../scoords_functions.hpp"
+
+#include "bench.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+using B = basis<xpos, ypos, zpos>;
+
+/**
+ * Builders as they were, one libm call per sine and cosine.
+ */
+template <typename T>
+mat<T, 3, 4> separate_mat_from(const euler_angles<T>& ea) {
+    const T cos_a = std::cos(ea.alpha);
+    const T sin_a = std::sin(ea.alpha);
+
+    const T cos_b = std::cos(ea.beta);
+    const T sin_b = std::sin(ea.beta);
+
+    const T cos_g = std::cos(ea.gamma);
+    const T sin_g = std::sin(ea.gamma);
+
+    const T cos_a_cos_g = cos_a * cos_g;
+    const T sin_a_sin_g = sin_a * sin_g;
+    const T cos_g_sin_a = cos_g * sin_a;
+    const T cos_a_sin_g = cos_a * sin_g;
+
+    return from_basis<B>(mat<T, 3, 4>{
+          cos_a_cos_g - cos_b * sin_a_sin_g,
+          cos_g_sin_a + cos_a_sin_g * cos_b,
+          sin_b * sin_g,
+
+        - cos_a_sin_g - cos_b * cos_g_sin_a,
+          cos_a_cos_g * cos_b - sin_a_sin_g,
+          cos_g * sin_b,
+
+          sin_a * sin_b,
+        - cos_a * sin_b,
+          cos_b,
+
+          T{0L}, T{0L}, T{0L}});
+}
+
+template <typename T>
+quat<T> separate_quat_from(const tait_bryan_angles<T>& tba) {
+    const T     a = T{0.5L} * tba.alpha;
+    const T cos_a = std::cos(a);
+    const T sin_a = std::sin(a);
+
+    const T     b = T{0.5L} * tba.beta;
+    const T cos_b = std::cos(b);
+    const T sin_b = std::sin(b);
+
+    const T     g = T{0.5L} * tba.gamma;
+    const T cos_g = std::cos(g);
+    const T sin_g = std::sin(g);
+
+    return from_basis<B>(quat<T>{
+        cos_a * cos_b * sin_g - sin_a * sin_b * cos_g,
+        cos_a * sin_b * cos_g + sin_a * cos_b * sin_g,
+        sin_a * cos_b * cos_g - cos_a * sin_b * sin_g,
+        cos_a * cos_b * cos_g + sin_a * sin_b * sin_g});
+}
+
+template <typename T>
+vec<T, 3> separate_vec_from(const scoords_usphere<T>& scu) {
+    const T cos_theta = std::cos(scu.theta);
+    const T sin_theta = std::sin(scu.theta);
+    const T cos_phi   = std::cos(scu.phi);
+    const T sin_phi   = std::sin(scu.phi);
+
+    return from_basis<B>(vec<T, 3>{cos_theta * sin_phi, sin_theta * sin_phi, cos_phi});
+}
+
+template <typename T>
+mat<T, 3, 4> separate_mat_from(const axis_angle<T>& aa) {
+    const T cos_theta = std::cos(aa.angle);
+    const T sin_theta = std::sin(aa.angle);
+
+    const T one_minus_cos_theta = T{1L} - cos_theta;
+
+    const T xx_1_minus_cos_t = aa.axis(0) * aa.axis(0) * one_minus_cos_theta;
+    const T xy_1_minus_cos_t = aa.axis(0) * aa.axis(1) * one_minus_cos_theta;
+    const T yy_1_minus_cos_t = aa.axis(1) * aa.axis(1) * one_minus_cos_theta;
+    const T xz_1_minus_cos_t = aa.axis(0) * aa.axis(2) * one_minus_cos_theta;
+    const T yz_1_minus_cos_t = aa.axis(1) * aa.axis(2) * one_minus_cos_theta;
+    const T zz_1_minus_cos_t = aa.axis(2) * aa.axis(2) * one_minus_cos_theta;
+
+    const T x_sin_t = aa.axis(0) * sin_theta;
+    const T y_sin_t = aa.axis(1) * sin_theta;
+    const T z_sin_t = aa.axis(2) * sin_theta;
+
+    return mat<T, 3, 4>{
+        xx_1_minus_cos_t + cos_theta,
+        xy_1_minus_cos_t + z_sin_t,
+        xz_1_minus_cos_t - y_sin_t,
+
+        xy_1_minus_cos_t - z_sin_t,
+        yy_1_minus_cos_t + cos_theta,
+        yz_1_minus_cos_t + x_sin_t,
+
+        xz_1_minus_cos_t + y_sin_t,
+        yz_1_minus_cos_t - x_sin_t,
+        zz_1_minus_cos_t + cos_theta,
+
+        T{0L}, T{0L}, T{0L}};
+}
+
+void report(const char* name, double separate_ns, double sincos_ns) {
+    std::printf("%-32s %10.2f M/s %10.2f M/s %8.2fx\n",
+        name, 1e3 / separate_ns, 1e3 / sincos_ns, separate_ns / sincos_ns);
+}
+
+/**
+ * Conversions per second of separate and builder over count inputs.
+ */
+template <typename In, typename Separate, typename Builder>
+void run(const char* name, const std::vector<In>& in, Separate separate, Builder builder) {
+    constexpr std::size_t runs = 200;
+
+    using Out = decltype(builder(in[0]));
+
+    std::vector<Out> out(in.size());
+
+    const double separate_ns = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < in.size(); ++ i) {
+            out[i] = separate(in[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs) / in.size();
+
+    const double sincos_ns = bench::ns_per_op([&] {
+        for (std::size_t i = 0; i < in.size(); ++ i) {
+            out[i] = builder(in[i]);
+        }
+
+        bench::do_not_optimize(out.data());
+    }, runs) / in.size();
+
+    report(name, separate_ns, sincos_ns);
+}
+
+template <typename T>
+void run_all(const char* type) {
+    constexpr std::size_t count = 4096;
+
+    std::vector<euler_angles<T>> ea(count);
+    std::vector<tait_bryan_angles<T>> tba(count);
+    std::vector<scoords_usphere<T>> scu(count);
+    std::vector<axis_angle<T>> aa(count);
+
+    for (std::size_t i = 0; i < count; ++ i) {
+        const T a = T(i) * T{0.0123L};
+
+        ea[i] = euler_angles<T>{a, T{0.5L} * a, - a};
+        tba[i] = tait_bryan_angles<T>{- a, a, T{2L} * a};
+        scu[i] = scoords_usphere<T>{a, T{0.3L} * a};
+        aa[i] = axis_angle<T>{vec<T, 3>{T{0.0L}, T{0.6L}, T{0.8L}}, a};
+    }
+
+    std::printf("%s\n", type);
+
+    run("mat_from(euler_angles)", ea,
+        [](const euler_angles<T>& e) { return separate_mat_from(e); },
+        [](const euler_angles<T>& e) { return mat_from<3, 4>(e); });
+
+    run("quat_from(tait_bryan_angles)", tba,
+        [](const tait_bryan_angles<T>& e) { return separate_quat_from(e); },
+        [](const tait_bryan_angles<T>& e) { return quat_from(e); });
+
+    run("vec_from(scoords_usphere)", scu,
+        [](const scoords_usphere<T>& s) { return separate_vec_from(s); },
+        [](const scoords_usphere<T>& s) { return vec_from(s); });
+
+    run("mat_from(axis_angle)", aa,
+        [](const axis_angle<T>& a) { return separate_mat_from(a); },
+        [](const axis_angle<T>& a) { return mat_from<3, 4>(a); });
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-32s %14s %14s %9s\n", "", "separate", "sincos", "speedup");
+
+    run_all<float>("float");
+    run_all<double>("double");
+
+    return 0;
+}
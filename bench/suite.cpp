@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * ee_math_bench : micro-benchmarks of every public entry point in float and
+ * double, ns per operation plus operations per cycle and instructions per
+ * operation where perf counters are available.
+ * Usage : ee_math_bench [--json FILE] [--filter TEXT] [--repetitions N] [--cpu N]
+ * --json writes results to FILE ("-" for stdout) to track regressions between
+ * versions, see compare.cpp, --filter keeps benchmarks whose name contains
+ * TEXT. Runs pinned to a cpu, the first allowed one unless --cpu is given.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "suite.hpp"
+
+using namespace ee::math;
+
+int main(int argc, char** argv) {
+    const char* json = nullptr;
+    const char* filter = "";
+    std::size_t repetitions = 10;
+    int cpu = -1;
+
+    for (int i = 1; i < argc; ++ i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json = argv[++ i];
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++ i];
+        }
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::max<std::size_t>(std::strtoul(argv[++ i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            cpu = std::atoi(argv[++ i]);
+        }
+        else {
+            std::fprintf(stderr, "usage : %s [--json FILE] [--filter TEXT] [--repetitions N] [--cpu N]\n", argv[0]);
+
+            return 2;
+        }
+    }
+
+    bench::pin_to_cpu(cpu);
+
+    const std::vector<bench::benchmark> benchmarks = bench::benchmarks();
+    bench::perf_counters counters;
+
+    std::vector<std::pair<const bench::benchmark*, bench::measurement>> results;
+
+    // Human readable table on stderr when JSON goes to stdout.
+    std::FILE* table = json != nullptr && std::strcmp(json, "-") == 0 ? stderr : stdout;
+
+    std::fprintf(table, "%-40s %-6s %10s %10s %10s\n", "name", "type", "ns/op", "ops/cycle", "instr/op");
+
+    for (const bench::benchmark& b : benchmarks) {
+        if (b.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        results.emplace_back(&b, bench::measure(b, repetitions, counters));
+
+        const bench::measurement& m = results.back().second;
+
+        if (counters.available() && m.cycles_per_op > 0.0) {
+            std::fprintf(table, "%-40s %-6s %10.3f %10.3f %10.1f\n",
+                b.name.c_str(), b.type, m.ns_per_op, 1.0 / m.cycles_per_op, m.instructions_per_op);
+        }
+        else {
+            std::fprintf(table, "%-40s %-6s %10.3f %10s %10s\n", b.name.c_str(), b.type, m.ns_per_op, "-", "-");
+        }
+    }
+
+    if (json != nullptr) {
+        std::FILE* file = std::strcmp(json, "-") == 0 ? stdout : std::fopen(json, "w");
+
+        if (file == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", json);
+
+            return 1;
+        }
+
+        bench::write_json(file, counters.available(), results);
+
+        if (file != stdout) {
+            std::fclose(file);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,507 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../axis_angle_functions.hpp"
+#include "../basis_functions.hpp"
+#include "../euler_angles_functions.hpp"
+#include "../mat_functions.hpp"
+#include "../operators.hpp"
+#include "../quat_functions.hpp"
+#include "../scoords_functions.hpp"
+#include "../unit_functions.hpp"
+#include "../vec_functions.hpp"
+#include "../view_functions.hpp"
+
+#include "bench.hpp"
+#include "perf_counters.hpp"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+/**
+ * Micro-benchmarks of the public entry points, in float and double, shared by
+ * ee_math_bench and the tools built on its results.
+ * Each benchmark applies its operation to a batch of distinct inputs, so that
+ * nothing is folded at compile time, and reports per operation figures.
+ */
+
+namespace ee {
+namespace math {
+namespace bench {
+
+/**
+ * Operations per call of a benchmark.
+ */
+constexpr std::size_t batch = 64;
+
+struct benchmark {
+    std::string name;
+    const char* type;
+    std::function<void()> run;
+};
+
+/**
+ * Nanoseconds per operation of each repetition, cycles and instructions per
+ * operation of the fastest one, zero without perf counters.
+ */
+struct measurement {
+    std::vector<double> samples;
+    double ns_per_op;
+    double cycles_per_op;
+    double instructions_per_op;
+};
+
+namespace detail {
+
+template <typename T>
+constexpr const char* type_name = std::is_same<T, float>::value ? "float" : "double";
+
+template <typename X>
+struct tag {};
+
+/**
+ * i-th input of type X, every one valid for the operations taking X : angles
+ * below a turn, invertible matrices, unit quaternions and axes.
+ */
+template <typename T>
+T make(tag<T>, std::size_t i) {
+    return T(i % 13 + 1) / T{7L};
+}
+
+template <typename T, std::size_t D>
+vec<T, D> make(tag<vec<T, D>>, std::size_t i) {
+    vec<T, D> v;
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        v[d] = T((i * 7 + d * 3) % 11 + 1) / T{5L};
+    }
+
+    return v;
+}
+
+template <typename T, std::size_t R, std::size_t C, typename L>
+mat<T, R, C, L> make(tag<mat<T, R, C, L>>, std::size_t i) {
+    mat<T, R, C, L> m;
+
+    for (std::size_t r = 0; r < R; ++ r) {
+        for (std::size_t c = 0; c < C; ++ c) {
+            m(r, c) = T((i * 31 + r * 7 + c * 3) % 17) / T{17L} + (r == c ? T(C) : T{0L});
+        }
+    }
+
+    return m;
+}
+
+template <typename T>
+quat<T> make(tag<quat<T>>, std::size_t i) {
+    const vec<T, 4> v = make(tag<vec<T, 4>>{}, i);
+
+    return normalize(quat<T>{v[0], v[1], v[2], v[3]});
+}
+
+template <typename T>
+axis_angle<T> make(tag<axis_angle<T>>, std::size_t i) {
+    return {normalize(make(tag<vec<T, 3>>{}, i)), make(tag<T>{}, i)};
+}
+
+template <typename T, typename B>
+euler_angles<T, B> make(tag<euler_angles<T, B>>, std::size_t i) {
+    euler_angles<T, B> ea;
+
+    ea.alpha = make(tag<T>{}, i);
+    ea.beta  = make(tag<T>{}, i + 1);
+    ea.gamma = make(tag<T>{}, i + 2);
+
+    return ea;
+}
+
+template <typename T, typename B>
+tait_bryan_angles<T, B> make(tag<tait_bryan_angles<T, B>>, std::size_t i) {
+    tait_bryan_angles<T, B> tba;
+
+    tba.alpha = make(tag<T>{}, i);
+    tba.beta  = make(tag<T>{}, i + 1);
+    tba.gamma = make(tag<T>{}, i + 2);
+
+    return tba;
+}
+
+template <typename T, typename B>
+scoords_usphere<T, B> make(tag<scoords_usphere<T, B>>, std::size_t i) {
+    scoords_usphere<T, B> scu;
+
+    scu.theta = make(tag<T>{}, i);
+    scu.phi   = make(tag<T>{}, i + 1);
+
+    return scu;
+}
+
+template <typename X>
+unit<X> make(tag<unit<X>>, std::size_t i) {
+    return unit<X>(make(tag<X>{}, i));
+}
+
+template <typename M>
+orthonormal<M> make(tag<orthonormal<M>>, std::size_t i) {
+    return orthonormal<M>(make(tag<M>{}, i));
+}
+
+template <typename X>
+std::vector<X> inputs(std::size_t offset = 0) {
+    std::vector<X> result;
+
+    for (std::size_t i = 0; i < batch; ++ i) {
+        result.push_back(make(tag<X>{}, i + offset));
+    }
+
+    return result;
+}
+
+/**
+ * Benchmark of f over a batch of X.
+ */
+template <typename X, typename F>
+benchmark unary(std::string name, const char* type, F f) {
+    using Y = decltype(f(std::declval<const X&>()));
+
+    return {std::move(name), type, [f, in = inputs<X>(), out = std::vector<Y>(batch)]() mutable {
+        for (std::size_t i = 0; i < batch; ++ i) {
+            out[i] = f(in[i]);
+        }
+
+        do_not_optimize(out.data());
+    }};
+}
+
+/**
+ * Benchmark of f over a batch of X, Y pairs.
+ */
+template <typename X, typename Y, typename F>
+benchmark binary(std::string name, const char* type, F f) {
+    using Z = decltype(f(std::declval<const X&>(), std::declval<const Y&>()));
+
+    return {std::move(name), type,
+        [f, lhs = inputs<X>(), rhs = inputs<Y>(batch), out = std::vector<Z>(batch)]() mutable {
+            for (std::size_t i = 0; i < batch; ++ i) {
+                out[i] = f(lhs[i], rhs[i]);
+            }
+
+            do_not_optimize(out.data());
+        }};
+}
+
+inline std::string size_name(std::size_t R, std::size_t C) {
+    return std::to_string(R) + "x" + std::to_string(C);
+}
+
+template <typename T, std::size_t... Ds>
+void add_square(std::vector<benchmark>& list, std::index_sequence<Ds...>) {
+    const char* type = type_name<T>;
+
+    (list.push_back(binary<mat<T, Ds, Ds>, mat<T, Ds, Ds>>(
+        "operator*(mat" + size_name(Ds, Ds) + ",mat" + size_name(Ds, Ds) + ")", type,
+        [](const auto& a, const auto& b) { return a * b; })), ...);
+
+    (list.push_back(binary<mat<T, Ds, Ds>, vec<T, Ds>>(
+        "operator*(mat" + size_name(Ds, Ds) + ",vec" + std::to_string(Ds) + ")", type,
+        [](const auto& m, const auto& v) { return m * v; })), ...);
+
+    (list.push_back(unary<mat<T, Ds, Ds>>(
+        "transpose(mat" + size_name(Ds, Ds) + ")", type,
+        [](const auto& m) { return transpose(m); })), ...);
+}
+
+template <typename T, std::size_t... Ds>
+void add_det_inv(std::vector<benchmark>& list, std::index_sequence<Ds...>) {
+    const char* type = type_name<T>;
+
+    (list.push_back(unary<mat<T, Ds + 2, Ds + 2>>(
+        "det(mat" + size_name(Ds + 2, Ds + 2) + ")", type,
+        [](const auto& m) { return det(m); })), ...);
+
+    (list.push_back(unary<mat<T, Ds + 2, Ds + 2>>(
+        "inv(mat" + size_name(Ds + 2, Ds + 2) + ")", type,
+        [](const auto& m) { return inv(m); })), ...);
+}
+
+/**
+ * mat_from<3, 3>, mat_from<3, 4>, mat_from (4x4) and quat_from of X.
+ */
+template <typename T, typename X>
+void add_builders(std::vector<benchmark>& list, const std::string& x) {
+    const char* type = type_name<T>;
+
+    list.push_back(unary<X>("mat_from<3,3>(" + x + ")", type,
+        [](const X& v) { return mat_from<3, 3>(v); }));
+    list.push_back(unary<X>("mat_from<3,4>(" + x + ")", type,
+        [](const X& v) { return mat_from<3, 4>(v); }));
+    list.push_back(unary<X>("mat_from(" + x + ")", type,
+        [](const X& v) { return mat_from(v); }));
+    list.push_back(unary<X>("quat_from(" + x + ")", type,
+        [](const X& v) { return quat_from(v); }));
+}
+
+/**
+ * Builders of rotations of an angle around axis A.
+ */
+template <typename T, typename A>
+void add_axis_builders(std::vector<benchmark>& list, const std::string& a) {
+    const char* type = type_name<T>;
+
+    list.push_back(unary<T>("mat_from<3,3>(T," + a + ")", type,
+        [](T v) { return mat_from<3, 3>(v, A{}); }));
+    list.push_back(unary<T>("mat_from<3,4>(T," + a + ")", type,
+        [](T v) { return mat_from<3, 4>(v, A{}); }));
+    list.push_back(unary<T>("mat_from(T," + a + ")", type,
+        [](T v) { return mat_from(v, A{}); }));
+    list.push_back(unary<T>("quat_from(T," + a + ")", type,
+        [](T v) { return quat_from(v, A{}); }));
+}
+
+/**
+ * to_basis and from_basis of X, from and to basis<zpos, xpos, ypos>, and
+ * change_basis from it to basis<yneg, zpos, xneg>.
+ */
+template <typename X>
+void add_basis(std::vector<benchmark>& list, const std::string& x, const char* type) {
+    using B = basis<zpos, xpos, ypos>;
+
+    list.push_back(unary<X>("to_basis(" + x + ")", type,
+        [](const X& v) { return to_basis<B>(v); }));
+    list.push_back(unary<X>("from_basis(" + x + ")", type,
+        [](const X& v) { return from_basis<B>(v); }));
+    list.push_back(unary<X>("change_basis(" + x + ")", type,
+        [](const X& v) { return change_basis<B, basis<yneg, zpos, xneg>>(v); }));
+}
+
+template <typename T>
+void add_all(std::vector<benchmark>& list) {
+    const char* type = type_name<T>;
+
+    add_square<T>(list, std::index_sequence<2, 3, 4>{});
+
+    list.push_back(binary<mat<T, 3, 4>, mat<T, 3, 4>>("operator*(mat3x4,mat3x4)", type,
+        [](const auto& a, const auto& b) { return a * b; }));
+    list.push_back(binary<mat<T, 3, 4>, vec<T, 4>>("operator*(mat3x4,vec4)", type,
+        [](const auto& m, const auto& v) { return m * v; }));
+    list.push_back(binary<quat<T>, quat<T>>("operator*(quat,quat)", type,
+        [](const auto& a, const auto& b) { return a * b; }));
+    list.push_back(binary<unit<quat<T>>, unit<quat<T>>>("operator*(unit<quat>,unit<quat>)", type,
+        [](const auto& a, const auto& b) { return a * b; }));
+    list.push_back(unary<quat<T>>("inv(quat)", type,
+        [](const auto& q) { return inv(q); }));
+    list.push_back(unary<unit<quat<T>>>("inv(unit<quat>)", type,
+        [](const auto& q) { return inv(q); }));
+    list.push_back(unary<mat<T, 3, 4>>("transpose(mat3x4)", type,
+        [](const auto& m) { return transpose(m); }));
+
+    add_det_inv<T>(list, std::make_index_sequence<7>{});
+
+    list.push_back(unary<mat<T, 3, 4>>("inv(mat3x4)", type,
+        [](const auto& m) { return inv(m); }));
+    list.push_back(unary<orthonormal<mat<T, 4, 4>>>("inv(orthonormal<mat4x4>)", type,
+        [](const auto& m) { return inv(m); }));
+
+    using mat4x4r = mat<T, 4, 4, row_major>;
+
+    list.push_back(binary<mat4x4r, mat4x4r>("operator*(mat4x4r,mat4x4r)", type,
+        [](const auto& a, const auto& b) { return a * b; }));
+    list.push_back(unary<mat4x4r>("inv(mat4x4r)", type,
+        [](const auto& m) { return inv(m); }));
+    list.push_back(unary<mat4x4r>("transpose(mat4x4r)", type,
+        [](const auto& m) { return transpose(m); }));
+
+    list.push_back(binary<mat<T, 4, 4>, vec<T, 3>>("affine_map(mat4x4,vec3)", type,
+        [](const auto& m, const auto& v) { return affine_map(m, v); }));
+    list.push_back(binary<mat4x4r, vec<T, 3>>("affine_map(mat4x4r,vec3)", type,
+        [](const auto& m, const auto& v) { return affine_map(m, v); }));
+    list.push_back(binary<mat<T, 4, 4>, vec<T, 4>>("affine_map(mat4x4,vec_view3)", type,
+        [](const auto& m, const auto& v) { return affine_map(m, vec_view<const T, 3>(&v.data[0])); }));
+
+    list.push_back(binary<vec<T, 3>, vec<T, 3>>("mat_look_at", type,
+        [](const auto& pos, const auto& at) { return mat_look_at(pos, at, vec<T, 3>{T{0L}, T{1L}, T{0L}}); }));
+
+    add_builders<T, axis_angle<T>>(list, "axis_angle");
+    add_builders<T, euler_angles<T>>(list, "euler_angles");
+    add_builders<T, tait_bryan_angles<T>>(list, "tait_bryan_angles");
+    add_builders<T, scoords_usphere<T>>(list, "scoords_usphere");
+
+    list.push_back(unary<quat<T>>("mat_from<3,3>(quat)", type,
+        [](const auto& q) { return mat_from<3, 3>(q); }));
+    list.push_back(unary<quat<T>>("mat_from<3,4>(quat)", type,
+        [](const auto& q) { return mat_from<3, 4>(q); }));
+    list.push_back(unary<quat<T>>("mat_from(quat)", type,
+        [](const auto& q) { return mat_from(q); }));
+    list.push_back(unary<mat<T, 3, 4>>("quat_from(mat3x4)", type,
+        [](const auto& m) { return quat_from(m); }));
+    list.push_back(unary<mat<T, 4, 4>>("quat_from(mat4x4)", type,
+        [](const auto& m) { return quat_from(m); }));
+
+    add_axis_builders<T, xpos>(list, "xpos");
+    add_axis_builders<T, xneg>(list, "xneg");
+    add_axis_builders<T, ypos>(list, "ypos");
+    add_axis_builders<T, yneg>(list, "yneg");
+    add_axis_builders<T, zpos>(list, "zpos");
+    add_axis_builders<T, zneg>(list, "zneg");
+
+    add_basis<vec<T, 3>>(list, "vec3", type);
+    add_basis<mat<T, 3, 3>>(list, "mat3x3", type);
+    add_basis<mat<T, 3, 4>>(list, "mat3x4", type);
+    add_basis<mat<T, 4, 4>>(list, "mat4x4", type);
+    add_basis<quat<T>>(list, "quat", type);
+
+    list.push_back(unary<vec<T, 3>>("scoords_usphere_from(vec3)", type,
+        [](const auto& v) { return scoords_usphere_from(v); }));
+    list.push_back(unary<vec<T, 3>>("scoords_from(vec3)", type,
+        [](const auto& v) { return scoords_from(v); }));
+}
+
+} // namespace detail
+
+/**
+ * Every benchmark, float ones first.
+ */
+inline std::vector<benchmark> benchmarks() {
+    std::vector<benchmark> list;
+
+    detail::add_all<float>(list);
+    detail::add_all<double>(list);
+
+    return list;
+}
+
+/**
+ * repetitions timings of b, each of about min_ns, the first one once
+ * calibrated being discarded as warm up.
+ */
+inline measurement measure(const benchmark& b, std::size_t repetitions, perf_counters& counters,
+    double min_ns = 2e6) {
+    using clock = std::chrono::steady_clock;
+
+    const auto time = [&](std::size_t n, perf_counters::counts* c) {
+        counters.start();
+
+        const auto start = clock::now();
+
+        for (std::size_t i = 0; i < n; ++ i) {
+            b.run();
+            clobber();
+        }
+
+        const std::chrono::duration<double, std::nano> d = clock::now() - start;
+
+        *c = counters.stop();
+
+        return d.count();
+    };
+
+    perf_counters::counts c;
+    std::size_t n = 1;
+
+    while (time(n, &c) < min_ns) {
+        n *= 2;
+    }
+
+    measurement result{{}, 0.0, 0.0, 0.0};
+    const double ops = static_cast<double>(n * batch);
+
+    for (std::size_t r = 0; r < repetitions; ++ r) {
+        const double ns = time(n, &c) / ops;
+
+        if (result.samples.empty() || ns < result.ns_per_op) {
+            result.ns_per_op           = ns;
+            result.cycles_per_op       = static_cast<double>(c.cycles) / ops;
+            result.instructions_per_op = static_cast<double>(c.instructions) / ops;
+        }
+
+        result.samples.push_back(ns);
+    }
+
+    return result;
+}
+
+/**
+ * Pin the calling thread to cpu, or to the first one it may run on if cpu is
+ * negative, so that repetitions do not migrate between cores. Returns the cpu
+ * or -1 where affinity cannot be set (non Linux systems).
+ */
+inline int pin_to_cpu(int cpu = -1) {
+#if defined(__linux__)
+    cpu_set_t set;
+
+    if (cpu < 0) {
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+            return -1;
+        }
+
+        for (cpu = 0; cpu < CPU_SETSIZE && ! CPU_ISSET(cpu, &set); ++ cpu) {
+        }
+    }
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? cpu : -1;
+#else
+    static_cast<void>(cpu);
+
+    return -1;
+#endif
+}
+
+/**
+ * Write results as JSON :
+ * {"perf_counters": bool, "results": [{"name", "type", "ns_per_op",
+ * "ops_per_cycle", "instructions_per_op", "samples"}, ...]}
+ * ops_per_cycle and instructions_per_op being null without perf counters.
+ */
+inline void write_json(std::FILE* file, bool has_counters,
+    const std::vector<std::pair<const benchmark*, measurement>>& results) {
+    std::fprintf(file, "{\n  \"perf_counters\": %s,\n  \"results\": [", has_counters ? "true" : "false");
+
+    for (std::size_t i = 0; i < results.size(); ++ i) {
+        const benchmark& b   = *results[i].first;
+        const measurement& m = results[i].second;
+
+        std::fprintf(file, "%s\n    {\"name\": \"%s\", \"type\": \"%s\", \"ns_per_op\": %.4f, ",
+            i == 0 ? "" : ",", b.name.c_str(), b.type, m.ns_per_op);
+
+        if (has_counters && m.cycles_per_op > 0.0) {
+            std::fprintf(file, "\"ops_per_cycle\": %.4f, \"instructions_per_op\": %.2f, ",
+                1.0 / m.cycles_per_op, m.instructions_per_op);
+        }
+        else {
+            std::fprintf(file, "\"ops_per_cycle\": null, \"instructions_per_op\": null, ");
+        }
+
+        std::fprintf(file, "\"samples\": [");
+
+        for (std::size_t s = 0; s < m.samples.size(); ++ s) {
+            std::fprintf(file, "%s%.4f", s == 0 ? "" : ", ", m.samples[s]);
+        }
+
+        std::fprintf(file, "]}");
+    }
+
+    std::fprintf(file, "\n  ]\n}\n");
+}
+
+} // namespace bench
+} // namespace math
+} // namespace ee
@@ -7,16 +7,45 @@
 
 #pragma once
 
+#include <cstddef>
 #include <type_traits>
 
 namespace ee {
 namespace math {
 
+template <typename T, std::size_t N>
+struct pack;
+
+/**
+ * A way to identify packs (see pack.hpp).
+ */
+namespace detail {
+
+template <typename>
+struct is_pack_impl : std::false_type {};
+
+template <typename T, std::size_t N>
+struct is_pack_impl<pack<T, N>> : std::true_type {};
+
+} // namespace detail
+
+template <typename T>
+constexpr bool is_pack = detail::is_pack_impl<std::decay_t<T>>::value;
+
 /**
- * A way to identify scalar numbers.
+ * A way to identify scalar numbers, packs being scalars of N lanes.
  */
 template <typename T>
-constexpr bool is_num = std::is_arithmetic<std::decay_t<T>>::value;
+constexpr bool is_num = std::is_arithmetic<std::decay_t<T>>::value || is_pack<T>;
+
+/**
+ * Tell if current evaluation happens in a constant expression context.
+ * Used to keep constexpr functions usable at compile time while taking
+ * non-constexpr fast paths (intrinsics, libm...) at run time.
+ */
+constexpr bool is_constant_evaluated() noexcept {
+    return __builtin_is_constant_evaluated();
+}
 
 } // namespace math
 } // namespace ee
\ No newline at end of file
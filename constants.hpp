@@ -40,9 +40,9 @@ EE_CONSTANT(c_180_over_pi, T{180L} / c_pi<T>);
  */
 namespace detail {
 
-template <typename T, std::size_t R, std::size_t C, std::size_t... Is>
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t... Is>
 constexpr auto identity(std::index_sequence<Is...>) {
-    return mat<T, R, C>{(mat_i_to_r(Is, {R, C}) == mat_i_to_c(Is, {R, C}) ? T{1L} : T{0L})...};
+    return mat<T, R, C, L>{(mat_i_to_r<L>(Is, {R, C}) == mat_i_to_c<L>(Is, {R, C}) ? T{1L} : T{0L})...};
 }
 
 } // namespace detail
@@ -53,9 +53,9 @@ template <typename T>
 constexpr std::enable_if_t<false, T> c_identity{};
 
 // Matrix identity specialization
-template <typename T, std::size_t R, std::size_t C>
-constexpr auto c_identity<mat<T, R, C>> =
-detail::identity<T, R, C>(std::make_index_sequence<R * C>());
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto c_identity<mat<T, R, C, L>> =
+detail::identity<T, R, C, L>(std::make_index_sequence<R * C>());
 
 // Quaternion identity specialization
 template <typename T>
@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+/**
+ * Runtime CPU dispatch of the batch functions (bulk linear_map, affine_map,
+ * projective_map, mul, inv and normalize).
+ * Define EE_MATH_DISPATCH to 1 (GCC or Clang on x86) to compile their kernels
+ * once per tier, each with the instructions of its tier, the best one the CPU
+ * supports being picked at first use. A single binary built for the baseline
+ * target then runs AVX2 or AVX-512 kernels where available.
+ * Environment variable EE_MATH_SIMD_TIER (scalar, sse2, sse4.2, avx2 or avx512)
+ * lowers the tier, for benchmarks and to reproduce issues; set_simd_tier does
+ * the same from code. Tiers above what the CPU supports are never used.
+ * Without EE_MATH_DISPATCH, kernels of the tier the build flags allow are
+ * used, e.g. sse2 for the x86-64 baseline or avx2 with -mavx2 -mfma, and the
+ * maps keep their EE_MATH_SSE path.
+ * Kernels the widest registers do not speed up cap their lanes, see
+ * c_capped_tier.
+ * FMA contraction in the avx2 and avx512 tiers may change results by an ulp.
+ */
+#ifndef EE_MATH_DISPATCH
+#define EE_MATH_DISPATCH 0
+#endif
+
+#if EE_MATH_DISPATCH && ! ((defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)))
+#undef EE_MATH_DISPATCH
+#define EE_MATH_DISPATCH 0
+#endif
+
+namespace ee {
+namespace math {
+
+/**
+ * Instruction sets kernels are compiled for, in increasing order.
+ */
+enum class simd_tier {
+    scalar,
+    sse2,
+    sse4_2,
+    avx2,
+    avx512
+};
+
+/**
+ * Lanes of T per register in tier K, 1 for scalar.
+ */
+template <simd_tier K, typename T>
+constexpr std::size_t c_tier_lanes =
+    K == simd_tier::avx512 ? 64 / sizeof(T) :
+    K == simd_tier::avx2   ? 32 / sizeof(T) :
+    K == simd_tier::sse4_2 || K == simd_tier::sse2 ? 16 / sizeof(T) : 1;
+
+inline const char* simd_tier_name(simd_tier tier) {
+    switch (tier) {
+    case simd_tier::sse2:
+        return "sse2";
+    case simd_tier::sse4_2:
+        return "sse4.2";
+    case simd_tier::avx2:
+        return "avx2";
+    case simd_tier::avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+/**
+ * Best tier of the build flags.
+ */
+constexpr simd_tier c_compiled_simd_tier =
+#if defined(__AVX512F__)
+    simd_tier::avx512;
+#elif defined(__AVX2__) && defined(__FMA__)
+    simd_tier::avx2;
+#elif defined(__SSE4_2__)
+    simd_tier::sse4_2;
+#elif defined(__SSE2__) || defined(_M_X64)
+    simd_tier::sse2;
+#else
+    simd_tier::scalar;
+#endif
+
+/**
+ * Best tier of the CPU, c_compiled_simd_tier without EE_MATH_DISPATCH.
+ */
+inline simd_tier cpu_simd_tier() {
+#if EE_MATH_DISPATCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return simd_tier::avx512;
+    }
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return simd_tier::avx2;
+    }
+
+    if (__builtin_cpu_supports("sse4.2")) {
+        return simd_tier::sse4_2;
+    }
+
+    if (__builtin_cpu_supports("sse2")) {
+        return simd_tier::sse2;
+    }
+
+    return simd_tier::scalar;
+#else
+    return c_compiled_simd_tier;
+#endif
+}
+
+namespace detail {
+
+/**
+ * cpu_simd_tier, lowered by EE_MATH_SIMD_TIER.
+ */
+inline simd_tier initial_simd_tier() {
+    const simd_tier cpu = cpu_simd_tier();
+    const char* env = std::getenv("EE_MATH_SIMD_TIER");
+
+    if (env == nullptr) {
+        return cpu;
+    }
+
+    for (simd_tier tier : {simd_tier::scalar, simd_tier::sse2, simd_tier::sse4_2, simd_tier::avx2,
+        simd_tier::avx512}) {
+        if (std::strcmp(env, simd_tier_name(tier)) == 0) {
+            return tier < cpu ? tier : cpu;
+        }
+    }
+
+    return cpu;
+}
+
+inline std::atomic<simd_tier>& active_simd_tier() {
+    static std::atomic<simd_tier> tier{initial_simd_tier()};
+
+    return tier;
+}
+
+} // namespace detail
+
+/**
+ * Tier batch functions currently use.
+ */
+inline simd_tier current_simd_tier() {
+    return detail::active_simd_tier().load(std::memory_order_relaxed);
+}
+
+/**
+ * Make batch functions use tier, or the best one the CPU supports if lower.
+ * Returns the tier now in use.
+ */
+inline simd_tier set_simd_tier(simd_tier tier) {
+    const simd_tier cpu = cpu_simd_tier();
+
+    tier = tier < cpu ? tier : cpu;
+
+    detail::active_simd_tier().store(tier, std::memory_order_relaxed);
+
+    return tier;
+}
+
+namespace detail {
+
+template <simd_tier K>
+using tier_constant = std::integral_constant<simd_tier, K>;
+
+/**
+ * Tier K, at most Max : lanes of kernels which are slower in wider registers
+ * (per bench/dispatch.cpp) stay those of Max, their instructions those of K.
+ */
+template <simd_tier K, simd_tier Max>
+constexpr simd_tier c_capped_tier = K < Max ? K : Max;
+
+#if EE_MATH_DISPATCH
+/**
+ * f(tier_constant<K>) with everything it calls inlined and compiled for K.
+ */
+template <typename F>
+__attribute__((target("avx512f,avx2,fma"), flatten)) auto run_avx512(const F& f) {
+    return f(tier_constant<simd_tier::avx512>{});
+}
+
+template <typename F>
+__attribute__((target("avx2,fma"), flatten)) auto run_avx2(const F& f) {
+    return f(tier_constant<simd_tier::avx2>{});
+}
+
+template <typename F>
+__attribute__((target("sse4.2"), flatten)) auto run_sse4_2(const F& f) {
+    return f(tier_constant<simd_tier::sse4_2>{});
+}
+
+template <typename F>
+__attribute__((target("sse2"), flatten)) auto run_sse2(const F& f) {
+    return f(tier_constant<simd_tier::sse2>{});
+}
+
+/**
+ * Call f with the tier_constant of the current tier, f being a generic
+ * lambda whose body is the kernel.
+ */
+template <typename F>
+auto dispatch(const F& f) {
+    switch (current_simd_tier()) {
+    case simd_tier::avx512:
+        return run_avx512(f);
+    case simd_tier::avx2:
+        return run_avx2(f);
+    case simd_tier::sse4_2:
+        return run_sse4_2(f);
+    case simd_tier::sse2:
+        return run_sse2(f);
+    default:
+        return f(tier_constant<simd_tier::scalar>{});
+    }
+}
+#else
+template <typename F>
+auto dispatch(const F& f) {
+    const simd_tier tier = current_simd_tier();
+
+    if constexpr (c_compiled_simd_tier >= simd_tier::avx512) {
+        if (tier == simd_tier::avx512) {
+            return f(tier_constant<simd_tier::avx512>{});
+        }
+    }
+
+    if constexpr (c_compiled_simd_tier >= simd_tier::avx2) {
+        if (tier == simd_tier::avx2) {
+            return f(tier_constant<simd_tier::avx2>{});
+        }
+    }
+
+    if constexpr (c_compiled_simd_tier >= simd_tier::sse4_2) {
+        if (tier == simd_tier::sse4_2) {
+            return f(tier_constant<simd_tier::sse4_2>{});
+        }
+    }
+
+    if constexpr (c_compiled_simd_tier >= simd_tier::sse2) {
+        if (tier == simd_tier::sse2) {
+            return f(tier_constant<simd_tier::sse2>{});
+        }
+    }
+
+    return f(tier_constant<simd_tier::scalar>{});
+}
+#endif
+
+} // namespace detail
+
+} // namespace math
+} // namespace ee
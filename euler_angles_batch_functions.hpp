@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "basis_functions.hpp"
+#include "euler_angles.hpp"
+#include "euler_angles_functions.hpp"
+#include "functions.hpp"
+#include "mat.hpp"
+#include "mat_functions.hpp"
+#include "pack.hpp"
+#include "quat.hpp"
+#include "simd.hpp"
+#include "vec.hpp"
+#include "vec_functions.hpp"
+
+/**
+ * Batched conversions between Euler or Tait-Bryan angles and quaternions or
+ * rotation matrices, e.g. for IMU logs. Each function reads n values from in
+ * and writes n results to out.
+ * With EE_MATH_SIMD, precise double angles, and float ones with AVX, are
+ * converted four samples at a time, as the lanes of pack<T, 4> : sines and
+ * cosines of alpha, beta and gamma each come from one simd::sincos, then the
+ * rotations or quaternions of the four samples are built at once with the
+ * single sample formulas on vec, mat and quat of packs, and transposed to out
+ * (see scatter). Basis permutations are resolved at compile time (see
+ * basis_functions.hpp) and only select which packs go where. Other batches
+ * go sample by sample, libm or approximated sines and cosines gaining nothing
+ * from packs.
+ * Results are the ones of the single sample functions, but for the last bit
+ * where the compiler contracts operations on lanes to FMA differently, and for
+ * float sines and cosines, from the double lanes of simd::sincos rather than
+ * libm.
+ * Conversions to angles go sample by sample, atan2 having no SIMD form.
+ */
+
+namespace ee {
+namespace math {
+
+namespace detail {
+
+/**
+ * Tell if sines and cosines of 4 lanes come from one simd::sincos, faster than
+ * libm calls : for precise double, and float with AVX only, the double lanes
+ * taking two SSE registers. Batches are converted sample by sample otherwise.
+ */
+template <typename T, typename P>
+constexpr bool has_sincos_lanes() {
+#if EE_MATH_SSE
+    return std::is_same<P, precise>::value && (std::is_same<T, double>::value || (std::is_same<T, float>::value && simd::has_avx));
+#else
+    return false;
+#endif
+}
+
+/**
+ * Sines and cosines of the lanes of v, lane by lane when simd::sincos declines
+ * them (not finite, or too large).
+ */
+template <typename T, typename P>
+sin_cos<pack<T, 4>> sincos_lanes(const pack<T, 4>& v, P p) {
+#if EE_MATH_SSE
+    using L = simd::detail::f64x4;
+
+    L::type s;
+    L::type c;
+
+    // Stored whole to the packs, as lane by lane stores would not forward to their loads.
+    if (simd::detail::sincos(L::set(v[0], v[1], v[2], v[3]), &s, &c)) {
+        sin_cos<pack<T, 4>> result;
+
+        L::store(s, reinterpret_cast<T*>(&result.sin.v));
+        L::store(c, reinterpret_cast<T*>(&result.cos.v));
+
+        return result;
+    }
+#endif
+
+    return ee::math::sincos(v, p);
+}
+
+/**
+ * Sines and cosines of the angles of the 4 samples from in, scaled by s (1,
+ * or 0.5 for quaternions), a lane per sample.
+ */
+template <typename A, typename T, typename P>
+sin_cos<vec<pack<T, 4>, 3>> sincos_of_4(const A* in, T s, P p) {
+    using N = typename pack<T, 4>::native_type;
+
+    const sin_cos<pack<T, 4>> a = sincos_lanes(s * pack<T, 4>{N{in[0].alpha, in[1].alpha, in[2].alpha, in[3].alpha}}, p);
+    const sin_cos<pack<T, 4>> b = sincos_lanes(s * pack<T, 4>{N{in[0].beta,  in[1].beta,  in[2].beta,  in[3].beta}},  p);
+    const sin_cos<pack<T, 4>> g = sincos_lanes(s * pack<T, 4>{N{in[0].gamma, in[1].gamma, in[2].gamma, in[3].gamma}}, p);
+
+    return {{a.sin, b.sin, g.sin}, {a.cos, b.cos, g.cos}};
+}
+
+} // namespace detail
+
+/**
+ * Transformation matrices (mat3x3, mat3x4 or mat4x4) describing rotations
+ * from n Euler angles.
+ */
+template <std::size_t R, std::size_t C, typename T, typename B, typename P = precise>
+void mat_from(const euler_angles<T, B>* in, mat<T, R, C>* out, std::size_t n, P p = {}) {
+    std::size_t i = 0;
+
+    if constexpr (detail::has_sincos_lanes<T, P>()) {
+        for (; i + 4 <= n; i += 4) {
+            const sin_cos<vec<pack<T, 4>, 3>> sc = detail::sincos_of_4(in + i, T{1L}, p);
+
+            scatter(detail::rotation_as<R, C>(from_basis<B>(detail::euler_rotation(sc))), out + i);
+        }
+    }
+
+    for (; i < n; ++ i) {
+        out[i] = mat_from<R, C>(in[i], p);
+    }
+}
+
+/**
+ * Transformation matrices (mat3x3, mat3x4 or mat4x4) describing rotations
+ * from n Tait-Bryan angles.
+ */
+template <std::size_t R, std::size_t C, typename T, typename B, typename P = precise>
+void mat_from(const tait_bryan_angles<T, B>* in, mat<T, R, C>* out, std::size_t n, P p = {}) {
+    std::size_t i = 0;
+
+    if constexpr (detail::has_sincos_lanes<T, P>()) {
+        for (; i + 4 <= n; i += 4) {
+            const sin_cos<vec<pack<T, 4>, 3>> sc = detail::sincos_of_4(in + i, T{1L}, p);
+
+            scatter(detail::rotation_as<R, C>(from_basis<B>(detail::tait_bryan_rotation(sc))), out + i);
+        }
+    }
+
+    for (; i < n; ++ i) {
+        out[i] = mat_from<R, C>(in[i], p);
+    }
+}
+
+/**
+ * Quaternions describing rotations from n Euler angles.
+ */
+template <typename T, typename B, typename P = precise>
+void quat_from(const euler_angles<T, B>* in, quat<T>* out, std::size_t n, P p = {}) {
+    std::size_t i = 0;
+
+    if constexpr (detail::has_sincos_lanes<T, P>()) {
+        for (; i + 4 <= n; i += 4) {
+            const sin_cos<vec<pack<T, 4>, 3>> sc = detail::sincos_of_4(in + i, T{0.5L}, p);
+
+            scatter(from_basis<B>(detail::euler_quat(sc)), out + i);
+        }
+    }
+
+    for (; i < n; ++ i) {
+        out[i] = quat_from(in[i], p);
+    }
+}
+
+/**
+ * Quaternions describing rotations from n Tait-Bryan angles.
+ */
+template <typename T, typename B, typename P = precise>
+void quat_from(const tait_bryan_angles<T, B>* in, quat<T>* out, std::size_t n, P p = {}) {
+    std::size_t i = 0;
+
+    if constexpr (detail::has_sincos_lanes<T, P>()) {
+        for (; i + 4 <= n; i += 4) {
+            const sin_cos<vec<pack<T, 4>, 3>> sc = detail::sincos_of_4(in + i, T{0.5L}, p);
+
+            scatter(from_basis<B>(detail::tait_bryan_quat(sc)), out + i);
+        }
+    }
+
+    for (; i < n; ++ i) {
+        out[i] = quat_from(in[i], p);
+    }
+}
+
+/**
+ * Euler angles, in B, of n rotations given as normalized quaternions or as
+ * transformation matrices (mat3x3, mat3x4 or mat4x4).
+ */
+template <typename T, typename B, typename P = precise>
+void euler_angles_from(const quat<T>* in, euler_angles<T, B>* out, std::size_t n, P p = {}) {
+    for (std::size_t i = 0; i < n; ++ i) {
+        out[i] = euler_angles_from<B>(in[i], p);
+    }
+}
+
+template <typename T, std::size_t R, std::size_t C, typename L, typename B, typename P = precise>
+void euler_angles_from(const mat<T, R, C, L>* in, euler_angles<T, B>* out, std::size_t n, P p = {}) {
+    for (std::size_t i = 0; i < n; ++ i) {
+        out[i] = euler_angles_from<B>(in[i], p);
+    }
+}
+
+/**
+ * Tait-Bryan angles, in B, of n rotations given as normalized quaternions or
+ * as transformation matrices (mat3x3, mat3x4 or mat4x4).
+ */
+template <typename T, typename B, typename P = precise>
+void tait_bryan_angles_from(const quat<T>* in, tait_bryan_angles<T, B>* out, std::size_t n, P p = {}) {
+    for (std::size_t i = 0; i < n; ++ i) {
+        out[i] = tait_bryan_angles_from<B>(in[i], p);
+    }
+}
+
+template <typename T, std::size_t R, std::size_t C, typename L, typename B, typename P = precise>
+void tait_bryan_angles_from(const mat<T, R, C, L>* in, tait_bryan_angles<T, B>* out, std::size_t n, P p = {}) {
+    for (std::size_t i = 0; i < n; ++ i) {
+        out[i] = tait_bryan_angles_from<B>(in[i], p);
+    }
+}
+
+} // namespace math
+} // namespace ee
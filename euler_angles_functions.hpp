@@ -8,137 +8,280 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 
 #include "euler_angles.hpp"
 
 #include "basis_functions.hpp"
 #include "mat.hpp"
+#include "mat_functions.hpp"
 #include "quat.hpp"
+#include "quat_functions.hpp"
+#include "vec.hpp"
+#include "vec_functions.hpp"
 
 namespace ee {
 namespace math {
 
+namespace detail {
+
 /**
- * Return matrix describing rotation from Euler angles.
+ * Rotation mat3x3 of Euler angles in basis<xpos, ypos, zpos>, from sines and
+ * cosines of alpha, beta and gamma.
  */
-template <typename T, typename B>
-mat<T, 4, 4> mat_from(const euler_angles<T, B>& ea) {
-    const T cos_a = std::cos(ea.alpha);
-    const T sin_a = std::sin(ea.alpha);
+template <typename T>
+constexpr mat<T, 3, 3> euler_rotation(const sin_cos<vec<T, 3>>& sc) {
+    const T cos_a = sc.cos(0);
+    const T sin_a = sc.sin(0);
 
-    const T cos_b = std::cos(ea.beta);
-    const T sin_b = std::sin(ea.beta);
+    const T cos_b = sc.cos(1);
+    const T sin_b = sc.sin(1);
 
-    const T cos_g = std::cos(ea.gamma);
-    const T sin_g = std::sin(ea.gamma);
+    const T cos_g = sc.cos(2);
+    const T sin_g = sc.sin(2);
 
     const T cos_a_cos_g = cos_a * cos_g;
     const T sin_a_sin_g = sin_a * sin_g;
     const T cos_g_sin_a = cos_g * sin_a;
     const T cos_a_sin_g = cos_a * sin_g;
 
-    return from_basis<B>(mat<T, 4, 4>{
+    return {
           cos_a_cos_g - cos_b * sin_a_sin_g,
           cos_g_sin_a + cos_a_sin_g * cos_b,
           sin_b * sin_g,
-          T{0L},
 
         - cos_a_sin_g - cos_b * cos_g_sin_a,
           cos_a_cos_g * cos_b - sin_a_sin_g,
           cos_g * sin_b,
-          T{0L},
 
           sin_a * sin_b,
         - cos_a * sin_b,
-          cos_b,
-          T{0L},
-
-          T{0L}, T{0L}, T{0L}, T{1L}});
+          cos_b};
 }
 
 /**
- * Return matrix describing rotation from Tait-Bryan angles.
+ * Rotation mat3x3 of Tait-Bryan angles in basis<xpos, ypos, zpos>, from sines
+ * and cosines of alpha, beta and gamma.
  */
-template <typename T, typename B>
-mat<T, 4, 4> mat_from(const tait_bryan_angles<T, B>& ea) {
-    const T cos_a = std::cos(ea.alpha);
-    const T sin_a = std::sin(ea.alpha);
+template <typename T>
+constexpr mat<T, 3, 3> tait_bryan_rotation(const sin_cos<vec<T, 3>>& sc) {
+    const T cos_a = sc.cos(0);
+    const T sin_a = sc.sin(0);
 
-    const T cos_b = std::cos(ea.beta);
-    const T sin_b = std::sin(ea.beta);
+    const T cos_b = sc.cos(1);
+    const T sin_b = sc.sin(1);
 
-    const T cos_g = std::cos(ea.gamma);
-    const T sin_g = std::sin(ea.gamma);
+    const T cos_g = sc.cos(2);
+    const T sin_g = sc.sin(2);
 
     const T cos_a_cos_g = cos_a * cos_g;
     const T sin_b_sin_g = sin_b * sin_g;
     const T cos_g_sin_a = cos_g * sin_a;
 
-    return from_basis<B>(mat<T, 4, 4>{
+    return {
           cos_a * cos_b,
           cos_b * sin_a,
         - sin_b,
-          T{0L},
 
           cos_a * sin_b_sin_g - cos_g_sin_a,
           cos_a_cos_g + sin_a * sin_b_sin_g,
           cos_b * sin_g,
-          T{0L},
 
           sin_a * sin_g + cos_a_cos_g * sin_b,
           cos_g_sin_a * sin_b - cos_a * sin_g,
-          cos_b * cos_g,
-          T{0L},
-
-          T{0L}, T{0L}, T{0L}, T{1L}});
+          cos_b * cos_g};
 }
 
 /**
- * Return quaternion describing rotation from Euler angles.
+ * Quaternion of Euler angles in basis<xpos, ypos, zpos>, from sines and
+ * cosines of half alpha, beta and gamma.
  */
-template <typename T, typename B>
-quat<T> quat_from(const euler_angles<T, B>& ea) {
-    const T     a = T{0.5L} * ea.alpha;
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
+template <typename T>
+constexpr quat<T> euler_quat(const sin_cos<vec<T, 3>>& sc) {
+    const T cos_a = sc.cos(0);
+    const T sin_a = sc.sin(0);
 
-    const T     b = T{0.5L} * ea.beta;
-    const T cos_b = std::cos(b);
-    const T sin_b = std::sin(b);
+    const T cos_b = sc.cos(1);
+    const T sin_b = sc.sin(1);
 
-    const T     g = T{0.5L} * ea.gamma;
-    const T cos_g = std::cos(g);
-    const T sin_g = std::sin(g);
+    const T cos_g = sc.cos(2);
+    const T sin_g = sc.sin(2);
 
-    return from_basis<B>(quat<T>{
+    return {
         cos_a * sin_b * cos_g + sin_a * sin_b * sin_g,
         sin_a * sin_b * cos_g - cos_a * sin_b * sin_g,
         sin_a * cos_b * cos_g + cos_a * cos_b * sin_g,
-        cos_a * cos_b * cos_g - sin_a * cos_b * sin_g});
+        cos_a * cos_b * cos_g - sin_a * cos_b * sin_g};
 }
 
 /**
- * Return quaternion describing rotation from Tait-Bryan angles.
+ * Quaternion of Tait-Bryan angles in basis<xpos, ypos, zpos>, from sines and
+ * cosines of half alpha, beta and gamma.
  */
-template <typename T, typename B>
-quat<T> quat_from(const tait_bryan_angles<T, B>& tba) {
-    const T     a = T{0.5L} * tba.alpha;
-    const T cos_a = std::cos(a);
-    const T sin_a = std::sin(a);
+template <typename T>
+constexpr quat<T> tait_bryan_quat(const sin_cos<vec<T, 3>>& sc) {
+    const T cos_a = sc.cos(0);
+    const T sin_a = sc.sin(0);
 
-    const T     b = T{0.5L} * tba.beta;
-    const T cos_b = std::cos(b);
-    const T sin_b = std::sin(b);
+    const T cos_b = sc.cos(1);
+    const T sin_b = sc.sin(1);
 
-    const T     g = T{0.5L} * tba.gamma;
-    const T cos_g = std::cos(g);
-    const T sin_g = std::sin(g);
+    const T cos_g = sc.cos(2);
+    const T sin_g = sc.sin(2);
 
-    return from_basis<B>(quat<T>{
+    return {
         cos_a * cos_b * sin_g - sin_a * sin_b * cos_g,
         cos_a * sin_b * cos_g + sin_a * cos_b * sin_g,
         sin_a * cos_b * cos_g - cos_a * sin_b * sin_g,
-        cos_a * cos_b * cos_g + sin_a * sin_b * sin_g});
+        cos_a * cos_b * cos_g + sin_a * sin_b * sin_g};
+}
+
+/**
+ * Euler angles of a rotation mat3x3 in basis<xpos, ypos, zpos>.
+ * beta comes from its sine and cosine, accurate over [0, pi]. alpha is then
+ * read from the rotation gamma removed, so that their split stays consistent
+ * near gimbal lock, where gamma is arbitrary.
+ */
+template <typename T, typename P>
+constexpr vec<T, 3> euler_angles_of(const mat<T, 3, 3>& M, P p) {
+    const T gamma = atan2(M(2, 0), M(2, 1), p);
+    const T beta  = atan2(sqrt(M(2, 0) * M(2, 0) + M(2, 1) * M(2, 1)), M(2, 2), p);
+
+    const sin_cos<T> g = ee::math::sincos(gamma, p);
+
+    const T alpha = atan2(
+        g.cos * M(1, 0) - g.sin * M(1, 1),
+        g.cos * M(0, 0) - g.sin * M(0, 1), p);
+
+    return {alpha, beta, gamma};
+}
+
+/**
+ * Tait-Bryan angles of a rotation mat3x3 in basis<xpos, ypos, zpos>, beta
+ * being in [-pi / 2, pi / 2]. Same approach as euler_angles_of.
+ */
+template <typename T, typename P>
+constexpr vec<T, 3> tait_bryan_angles_of(const mat<T, 3, 3>& M, P p) {
+    const T gamma = atan2(M(2, 1), M(2, 2), p);
+    const T beta  = atan2(- M(2, 0), sqrt(M(2, 1) * M(2, 1) + M(2, 2) * M(2, 2)), p);
+
+    const sin_cos<T> g = ee::math::sincos(gamma, p);
+
+    const T alpha = atan2(
+        g.sin * M(0, 2) - g.cos * M(0, 1),
+        g.cos * M(1, 1) - g.sin * M(1, 2), p);
+
+    return {alpha, beta, gamma};
+}
+
+} // namespace detail
+
+/**
+ * Return transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation from Euler angles.
+ */
+template <std::size_t R, std::size_t C, typename T, typename B, typename P = precise>
+constexpr mat<T, R, C> mat_from(const euler_angles<T, B>& ea, P p = {}) {
+    const sin_cos<vec<T, 3>> sc = sincos(vec<T, 3>{ea.alpha, ea.beta, ea.gamma}, p);
+
+    return detail::rotation_as<R, C>(from_basis<B>(detail::euler_rotation(sc)));
+}
+
+/**
+ * Return matrix describing rotation from Euler angles.
+ */
+template <typename T, typename B, typename P = precise>
+constexpr mat<T, 4, 4> mat_from(const euler_angles<T, B>& ea, P p = {}) {
+    return mat_from<4, 4>(ea, p);
+}
+
+/**
+ * Return transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation from Tait-Bryan angles.
+ */
+template <std::size_t R, std::size_t C, typename T, typename B, typename P = precise>
+constexpr mat<T, R, C> mat_from(const tait_bryan_angles<T, B>& ea, P p = {}) {
+    const sin_cos<vec<T, 3>> sc = sincos(vec<T, 3>{ea.alpha, ea.beta, ea.gamma}, p);
+
+    return detail::rotation_as<R, C>(from_basis<B>(detail::tait_bryan_rotation(sc)));
+}
+
+/**
+ * Return matrix describing rotation from Tait-Bryan angles.
+ */
+template <typename T, typename B, typename P = precise>
+constexpr mat<T, 4, 4> mat_from(const tait_bryan_angles<T, B>& ea, P p = {}) {
+    return mat_from<4, 4>(ea, p);
+}
+
+/**
+ * Return quaternion describing rotation from Euler angles.
+ */
+template <typename T, typename B, typename P = precise>
+constexpr quat<T> quat_from(const euler_angles<T, B>& ea, P p = {}) {
+    const sin_cos<vec<T, 3>> sc = sincos(vec<T, 3>{
+        T{0.5L} * ea.alpha,
+        T{0.5L} * ea.beta,
+        T{0.5L} * ea.gamma}, p);
+
+    return from_basis<B>(detail::euler_quat(sc));
+}
+
+/**
+ * Return quaternion describing rotation from Tait-Bryan angles.
+ */
+template <typename T, typename B, typename P = precise>
+constexpr quat<T> quat_from(const tait_bryan_angles<T, B>& tba, P p = {}) {
+    const sin_cos<vec<T, 3>> sc = sincos(vec<T, 3>{
+        T{0.5L} * tba.alpha,
+        T{0.5L} * tba.beta,
+        T{0.5L} * tba.gamma}, p);
+
+    return from_basis<B>(detail::tait_bryan_quat(sc));
+}
+
+/**
+ * Return Euler angles, in B, of the rotation described by m (mat3x3, mat3x4
+ * or mat4x4, only its rotation part being read).
+ * beta is in [0, pi], alpha and gamma in [-pi, pi]. Near gimbal lock (beta
+ * close to 0 or pi) only alpha + gamma, or alpha - gamma, is meaningful.
+ */
+template <typename B = basis<xpos, ypos, zpos>, typename T, std::size_t R, std::size_t C, typename L, typename P = precise>
+constexpr euler_angles<T, B> euler_angles_from(const mat<T, R, C, L>& m, P p = {}) {
+    const vec<T, 3> a = detail::euler_angles_of(to_basis<B>(detail::rotation_of(m)), p);
+
+    return {a(0), a(1), a(2)};
+}
+
+/**
+ * Return Euler angles, in B, of the rotation of the normalized quaternion q.
+ */
+template <typename B = basis<xpos, ypos, zpos>, typename T, typename P = precise>
+constexpr euler_angles<T, B> euler_angles_from(const quat<T>& q, P p = {}) {
+    return euler_angles_from<B>(mat_from<3, 3>(q), p);
+}
+
+/**
+ * Return Tait-Bryan angles, in B, of the rotation described by m (mat3x3,
+ * mat3x4 or mat4x4, only its rotation part being read).
+ * beta is in [-pi / 2, pi / 2], alpha and gamma in [-pi, pi]. Near gimbal
+ * lock (beta close to -pi / 2 or pi / 2) only alpha + gamma, or
+ * alpha - gamma, is meaningful.
+ */
+template <typename B = basis<zpos, xpos, ypos>, typename T, std::size_t R, std::size_t C, typename L, typename P = precise>
+constexpr tait_bryan_angles<T, B> tait_bryan_angles_from(const mat<T, R, C, L>& m, P p = {}) {
+    const vec<T, 3> a = detail::tait_bryan_angles_of(to_basis<B>(detail::rotation_of(m)), p);
+
+    return {a(0), a(1), a(2)};
+}
+
+/**
+ * Return Tait-Bryan angles, in B, of the rotation of the normalized
+ * quaternion q.
+ */
+template <typename B = basis<zpos, xpos, ypos>, typename T, typename P = precise>
+constexpr tait_bryan_angles<T, B> tait_bryan_angles_from(const quat<T>& q, P p = {}) {
+    return tait_bryan_angles_from<B>(mat_from<3, 3>(q), p);
 }
 
 } // namespace math
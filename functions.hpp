@@ -8,9 +8,21 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
 
 #include <ee_utils/templates.hpp>
 
+#include "common.hpp"
+#include "precision.hpp"
+
 /**
  * All functions here are instances of unamed structs. It allows direct call
  * like standard functions but also using them as functors for componentwise
@@ -22,6 +34,344 @@ namespace math {
 
 using tutil::eif;
 
+/**
+ * Constant evaluation implementations, used by the functors below when
+ * evaluated at compile time, libm being used otherwise.
+ * Computations are done in long double and rounded once to the result type,
+ * giving results within 1 ulp of the correctly rounded ones for float and
+ * double where long double has a 64 bits mantissa (x86). Elsewhere, expect a
+ * few ulp for double. Signed zeros are not told apart.
+ */
+namespace detail {
+
+using const_float = long double;
+
+constexpr const_float c_const_pi   = 3.14159265358979323846264338327950288L;
+constexpr const_float c_const_pi_2 = 1.57079632679489661923132169163993144L;
+constexpr const_float c_const_pi_6 = 0.52359877559829887307710723054658381L;
+constexpr const_float c_const_sqrt3 = 1.73205080756887729352744634150587237L;
+
+template <typename T>
+constexpr bool const_is_nan(T v) {
+    return v != v;
+}
+
+template <typename T>
+constexpr bool const_is_inf(T v) {
+    return v == std::numeric_limits<T>::infinity() || v == - std::numeric_limits<T>::infinity();
+}
+
+/**
+ * Integral part, v being finite.
+ */
+template <typename T>
+constexpr T const_trunc(T v) {
+    // From there on, every floating point value is an integer.
+    constexpr T integral = T{1L} * (std::uintmax_t{1} << (std::numeric_limits<T>::digits - 1));
+
+    if (const_is_nan(v) || ! (v < integral && - integral < v)) {
+        return v;
+    }
+
+    return static_cast<T>(static_cast<std::intmax_t>(v));
+}
+
+/**
+ * IEEE remainder : lhs - n * rhs, n being the integer nearest to lhs / rhs,
+ * ties to even. Computed exactly by long division.
+ */
+template <typename T>
+constexpr T const_remainder(T lhs, T rhs) {
+    if (const_is_nan(lhs) || const_is_nan(rhs) || const_is_inf(lhs) || rhs == T{0L}) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    if (const_is_inf(rhs)) {
+        return lhs;
+    }
+
+    const T y = rhs < T{0L} ? - rhs : rhs;
+    T r = lhs < T{0L} ? - lhs : lhs;
+    bool odd = false;
+
+    while (r >= y) {
+        T s = y;
+
+        // Largest y * 2^k lesser or equal to r, subtracting it is exact.
+        while (s <= r / T{2L}) {
+            s *= T{2L};
+        }
+
+        r -= s;
+        odd = s == y;
+    }
+
+    if (r > y / T{2L} || (r == y / T{2L} && odd)) {
+        r -= y;
+    }
+
+    return lhs < T{0L} ? - r : r;
+}
+
+template <typename T>
+constexpr T const_sqrt(T v) {
+    if (const_is_nan(v) || v < T{0L}) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    if (v == T{0L} || const_is_inf(v)) {
+        return v;
+    }
+
+    // v = x * 4^e with x in [1, 4), scaling by powers of 2 being exact.
+    const_float x = v;
+    const_float scale = 1.0L;
+
+    while (x >= 4.0L) {
+        x *= 0.25L;
+        scale *= 2.0L;
+    }
+
+    while (x < 1.0L) {
+        x *= 4.0L;
+        scale *= 0.5L;
+    }
+
+    // Newton iterations, quadratic convergence from a 1.5 start.
+    const_float r = 1.5L;
+
+    for (int i = 0; i < 6; ++ i) {
+        r = 0.5L * (r + x / r);
+    }
+
+    return static_cast<T>(r * scale);
+}
+
+/**
+ * Sine and cosine of r in [-pi / 4, pi / 4], Taylor series.
+ */
+constexpr const_float const_sin_kernel(const_float r) {
+    const const_float r2 = r * r;
+    const_float term = r;
+    const_float sum = r;
+
+    for (int n = 2; n < 40; n += 2) {
+        term *= - r2 / (n * (n + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+
+constexpr const_float const_cos_kernel(const_float r) {
+    const const_float r2 = r * r;
+    const_float term = 1.0L;
+    const_float sum = 1.0L;
+
+    for (int n = 1; n < 40; n += 2) {
+        term *= - r2 / (n * (n + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+
+/**
+ * Not a constant expression : reached by const_reduce out of its range, it
+ * makes constant evaluation fail instead of giving a wrong result.
+ */
+inline const_float const_reduce_out_of_range() {
+    return std::numeric_limits<const_float>::quiet_NaN();
+}
+
+/**
+ * v - k * pi / 2 in [-pi / 4, pi / 4], k nearest integer to v / (pi / 2).
+ * Cody-Waite reduction with pi / 2 split in parts of 33 bits (fdlibm ones).
+ * Products by k are exact while k has at most digits - 33 bits, which limits
+ * v to |v| < 2^31 pi / 2 (3.3e9) where long double has a 64 bits mantissa,
+ * and to |v| < 2^20 pi / 2 (1.6e6) where long double is double. Beyond that,
+ * constant evaluation fails (libm takes any v at run time).
+ */
+constexpr const_float const_reduce(const_float v, long long* k) {
+    constexpr const_float pio2_1  = 1.57079632673412561417e+00L;
+    constexpr const_float pio2_2  = 6.07710050630396597660e-11L;
+    constexpr const_float pio2_3  = 2.02226624871116645580e-21L;
+    constexpr const_float pio2_3t = 8.47842766036889956997e-32L;
+
+    // Also keeps k within long long.
+    constexpr int k_bits = std::numeric_limits<const_float>::digits - 33 < 62 ?
+        std::numeric_limits<const_float>::digits - 33 : 62;
+    constexpr const_float q_max = static_cast<const_float>(std::uintmax_t{1} << k_bits) - 1.0L;
+
+    const const_float q = v / c_const_pi_2;
+
+    if (! (- q_max < q && q < q_max)) {
+        *k = 0;
+
+        return const_reduce_out_of_range();
+    }
+
+    const_float n = static_cast<const_float>(static_cast<long long>(q));
+
+    if (q - n >= 0.5L) {
+        n += 1.0L;
+    } else if (q - n <= - 0.5L) {
+        n -= 1.0L;
+    }
+
+    *k = static_cast<long long>(n);
+
+    return (((v - n * pio2_1) - n * pio2_2) - n * pio2_3) - n * pio2_3t;
+}
+
+template <typename T>
+constexpr const_float const_sin_cos(T v, bool cosine) {
+    long long k = 0;
+    const const_float r = const_reduce(v, &k);
+    const long long quadrant = ((k % 4) + 4 + (cosine ? 1 : 0)) % 4;
+
+    switch (quadrant) {
+    case 0:
+        return const_sin_kernel(r);
+    case 1:
+        return const_cos_kernel(r);
+    case 2:
+        return - const_sin_kernel(r);
+    default:
+        return - const_cos_kernel(r);
+    }
+}
+
+template <typename T>
+constexpr T const_sin(T v) {
+    if (const_is_nan(v) || const_is_inf(v)) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    return static_cast<T>(const_sin_cos(v, false));
+}
+
+template <typename T>
+constexpr T const_cos(T v) {
+    if (const_is_nan(v) || const_is_inf(v)) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    return static_cast<T>(const_sin_cos(v, true));
+}
+
+template <typename T>
+constexpr T const_tan(T v) {
+    if (const_is_nan(v) || const_is_inf(v)) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    return static_cast<T>(const_sin_cos(v, false) / const_sin_cos(v, true));
+}
+
+/**
+ * Arc tangent of x in [0, 1].
+ * Reduced to [0, 2 - sqrt(3)] through atan(x) = pi / 6 + atan((sqrt(3) x - 1)
+ * / (sqrt(3) + x)), then Taylor series.
+ */
+constexpr const_float const_atan_kernel(const_float x) {
+    const_float offset = 0.0L;
+
+    if (x > 2.0L - c_const_sqrt3) {
+        x = (c_const_sqrt3 * x - 1.0L) / (c_const_sqrt3 + x);
+        offset = c_const_pi_6;
+    }
+
+    const const_float x2 = x * x;
+    const_float power = x;
+    const_float sum = 0.0L;
+
+    for (int n = 1; n < 60; n += 2) {
+        sum += power / n;
+        power *= - x2;
+    }
+
+    return offset + sum;
+}
+
+template <typename T>
+constexpr T const_atan2(T y, T x) {
+    if (const_is_nan(y) || const_is_nan(x)) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    if (y == T{0L}) {
+        return x < T{0L} ? static_cast<T>(c_const_pi) : y;
+    }
+
+    const const_float ay = y < T{0L} ? - const_float{y} : const_float{y};
+    const const_float ax = x < T{0L} ? - const_float{x} : const_float{x};
+
+    const_float a = 0.0L;
+
+    if (const_is_inf(y) && const_is_inf(x)) {
+        a = c_const_pi_2 / 2.0L;
+    } else if (ay <= ax) {
+        a = const_atan_kernel(ay / ax);
+    } else {
+        a = c_const_pi_2 - const_atan_kernel(ax / ay);
+    }
+
+    if (x < T{0L}) {
+        a = c_const_pi - a;
+    }
+
+    return static_cast<T>(y < T{0L} ? - a : a);
+}
+
+template <typename T>
+constexpr T const_acos(T v) {
+    if (const_is_nan(v) || v < T{-1L} || T{1L} < v) {
+        return std::numeric_limits<T>::quiet_NaN();
+    }
+
+    const const_float x = v;
+
+    // 1 - x and 1 + x are exact where it matters, near -1 and 1.
+    const const_float s = const_sqrt((1.0L - x) * (1.0L + x));
+
+    if (x == 0.0L) {
+        return static_cast<T>(c_const_pi_2);
+    }
+
+    const_float a = x > 0.0L ?
+        (s <= x ? const_atan_kernel(s / x) : c_const_pi_2 - const_atan_kernel(x / s)) :
+        (s <= - x ? c_const_pi - const_atan_kernel(s / - x) : c_const_pi_2 + const_atan_kernel(- x / s));
+
+    return static_cast<T>(a);
+}
+
+} // namespace detail
+
+/**
+ * Functors below apply lane by lane to packs (see pack.hpp).
+ */
+namespace detail {
+
+template <typename F, typename T, std::size_t N, typename... Ps>
+pack<T, N> lanewise(F f, const pack<T, N>& p, const Ps&... ps) {
+    pack<T, N> result{};
+
+    for (std::size_t i = 0; i < N; ++ i) {
+        result.v[i] = f(p.v[i], ps.v[i]...);
+    }
+
+    return result;
+}
+
+/**
+ * Square roots of all lanes, defined in pack.hpp.
+ */
+template <typename T, std::size_t N>
+pack<T, N> sqrt_lanes(const pack<T, N>& p);
+
+} // namespace detail
+
 /**
  * Addition.
  */
@@ -102,6 +452,11 @@ constexpr struct {
     constexpr T operator()(T v) const noexcept {
         return (T{0L} < v) - (v < T{0L});
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
 } sgn;
 
 /**
@@ -109,14 +464,23 @@ constexpr struct {
  */
 constexpr struct {
     template <typename T>
-    /*constexpr*/ eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
-        return std::trunc(value);
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::trunc(value);
+        }
+
+        return detail::const_trunc(value);
     }
 
     template <typename T>
     constexpr eif< ! std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
         return value;
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
 } trunc;
 
 /**
@@ -124,15 +488,23 @@ constexpr struct {
  */
 constexpr struct {
     template <typename T>
-    /*constexpr*/ eif<std::is_floating_point<T>::value, T> operator()(T lhs, T rhs) const noexcept {
-        return std::remainder(lhs, rhs);
-        //return lhs - trunc(lhs / rhs) * rhs;
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T lhs, T rhs) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::remainder(lhs, rhs);
+        }
+
+        return detail::const_remainder(lhs, rhs);
     }
 
     template <typename T>
     constexpr eif< ! std::is_floating_point<T>::value, T> operator()(T lhs, T rhs) const noexcept {
         return lhs % rhs;
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& lhs, const pack<T, N>& rhs) const noexcept {
+        return detail::lanewise(*this, lhs, rhs);
+    }
 } mod;
 
 /**
@@ -140,15 +512,26 @@ constexpr struct {
  */
 constexpr struct {
     template <typename T>
-    /*constexpr*/ eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
-        return std::round(value);
-        //return trunc(value + T{0.5L} * sgn(value));
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::round(value);
+        }
+
+        // Halfway cases away from zero, v - t being exact.
+        const T t = detail::const_trunc(value);
+
+        return value - t >= T{0.5L} ? t + T{1L} : value - t <= T{-0.5L} ? t - T{1L} : t;
     }
 
     template <typename T>
     constexpr eif< ! std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
         return value;
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
 } round;
 
 /**
@@ -158,10 +541,14 @@ constexpr struct {
  */
 constexpr struct {
     template <typename T>
-    /*constexpr*/ eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
-        return std::floor(value);
-        //T remainder = value - trunc(value);
-        //return value - remainder - (remainder < T{0L} ? T{1L} : T{0L});
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::floor(value);
+        }
+
+        const T t = detail::const_trunc(value);
+
+        return value < t ? t - T{1L} : t;
     }
 
     template <typename T>
@@ -170,7 +557,7 @@ constexpr struct {
     }
 
     template <typename T>
-    /*constexpr*/ eif<std::is_floating_point<T>::value, T> operator()(T value, T significance) const noexcept {
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value, T significance) const noexcept {
         T remainder = mod(value, significance);
         return value - remainder - (remainder < T{0L} ? significance : T{0L});
     }
@@ -185,6 +572,11 @@ constexpr struct {
         return value - mod(value, significance);
 #endif
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
 } floor;
 
 /**
@@ -194,10 +586,14 @@ constexpr struct {
  */
 constexpr struct {
     template <typename T>
-    /*constexpr*/ eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
-        return std::ceil(value);
-        //T remainder = value - trunc(value);
-        //return value - remainder + (remainder > T{0L} ? T{1L} : T{0L});
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::ceil(value);
+        }
+
+        const T t = detail::const_trunc(value);
+
+        return t < value ? t + T{1L} : t;
     }
 
     template <typename T>
@@ -206,7 +602,7 @@ constexpr struct {
     }
 
     template <typename T>
-    /*constexpr*/ eif<std::is_floating_point<T>::value, T> operator()(T value, T significance) const noexcept {
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value, T significance) const noexcept {
         T remainder = mod(value, significance);
         return value - remainder + (remainder > T{0L} ? significance : T{0L});
     }
@@ -221,6 +617,11 @@ constexpr struct {
         return value - mod(value, significance);
 #endif
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
 } ceil;
 
 /**
@@ -228,14 +629,24 @@ constexpr struct {
  */
 constexpr struct {
     template <typename T>
-    /*constexpr*/ eif< ! std::is_unsigned<T>::value, T> operator()(T value) const noexcept {
-        return std::abs(value);
+    constexpr eif< ! std::is_unsigned<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::abs(value);
+        }
+
+        // + 0 turns - 0 into 0.
+        return value < T{0L} ? - value : value + T{0L};
     }
 
     template <typename T>
     constexpr eif<std::is_unsigned<T>::value, T> operator()(T value) const noexcept {
         return value;
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
 } abs;
 
 /**
@@ -251,6 +662,11 @@ constexpr struct {
     constexpr const T& operator()(const T& f, const T& s, const Rs&... rs) const noexcept {
         return (*this)(s < f ? s : f, rs...);;
     }
+
+    template <typename T, std::size_t N, typename... Rs>
+    pack<T, N> operator()(const pack<T, N>& f, const pack<T, N>& s, const Rs&... rs) const noexcept {
+        return (*this)(detail::lanewise(*this, f, s), rs...);
+    }
 } min;
 
 /**
@@ -266,6 +682,11 @@ constexpr struct {
     constexpr const T& operator()(const T& f, const T& s, const Rs&... rs) const noexcept {
         return (*this)(f < s ? s : f, rs...);
     }
+
+    template <typename T, std::size_t N, typename... Rs>
+    pack<T, N> operator()(const pack<T, N>& f, const pack<T, N>& s, const Rs&... rs) const noexcept {
+        return (*this)(detail::lanewise(*this, f, s), rs...);
+    }
 } max;
 
 /**
@@ -276,6 +697,11 @@ constexpr struct {
     constexpr const T& operator()(const T& v, const T& lo, const T& hi) const noexcept {
         return lo < v ? hi < v ? hi : v : lo;
     }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& v, const pack<T, N>& lo, const pack<T, N>& hi) const noexcept {
+        return detail::lanewise(*this, v, lo, hi);
+    }
 } clamp;
 
 /**
@@ -293,5 +719,457 @@ constexpr struct {
     }
 } lerp;
 
+/**
+ * Sine and cosine of a same value.
+ */
+template <typename T>
+struct sin_cos {
+    T sin;
+    T cos;
+};
+
+/**
+ * Approximations of the fast and fastest precision policies (see
+ * precision.hpp), used by the functors below for float and double.
+ * Polynomials are minimax fits for sin and cos, from Abramowitz and Stegun
+ * (4.4.45 to 4.4.49) for atan2 and acos.
+ */
+namespace detail {
+
+template <typename T>
+constexpr bool has_approx = std::is_same<T, float>::value || std::is_same<T, double>::value;
+
+template <typename P>
+constexpr bool is_fast = std::is_same<P, fast>::value;
+
+/**
+ * Tell if sin, cos and sincos use approx_sincos. Not for float with fast :
+ * libm sinf and cosf (glibc) are as fast as its polynomial and more accurate.
+ */
+template <typename P, typename T>
+constexpr bool has_approx_sincos =
+    has_approx<T> && ! std::is_same<P, precise>::value && ! (is_fast<P> && std::is_same<T, float>::value);
+
+/**
+ * Tell if rsqrt_estimate uses SSE rsqrtss, relative error below 3.7e-4,
+ * rather than a magic constant, relative error below 3.5e-2.
+ */
+template <typename T>
+constexpr bool has_rsqrtss =
+#if defined(__SSE__) || defined(_M_X64)
+    std::is_same<T, float>::value;
+#else
+    false;
+#endif
+
+template <typename T>
+inline T rsqrt_estimate(T v) {
+#if defined(__SSE__) || defined(_M_X64)
+    if constexpr (has_rsqrtss<T>) {
+        return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(v)));
+    }
+#endif
+
+    using U = std::conditional_t<sizeof(T) == 8, std::uint64_t, std::uint32_t>;
+
+    constexpr U magic = static_cast<U>(sizeof(T) == 8 ? 0x5fe6eb50c7b537a9ULL : 0x5f375a86ULL);
+
+    U i = 0;
+    std::memcpy(&i, &v, sizeof(T));
+    i = magic - (i >> 1);
+
+    T r = 0;
+    std::memcpy(&r, &i, sizeof(T));
+
+    return r;
+}
+
+/**
+ * 1 / sqrt(v), v being positive.
+ */
+template <typename P, typename T>
+inline T approx_rsqrt(T v) {
+    // Each Newton step squares the relative error (times 1.5).
+    constexpr int steps = has_rsqrtss<T> ? (is_fast<P> ? 1 : 0) : (is_fast<P> ? 3 : 1);
+
+    T r = rsqrt_estimate(v);
+
+    for (int i = 0; i < steps; ++ i) {
+        r = r * (T{1.5L} - T{0.5L} * v * r * r);
+    }
+
+    return r;
+}
+
+/**
+ * Sine and cosine of x, reduced to y in [-pi / 4, pi / 4] by the nearest
+ * multiple j of pi / 2. pi / 2 is split in 3 parts, j times the first one
+ * being exact for |j| < 2^16, and j times the second one too for double.
+ * Beyond (|x| above about 1.03e5) or for non finite x, libm takes over.
+ */
+template <typename P, typename T>
+constexpr sin_cos<T> approx_sincos(T x) {
+    // Adding and subtracting 1.5 * 2^(digits - 1) rounds to the nearest integer.
+    constexpr T round_magic = T{1.5L} * (std::uintmax_t{1} << (std::numeric_limits<T>::digits - 1));
+
+    T j = (x * T{0.63661977236758134307553505349005745L} + round_magic) - round_magic;
+
+    // Out of range (or not finite), the reduction would not be exact.
+    if (! (j < T{65536L} && T{-65536L} < j)) {
+        if (is_constant_evaluated()) {
+            return {const_sin(x), const_cos(x)};
+        }
+
+        return {std::sin(x), std::cos(x)};
+    }
+
+    const T y = ((x - j * T{1.5703125L}) - j * T{4.837512969970703125e-4L}) - j * T{7.54978995489188216e-8L};
+    const T z = y * y;
+
+    T s{};
+    T c{};
+
+    if constexpr (is_fast<P>) {
+        s = y + y * z * (T{-0.16666650669315172L} + z * (T{0.0083319786641180057L} + z * T{-0.00019495636340594917L}));
+        c = T{1L} - T{0.5L} * z + z * z * (T{0.041666646866467726L} + z * (T{-0.0013887367517166969L} + z * T{2.4438451737482326e-05L}));
+    } else {
+        s = y + y * z * (T{-0.16662833806056512L} + z * T{0.0081529923262332864L});
+        c = T{1L} - T{0.5L} * z + z * z * T{0.040908443551010636L};
+    }
+
+    // sin(y + q * pi / 2) and cos(y + q * pi / 2).
+    const int q = static_cast<int>(j);
+    const T qs = q & 1 ? c : s;
+    const T qc = q & 1 ? s : c;
+
+    return {q & 2 ? - qs : qs, (q + 1) & 2 ? - qc : qc};
+}
+
+template <typename P, typename T>
+constexpr T approx_atan2(T y, T x) {
+    const T ay = y < T{0L} ? - y : y;
+    const T ax = x < T{0L} ? - x : x;
+
+    // atan of t in [0, 1], mirrored around pi / 4 when steep.
+    const bool steep = ax < ay;
+    const T n = steep ? ax : ay;
+    const T d = steep ? ay : ax;
+    const T t = d == T{0L} ? T{0L} : n / d;
+    const T t2 = t * t;
+
+    T a{};
+
+    if constexpr (is_fast<P>) {
+        a = t * (T{1L} + t2 * (T{-0.3333314528L} + t2 * (T{0.1999355085L} + t2 * (T{-0.1420889944L} +
+            t2 * (T{0.1065626393L} + t2 * (T{-0.0752896400L} + t2 * (T{0.0429096138L} +
+            t2 * (T{-0.0161657367L} + t2 * T{0.0028662257L}))))))));
+    } else {
+        a = t * (T{0.9998660L} + t2 * (T{-0.3302995L} + t2 * (T{0.1801410L} +
+            t2 * (T{-0.0851330L} + t2 * T{0.0208351L}))));
+    }
+
+    a = steep ? static_cast<T>(c_const_pi_2) - a : a;
+    a = x < T{0L} ? static_cast<T>(c_const_pi) - a : a;
+
+    return y < T{0L} ? - a : a;
+}
+
+template <typename P, typename T>
+constexpr T approx_acos(T v) {
+    const T x = v < T{0L} ? - v : v;
+
+    T p{};
+
+    if constexpr (is_fast<P>) {
+        p = T{1.5707963050L} + x * (T{-0.2145988016L} + x * (T{0.0889789874L} + x * (T{-0.0501743046L} +
+            x * (T{0.0308918810L} + x * (T{-0.0170881256L} + x * (T{0.0066700901L} + x * T{-0.0012624911L}))))));
+    } else {
+        p = T{1.5707288L} + x * (T{-0.2121144L} + x * (T{0.0742610L} + x * T{-0.0187293L}));
+    }
+
+    const T a = (is_constant_evaluated() ? const_sqrt(T{1L} - x) : std::sqrt(T{1L} - x)) * p;
+
+    return v < T{0L} ? static_cast<T>(c_const_pi) - a : a;
+}
+
+} // namespace detail
+
+/**
+ * Square root.
+ * Like the functors below, usable in constant expressions (see
+ * detail::const_sqrt and others), libm being used at run time.
+ */
+constexpr struct {
+    template <typename T>
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::sqrt(value);
+        }
+
+        return detail::const_sqrt(value);
+    }
+
+    template <typename T>
+    constexpr eif<std::is_integral<T>::value, double> operator()(T value) const noexcept {
+        return (*this)(static_cast<double>(value));
+    }
+
+    /**
+     * Any precision policy : the square root instruction is as fast as
+     * approximations through rsqrt.
+     */
+    template <typename T, typename P>
+    constexpr eif<std::is_floating_point<T>::value && is_precision<P>, T> operator()(T value, P) const noexcept {
+        return (*this)(value);
+    }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::sqrt_lanes(p);
+    }
+
+    template <typename T, std::size_t N, typename P>
+    eif<is_precision<P>, pack<T, N>> operator()(const pack<T, N>& p, P) const noexcept {
+        return detail::sqrt_lanes(p);
+    }
+} sqrt;
+
+/**
+ * Reciprocal square root, 1 / sqrt(value).
+ */
+constexpr struct {
+    template <typename T>
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        return T{1L} / sqrt(value);
+    }
+
+    template <typename T, typename P>
+    constexpr eif<std::is_floating_point<T>::value && is_precision<P>, T> operator()(T value, P) const noexcept {
+        if constexpr (! std::is_same<P, precise>::value && detail::has_approx<T>) {
+            if (! is_constant_evaluated()) {
+                return detail::approx_rsqrt<P>(value);
+            }
+        }
+
+        return (*this)(value);
+    }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return pack<T, N>{T{1L}} / detail::sqrt_lanes(p);
+    }
+
+    template <typename T, std::size_t N, typename P>
+    eif<is_precision<P>, pack<T, N>> operator()(const pack<T, N>& p, P) const noexcept {
+        if constexpr (! std::is_same<P, precise>::value && detail::has_approx<T>) {
+            return detail::lanewise(detail::approx_rsqrt<P, T>, p);
+        }
+
+        return (*this)(p);
+    }
+} rsqrt;
+
+/**
+ * Sine.
+ */
+constexpr struct {
+    template <typename T>
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::sin(value);
+        }
+
+        return detail::const_sin(value);
+    }
+
+    template <typename T, typename P>
+    constexpr eif<std::is_floating_point<T>::value && is_precision<P>, T> operator()(T value, P) const noexcept {
+        if constexpr (detail::has_approx_sincos<P, T>) {
+            return detail::approx_sincos<P>(value).sin;
+        }
+
+        return (*this)(value);
+    }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
+
+    template <typename T, std::size_t N, typename P>
+    eif<is_precision<P>, pack<T, N>> operator()(const pack<T, N>& p, P) const noexcept {
+        return detail::lanewise([this](T v) { return (*this)(v, P{}); }, p);
+    }
+} sin;
+
+/**
+ * Cosine.
+ */
+constexpr struct {
+    template <typename T>
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::cos(value);
+        }
+
+        return detail::const_cos(value);
+    }
+
+    template <typename T, typename P>
+    constexpr eif<std::is_floating_point<T>::value && is_precision<P>, T> operator()(T value, P) const noexcept {
+        if constexpr (detail::has_approx_sincos<P, T>) {
+            return detail::approx_sincos<P>(value).cos;
+        }
+
+        return (*this)(value);
+    }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
+
+    template <typename T, std::size_t N, typename P>
+    eif<is_precision<P>, pack<T, N>> operator()(const pack<T, N>& p, P) const noexcept {
+        return detail::lanewise([this](T v) { return (*this)(v, P{}); }, p);
+    }
+} cos;
+
+/**
+ * Tangent.
+ */
+constexpr struct {
+    template <typename T>
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::tan(value);
+        }
+
+        return detail::const_tan(value);
+    }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
+} tan;
+
+/**
+ * Arc tangent of y / x, using signs of both to tell the quadrant.
+ */
+constexpr struct {
+    template <typename T>
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T y, T x) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::atan2(y, x);
+        }
+
+        return detail::const_atan2(y, x);
+    }
+
+    template <typename T, typename P>
+    constexpr eif<std::is_floating_point<T>::value && is_precision<P>, T> operator()(T y, T x, P) const noexcept {
+        if constexpr (! std::is_same<P, precise>::value && detail::has_approx<T>) {
+            return detail::approx_atan2<P>(y, x);
+        }
+
+        return (*this)(y, x);
+    }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& y, const pack<T, N>& x) const noexcept {
+        return detail::lanewise(*this, y, x);
+    }
+
+    template <typename T, std::size_t N, typename P>
+    eif<is_precision<P>, pack<T, N>> operator()(const pack<T, N>& y, const pack<T, N>& x, P) const noexcept {
+        return detail::lanewise([this](T vy, T vx) { return (*this)(vy, vx, P{}); }, y, x);
+    }
+} atan2;
+
+/**
+ * Arc cosine.
+ */
+constexpr struct {
+    template <typename T>
+    constexpr eif<std::is_floating_point<T>::value, T> operator()(T value) const noexcept {
+        if (! is_constant_evaluated()) {
+            return std::acos(value);
+        }
+
+        return detail::const_acos(value);
+    }
+
+    template <typename T, typename P>
+    constexpr eif<std::is_floating_point<T>::value && is_precision<P>, T> operator()(T value, P) const noexcept {
+        if constexpr (! std::is_same<P, precise>::value && detail::has_approx<T>) {
+            return detail::approx_acos<P>(value);
+        }
+
+        return (*this)(value);
+    }
+
+    template <typename T, std::size_t N>
+    pack<T, N> operator()(const pack<T, N>& p) const noexcept {
+        return detail::lanewise(*this, p);
+    }
+
+    template <typename T, std::size_t N, typename P>
+    eif<is_precision<P>, pack<T, N>> operator()(const pack<T, N>& p, P) const noexcept {
+        return detail::lanewise([this](T v) { return (*this)(v, P{}); }, p);
+    }
+} acos;
+
+template <typename T, std::size_t D>
+struct vec;
+
+namespace detail {
+
+/**
+ * Componentwise sincos of a vec, defined in vec_functions.hpp.
+ */
+template <typename P, typename T, std::size_t D>
+constexpr sin_cos<vec<T, D>> sincos(const vec<T, D>& v);
+
+} // namespace detail
+
+/**
+ * Sine and cosine, e.g. const auto [s, c] = sincos(angle).
+ * At run time, both libm calls are next to each other so that compilers merge
+ * them into one sincos call, sharing the argument reduction, where the C
+ * library has it (glibc).
+ * With a vec, return sines and cosines of all its components, computed in one
+ * SIMD evaluation when EE_MATH_SIMD is enabled (see simd::sincos).
+ */
+constexpr struct {
+    template <typename T, typename P = precise>
+    constexpr eif<std::is_floating_point<T>::value && is_precision<P>, sin_cos<T>> operator()(T value, P = {}) const noexcept {
+        if constexpr (detail::has_approx_sincos<P, T>) {
+            return detail::approx_sincos<P>(value);
+        }
+
+        return {sin(value), cos(value)};
+    }
+
+    template <typename T, std::size_t D, typename P = precise>
+    constexpr eif<is_precision<P>, sin_cos<vec<T, D>>> operator()(const vec<T, D>& v, P = {}) const noexcept {
+        return detail::sincos<P>(v);
+    }
+
+    template <typename T, std::size_t N, typename P = precise>
+    eif<is_precision<P>, sin_cos<pack<T, N>>> operator()(const pack<T, N>& p, P = {}) const noexcept {
+        sin_cos<pack<T, N>> result{};
+
+        for (std::size_t i = 0; i < N; ++ i) {
+            const sin_cos<T> sc = (*this)(p.v[i], P{});
+
+            result.sin.v[i] = sc.sin;
+            result.cos.v[i] = sc.cos;
+        }
+
+        return result;
+    }
+} sincos;
+
 } // namespace math
 } // namespace ee
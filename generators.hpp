@@ -53,6 +53,7 @@ constexpr auto fill(typename O::value_type v) {
 /**
  * Returns a mat, vec or quat, depending of what O is, with as many values as
  * required from a given pointer.
+ * Values are copied, vec_view and mat_view of view.hpp read them in place.
  */
 namespace detail {
 
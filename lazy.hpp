@@ -0,0 +1,318 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <ee_utils/componentwise.hpp>
+#include <ee_utils/templates.hpp>
+
+#include "common.hpp"
+#include "functions.hpp"
+#include "mat.hpp"
+#include "quat.hpp"
+#include "vec.hpp"
+
+/**
+ * Opt-in lazy evaluation of componentwise expressions.
+ * lazy(x) wraps a mat, vec or quat. Componentwise operators (+, -, opposite,
+ * scalar * and /) with at least one lazy operand then build expression nodes
+ * instead of results, and the whole expression is computed in a single loop
+ * over components when converted to its result type, e.g. :
+ *
+ * mat<double, 4, 4> m = lazy(a) * s + b - c * t;
+ *
+ * Each component goes through the same functors, in the same order, as with
+ * the eager operators, so results are the same, unless the compiler contracts
+ * the fused loop into fma instructions (GCC -ffp-contract=fast, its default).
+ * Nothing changes for expressions without lazy operand.
+ * Nodes refer to their mat, vec or quat operands : evaluate an expression in
+ * the full expression that builds it, never keep one in an auto variable.
+ */
+
+namespace ee {
+namespace math {
+
+using tutil::eif;
+
+template <typename E>
+class lazy_ref;
+
+template <typename E, typename F, typename... Ts>
+class lazy_expr;
+
+/**
+ * A way to identify lazy expressions.
+ */
+namespace detail {
+
+template <typename>
+struct is_lazy_impl : std::false_type {};
+
+template <typename E>
+struct is_lazy_impl<lazy_ref<E>> : std::true_type {};
+
+template <typename E, typename F, typename... Ts>
+struct is_lazy_impl<lazy_expr<E, F, Ts...>> : std::true_type {};
+
+} // namespace detail
+
+template <typename T>
+constexpr bool is_lazy = detail::is_lazy_impl<std::decay_t<T>>::value;
+
+namespace detail {
+
+/**
+ * Component i of a lazy operand, scalars being broadcasted.
+ */
+template <typename T>
+constexpr auto lazy_at(const T& t, std::size_t i) {
+    if constexpr (is_lazy<T>) {
+        return t[i];
+    } else {
+        return t;
+    }
+}
+
+/**
+ * Operand as stored in a node : lazy ones as is, mat, vec and quat by
+ * reference, scalars by value.
+ */
+template <typename T>
+constexpr auto lazy_operand(const T& t) {
+    if constexpr (is_lazy<T> || is_num<T>) {
+        return t;
+    } else {
+        return lazy_ref<T>(t);
+    }
+}
+
+template <typename T>
+using lazy_operand_t = decltype(lazy_operand(std::declval<const T&>()));
+
+/**
+ * Result type of an expression : the mat, vec or quat of its first lazy
+ * operand, with the value type F gives, as ee::cwise does.
+ */
+template <typename F, typename... Ts>
+struct lazy_result;
+
+template <typename F, typename T, typename... Ts>
+struct lazy_result<F, T, Ts...> {
+    using first = std::conditional_t<is_lazy<T>, T, typename lazy_result<F, Ts...>::first>;
+};
+
+template <typename F>
+struct lazy_result<F> {
+    using first = void;
+};
+
+template <typename F, typename... Ts>
+using lazy_result_t = typename ee::but<
+    typename lazy_result<F, Ts...>::first::result_type,
+    std::decay_t<decltype(std::declval<F>()(lazy_at(std::declval<const Ts&>(), 0)...))>>::type;
+
+/**
+ * Type an operand stands for : the result type of lazy ones, the type itself
+ * for mat, vec, quat and scalars.
+ */
+template <typename T, typename = void>
+struct lazy_type {
+    using type = std::decay_t<T>;
+};
+
+template <typename T>
+struct lazy_type<T, eif<is_lazy<T>>> {
+    using type = typename std::decay_t<T>::result_type;
+};
+
+template <typename T>
+using lazy_type_t = typename lazy_type<T>::type;
+
+/**
+ * Whether non-scalar operands all stand for the same type, layout included,
+ * as the eager operators require.
+ */
+template <typename T, typename... Ts>
+constexpr bool lazy_same_type() {
+    if constexpr (is_num<T>) {
+        if constexpr (sizeof...(Ts) == 0) {
+            return true;
+        } else {
+            return lazy_same_type<Ts...>();
+        }
+    } else {
+        return ((is_num<Ts> || std::is_same<lazy_type_t<T>, lazy_type_t<Ts>>::value) && ...);
+    }
+}
+
+template <typename F, typename... Ts>
+constexpr auto make_lazy(F f, const Ts&... ts) {
+    using E = lazy_result_t<F, lazy_operand_t<Ts>...>;
+
+    static_assert(lazy_same_type<Ts...>(), "operands must have the same type");
+
+    return lazy_expr<E, F, lazy_operand_t<Ts>...>(f, lazy_operand(ts)...);
+}
+
+} // namespace detail
+
+/**
+ * Leaf of a lazy expression, referring to a mat, vec or quat.
+ */
+template <typename E>
+class lazy_ref {
+public:
+    using result_type = E;
+
+    constexpr static std::size_t size = E::size;
+
+    constexpr explicit lazy_ref(const E& e) : m_e(&e) {}
+
+    constexpr auto operator[](std::size_t i) const {
+        return m_e->data[i];
+    }
+
+    constexpr E eval() const {
+        return *m_e;
+    }
+
+    constexpr operator E() const {
+        return eval();
+    }
+
+private:
+    const E* m_e;
+};
+
+/**
+ * Node of a lazy expression, functor F applied componentwise to operands Ts.
+ */
+template <typename E, typename F, typename... Ts>
+class lazy_expr {
+public:
+    using result_type = E;
+
+    constexpr static std::size_t size = E::size;
+
+    constexpr lazy_expr(F f, const Ts&... ts) : m_f(f), m_operands(ts...) {}
+
+    constexpr auto operator[](std::size_t i) const {
+        return at(i, std::index_sequence_for<Ts...>());
+    }
+
+    /**
+     * Compute all components in one pass, unrolled.
+     */
+    constexpr E eval() const {
+        return eval(std::make_index_sequence<E::size>());
+    }
+
+    constexpr operator E() const {
+        return eval();
+    }
+
+private:
+    template <std::size_t... Is>
+    constexpr E eval(std::index_sequence<Is...>) const {
+        E result{};
+
+        ((result.data[Is] = (*this)[Is]), ...);
+
+        return result;
+    }
+
+    template <std::size_t... Is>
+    constexpr auto at(std::size_t i, std::index_sequence<Is...>) const {
+        return m_f(detail::lazy_at(std::get<Is>(m_operands), i)...);
+    }
+
+    F m_f;
+    std::tuple<Ts...> m_operands;
+};
+
+/**
+ * Start a lazy expression from a mat, vec or quat.
+ */
+template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
+constexpr auto lazy(const T& t) {
+    return lazy_ref<T>(t);
+}
+
+/**
+ * Evaluate a lazy expression, for when no conversion takes place.
+ */
+template <typename T, typename = eif<is_lazy<T>>>
+constexpr auto eval(const T& t) {
+    return t.eval();
+}
+
+/**
+ * Operators, non-type template parameter constrained so that they are not
+ * redeclarations of the ones in operators.hpp.
+ */
+
+/**
+ * Opposite.
+ */
+template <typename T, eif<is_lazy<T>, int> = 0>
+constexpr auto operator-(const T& rhs) {
+    return detail::make_lazy(opp, rhs);
+}
+
+/**
+ * Addition.
+ * At least one operand lazy, the other one lazy or of its result type, layout
+ * included.
+ */
+template <typename LT, typename RT, eif<(is_lazy<LT> || is_lazy<RT>) && ! is_num<LT> && ! is_num<RT>
+    && std::is_same<detail::lazy_type_t<LT>, detail::lazy_type_t<RT>>::value, int> = 0>
+constexpr auto operator+(const LT& lhs, const RT& rhs) {
+    return detail::make_lazy(add, lhs, rhs);
+}
+
+/**
+ * Subtraction.
+ * At least one operand lazy, the other one lazy or of its result type, layout
+ * included.
+ */
+template <typename LT, typename RT, eif<(is_lazy<LT> || is_lazy<RT>) && ! is_num<LT> && ! is_num<RT>
+    && std::is_same<detail::lazy_type_t<LT>, detail::lazy_type_t<RT>>::value, int> = 0>
+constexpr auto operator-(const LT& lhs, const RT& rhs) {
+    return detail::make_lazy(sub, lhs, rhs);
+}
+
+/**
+ * Scalar multiplication.
+ */
+template <typename LT, typename RT, eif<is_lazy<LT> && is_num<RT>, int> = 0>
+constexpr auto operator*(const LT& lhs, RT rhs) {
+    return detail::make_lazy(mul, lhs, rhs);
+}
+
+/**
+ * Scalar multiplication.
+ */
+template <typename LT, typename RT, eif<is_num<LT> && is_lazy<RT>, int> = 0>
+constexpr auto operator*(LT lhs, const RT& rhs) {
+    return detail::make_lazy(mul, lhs, rhs);
+}
+
+/**
+ * Scalar division.
+ */
+template <typename LT, typename RT, eif<is_lazy<LT> && is_num<RT>, int> = 0>
+constexpr auto operator/(const LT& lhs, RT rhs) {
+    return detail::make_lazy(div, lhs, rhs);
+}
+
+} // namespace math
+} // namespace ee
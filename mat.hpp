@@ -9,14 +9,14 @@
 
 #include <cstddef>
 #include <iostream>
+#include <type_traits>
 #include <typeinfo>
 
 #include <ee_utils/componentwise.hpp>
 
+#include "common.hpp"
 #include "vec.hpp"
 
-#define EE_MATRIX_COLUMN_MAJOR 1
-
 namespace ee {
 namespace math {
 
@@ -36,54 +36,73 @@ namespace math {
  * r [  0  1  2  3 |  0  1  2  3 |  0  1  2  3 |  0  1  2  3 ]
  * c [  0          |  1          |  2          |  3          ]
  *
+ * Layout is the last template parameter of mat, column-major by default.
+ * A row-major matrix has the data of the column-major transpose, which
+ * as_transpose gives without moving any component.
+ */
+struct column_major {};
+struct row_major {};
+
+template <typename L>
+constexpr bool is_layout = std::is_same<L, column_major>::value || std::is_same<L, row_major>::value;
+
+/**
+ * The other layout.
  */
+template <typename L>
+using transposed_layout = std::conditional_t<std::is_same<L, row_major>::value, column_major, row_major>;
 
+template <typename L = column_major>
 inline constexpr auto mat_rc_to_i(const vec<std::size_t, 2>& coords,
                                   const vec<std::size_t, 2>& size) {
-#if EE_MATRIX_COLUMN_MAJOR
-    return coords(0) + size(0) * coords(1);
-#else
-    return coords(0) * size(1) + coords(1);
-#endif
+    if constexpr (std::is_same<L, column_major>::value) {
+        return coords(0) + size(0) * coords(1);
+    }
+    else {
+        return coords(0) * size(1) + coords(1);
+    }
 }
 
+template <typename L = column_major>
 inline constexpr auto mat_i_to_r(
     std::size_t i, const vec<std::size_t, 2>& size) {
-#if EE_MATRIX_COLUMN_MAJOR
-    return i % size(0);
-#else
-    return i / size(1);
-#endif
+    if constexpr (std::is_same<L, column_major>::value) {
+        return i % size(0);
+    }
+    else {
+        return i / size(1);
+    }
 }
 
+template <typename L = column_major>
 inline constexpr auto mat_i_to_c(
     std::size_t i, const vec<std::size_t, 2>& size) {
-#if EE_MATRIX_COLUMN_MAJOR
-    return i / size(0);
-#else
-    return i % size(1);
-#endif
+    if constexpr (std::is_same<L, column_major>::value) {
+        return i / size(0);
+    }
+    else {
+        return i % size(1);
+    }
 }
 
+template <typename L = column_major>
 inline constexpr auto mat_i_to_rc(
     std::size_t i, const vec<std::size_t, 2>& size) {
-#if EE_MATRIX_COLUMN_MAJOR
-    return vec<std::size_t, 2>{i % size(0), i / size(0)};
-#else
-    return vec<std::size_t, 2>{i / size(1), i % size(1)};
-#endif
+    return vec<std::size_t, 2>{mat_i_to_r<L>(i, size), mat_i_to_c<L>(i, size)};
 }
 
 /**
- * Generic matrix template.
+ * Generic matrix template, data stored in layout L.
  */
-template <typename T, std::size_t R, std::size_t C>
+template <typename T, std::size_t R, std::size_t C, typename L = column_major>
 struct mat {
-    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(is_num<T>, "T must be arithmetic type or pack");
     static_assert(R > 0, "R must be at least 1");
     static_assert(C > 0, "C must be at least 1");
+    static_assert(is_layout<L>, "L must be column_major or row_major");
 
     using value_type      = T;
+    using layout          = L;
     using reference       = value_type&;
     using const_reference = const value_type&;
     using pointer         = value_type*;
@@ -96,11 +115,11 @@ struct mat {
     T data[size];
 
     inline constexpr reference operator()(std::size_t r, std::size_t c) {
-        return data[mat_rc_to_i({r, c}, {R, C})];
+        return data[mat_rc_to_i<L>({r, c}, {R, C})];
     }
 
     inline constexpr const_reference operator()(std::size_t r, std::size_t c) const {
-        return data[mat_rc_to_i({r, c}, {R, C})];
+        return data[mat_rc_to_i<L>({r, c}, {R, C})];
     }
 
     inline constexpr reference operator[](std::size_t index) {
@@ -130,8 +149,8 @@ namespace detail {
 template <typename>
 struct is_mat_impl : std::false_type {};
 
-template <typename T, std::size_t R, std::size_t C>
-struct is_mat_impl<mat<T, R, C>> : std::true_type {};
+template <typename T, std::size_t R, std::size_t C, typename L>
+struct is_mat_impl<mat<T, R, C, L>> : std::true_type {};
 
 } // namespace detail
 
@@ -141,10 +160,10 @@ constexpr bool is_mat = detail::is_mat_impl<std::decay_t<T>>::value;
 /**
  * Output formatting
  */
-template <typename T, std::size_t R, std::size_t C>
-std::ostream& operator<<(std::ostream& output, const mat<T, R, C>& m) {
+template <typename T, std::size_t R, std::size_t C, typename L>
+std::ostream& operator<<(std::ostream& output, const mat<T, R, C, L>& m) {
     output << "mat<" << typeid(T).name() << ", " <<
-        R << ", " << C << "> {" << std::endl;
+        R << ", " << C << (std::is_same<L, row_major>::value ? ", row_major" : "") << "> {" << std::endl;
 
     for (std::size_t r = 0; r < R; ++ r) {
         output << "   ";
@@ -163,16 +182,16 @@ std::ostream& operator<<(std::ostream& output, const mat<T, R, C>& m) {
 
 } // namespace math
 
-template <typename VT, typename T, std::size_t R, std::size_t C>
-struct but<math::mat<T, R, C>, VT> {
-    using type = math::mat<VT, R, C>;
+template <typename VT, typename T, std::size_t R, std::size_t C, typename L>
+struct but<math::mat<T, R, C, L>, VT> {
+    using type = math::mat<VT, R, C, L>;
 };
 
 } // namespace ee
 
 namespace std {
 
-template <typename T, size_t R, size_t C>
-class tuple_size<::ee::math::mat<T, R, C>> : public integral_constant<size_t, R * C> {};
+template <typename T, size_t R, size_t C, typename L>
+class tuple_size<::ee::math::mat<T, R, C, L>> : public integral_constant<size_t, R * C> {};
 
 } // namespace std
@@ -0,0 +1,477 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "dispatch.hpp"
+#include "mat.hpp"
+#include "mat_functions.hpp"
+#include "pack.hpp"
+#include "simd.hpp"
+#include "vec.hpp"
+
+/**
+ * Bulk linear_map, affine_map and projective_map, transforming n points with
+ * the same matrix.
+ * Points are given either as arrays of vec or as strided buffers (e.g. the
+ * position member of interleaved vertices), strides being in bytes. out may be
+ * in, with the same stride, for in-place transformation; other overlaps are
+ * not supported.
+ * Matrix rows are copied once and stay in registers. With EE_MATH_DISPATCH,
+ * packed vec<float, 3> and vec<double, 3> are transformed a register width at
+ * a time, as x, y and z packs (see dispatch.hpp). Otherwise with EE_MATH_SSE,
+ * packed vec<float, 3> are transformed 4 (8 with AVX) at a time, as x, y and z
+ * registers.
+ *
+ * Bulk multiply and inv of mat4x4, through dispatch.hpp kernels for float and
+ * double.
+ */
+
+namespace ee {
+namespace math {
+
+namespace detail {
+
+/**
+ * Rows 0 to RO - 1 of lhs in row order, RO x (DI + 1).
+ */
+template <std::size_t RO, std::size_t DI, typename T, std::size_t R, std::size_t C, typename L>
+void rows_of(const mat<T, R, C, L>& lhs, T (*m)[DI + 1]) {
+    for (std::size_t r = 0; r < RO; ++ r) {
+        for (std::size_t c = 0; c <= DI; ++ c) {
+            m[r][c] = c < C ? lhs(r, c) : T{0L};
+        }
+    }
+}
+
+template <typename T>
+inline const T* stride_at(const T* p, std::size_t stride, std::size_t i) {
+    return reinterpret_cast<const T*>(reinterpret_cast<const char*>(p) + i * stride);
+}
+
+template <typename T>
+inline T* stride_at(T* p, std::size_t stride, std::size_t i) {
+    return reinterpret_cast<T*>(reinterpret_cast<char*>(p) + i * stride);
+}
+
+enum class map_kind {linear, affine, projective};
+
+/**
+ * One row of the matrix applied to point x, in affine_map_to operation order.
+ */
+template <bool A, typename T, std::size_t N, std::size_t... Ds>
+inline T map_row(const T (&m)[N], const T* x, std::index_sequence<Ds...>) {
+    if constexpr (A) {
+        return (... + (m[Ds] * x[Ds])) + m[sizeof...(Ds)];
+    } else {
+        return (... + (m[Ds] * x[Ds]));
+    }
+}
+
+template <map_kind K, std::size_t D, typename T, std::size_t... Rs>
+inline void map_point(const T (&m)[sizeof...(Rs)][D + 1], const T* in, T* out,
+    std::index_sequence<Rs...>) {
+    constexpr bool affine = K != map_kind::linear;
+
+    // Read before written, for in-place.
+    T x[D];
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        x[d] = in[d];
+    }
+
+    T r[] = {map_row<affine>(m[Rs], x, std::make_index_sequence<D>())...};
+
+    if constexpr (K == map_kind::projective) {
+        const T w = T{1L} / r[D];
+
+        for (std::size_t d = 0; d < D; ++ d) {
+            r[d] *= w;
+        }
+    }
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        out[d] = r[d];
+    }
+}
+
+#if EE_MATH_SSE
+/**
+ * One matrix row applied to sizeof(V) / sizeof(float) points at once, matrix
+ * coefficients broadcasted.
+ */
+template <bool A, typename V, std::size_t N, std::size_t... Ds>
+inline V map_lanes(const V (&m)[N], const V* x, std::index_sequence<Ds...>) {
+    V r = A ? m[sizeof...(Ds)] : V{};
+
+    ((r = simd::detail::madd(m[Ds], x[Ds], r)), ...);
+
+    return r;
+}
+
+inline __m128 broadcast(__m128, float s) {
+    return _mm_set1_ps(s);
+}
+
+inline __m128 reciprocal(__m128 r) {
+    return _mm_div_ps(_mm_set1_ps(1.0f), r);
+}
+
+inline __m128 scale(__m128 r, __m128 s) {
+    return _mm_mul_ps(r, s);
+}
+
+#if defined(__AVX__)
+inline __m256 broadcast(__m256, float s) {
+    return _mm256_set1_ps(s);
+}
+
+inline __m256 reciprocal(__m256 r) {
+    return _mm256_div_ps(_mm256_set1_ps(1.0f), r);
+}
+
+inline __m256 scale(__m256 r, __m256 s) {
+    return _mm256_mul_ps(r, s);
+}
+#endif
+
+/**
+ * Packed vec<float, 3>, sizeof(V) / sizeof(float) points per iteration
+ * through deinterleave3 and interleave3. Returns the number of points done.
+ */
+template <typename V, map_kind K, std::size_t... Rs>
+std::size_t map_packed3(const float (&m)[sizeof...(Rs)][4], const float* in, float* out,
+    std::size_t n, std::index_sequence<Rs...>) {
+    constexpr std::size_t rows = sizeof...(Rs);
+    constexpr std::size_t w = sizeof(V) / sizeof(float);
+    constexpr bool affine = K != map_kind::linear;
+
+    V mr[rows][4];
+
+    for (std::size_t r = 0; r < rows; ++ r) {
+        for (std::size_t c = 0; c < 4; ++ c) {
+            mr[r][c] = broadcast(V{}, m[r][c]);
+        }
+    }
+
+    std::size_t i = 0;
+
+    for (; i + w <= n; i += w) {
+        V x[3];
+
+        simd::detail::deinterleave3(in + 3 * i, &x[0], &x[1], &x[2]);
+
+        V r[] = {map_lanes<affine>(mr[Rs], x, std::make_index_sequence<3>())...};
+
+        if constexpr (K == map_kind::projective) {
+            const V s = reciprocal(r[3]);
+
+            for (std::size_t d = 0; d < 3; ++ d) {
+                r[d] = scale(r[d], s);
+            }
+        }
+
+        simd::detail::interleave3(r[0], r[1], r[2], out + 3 * i);
+    }
+
+    return i;
+}
+#endif
+
+/**
+ * Packed vec<T, 3>, W points per iteration as x, y and z packs. Returns the
+ * number of points done.
+ */
+template <std::size_t W, map_kind K, typename T, std::size_t... Rs>
+std::size_t map_wide(const T (&m)[sizeof...(Rs)][4], const T* in, T* out, std::size_t n,
+    std::index_sequence<Rs...>) {
+    if constexpr (W == 1) {
+        return 0;
+    }
+    else {
+        using P = pack<T, W>;
+
+        constexpr std::size_t rows = sizeof...(Rs);
+        constexpr bool affine = K != map_kind::linear;
+
+        P mr[rows][4];
+
+        for (std::size_t r = 0; r < rows; ++ r) {
+            for (std::size_t c = 0; c < 4; ++ c) {
+                mr[r][c] = P{m[r][c]};
+            }
+        }
+
+        const vec<T, 3>* vin = reinterpret_cast<const vec<T, 3>*>(in);
+        vec<T, 3>* vout = reinterpret_cast<vec<T, 3>*>(out);
+
+        std::size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const vec<P, 3> x = gather<W>(vin + i);
+
+            P r[] = {map_row<affine>(mr[Rs], x.data, std::make_index_sequence<3>())...};
+
+            if constexpr (K == map_kind::projective) {
+                const P s = P{T{1L}} / r[3];
+
+                for (std::size_t d = 0; d < 3; ++ d) {
+                    r[d] *= s;
+                }
+            }
+
+            scatter(vec<P, 3>{r[0], r[1], r[2]}, vout + i);
+        }
+
+        return i;
+    }
+}
+
+template <map_kind K, std::size_t D, typename T, std::size_t R, std::size_t C, typename L>
+void map_points(const mat<T, R, C, L>& lhs, const T* in, std::size_t in_stride,
+    T* out, std::size_t out_stride, std::size_t n) {
+    constexpr std::size_t rows = K == map_kind::projective ? D + 1 : D;
+
+    T m[rows][D + 1];
+
+    rows_of<rows, D>(lhs, m);
+
+    std::size_t i = 0;
+
+#if EE_MATH_DISPATCH
+    if constexpr ((std::is_same<T, float>::value || std::is_same<T, double>::value) && D == 3) {
+        if (in_stride == sizeof(vec<T, 3>) && out_stride == sizeof(vec<T, 3>)) {
+            i = dispatch([&](auto tier) {
+                return map_wide<c_tier_lanes<decltype(tier)::value, T>, K>(m, in, out, n,
+                    std::make_index_sequence<rows>());
+            });
+        }
+    }
+#elif EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value && D == 3) {
+        if (in_stride == sizeof(vec<T, 3>) && out_stride == sizeof(vec<T, 3>)) {
+#if defined(__AVX__)
+            i = map_packed3<__m256, K>(m, in, out, n, std::make_index_sequence<rows>());
+#endif
+            i += map_packed3<__m128, K>(m, in + 3 * i, out + 3 * i, n - i,
+                std::make_index_sequence<rows>());
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        map_point<K, D>(m, stride_at(in, in_stride, i), stride_at(out, out_stride, i),
+            std::make_index_sequence<rows>());
+    }
+}
+
+/**
+ * 4x4 product of row-major storages, as rows of out = rows of q times p, rows
+ * of p staying in registers. out may be p or q.
+ */
+template <typename T>
+inline void mul4_rows(const T* p, const T* q, T* out) {
+    using P = pack<T, 4>;
+
+    const P p0 = P::load(p);
+    const P p1 = P::load(p + 4);
+    const P p2 = P::load(p + 8);
+    const P p3 = P::load(p + 12);
+
+    for (std::size_t r = 0; r < 4; ++ r) {
+        const T* qr = q + 4 * r;
+
+        (p0 * P{qr[0]} + p1 * P{qr[1]} + p2 * P{qr[2]} + p3 * P{qr[3]}).store(out + 4 * r);
+    }
+}
+
+/**
+ * Widest tier inv_wide gains from : in 8 or 16 lanes, float matrices are
+ * slower than in 4 (bench/dispatch.cpp, 51 and 62 M/s against 89 at sse4.2),
+ * and double ones in 4 than in 2 (60 against 70), gathers and scatters
+ * outweighing the wider arithmetic. Capped, avx2 and avx512 builds still gain
+ * from their encoding (118 and 84 M/s).
+ */
+constexpr simd_tier c_inv_max_tier = simd_tier::sse4_2;
+
+/**
+ * W matrices per iteration as mat<pack<T, W>, 4, 4>, singular ones giving zero
+ * matrices. Returns the number of matrices done.
+ */
+template <std::size_t W, typename T, typename L>
+std::size_t inv_wide(const mat<T, 4, 4, L>* in, mat<T, 4, 4, L>* out, std::size_t n) {
+    if constexpr (W == 1) {
+        return 0;
+    }
+    else {
+        using P = pack<T, W>;
+
+        std::size_t i = 0;
+
+        for (; i + W <= n; i += W) {
+            const mat<P, 4, 4, L> M = gather<W>(in + i);
+
+            P s[6];
+            P c[6];
+
+            const P d = inv_minors(M, s, c);
+
+            mat<P, 4, 4, L> R;
+
+            inv_from_minors(M, s, c, P{T{1L}} / d, &R);
+
+            for (P& r : R.data) {
+                r.v = d.v == T{0L} ? T{0L} : r.v;
+            }
+
+            scatter(R, out + i);
+        }
+
+        return i;
+    }
+}
+
+} // namespace detail
+
+/**
+ * Write lhs[i] * rhs[i] into out[i] for the n matrix pairs. out may be lhs or
+ * rhs.
+ */
+template <typename T, std::size_t R, std::size_t N, std::size_t C, typename L>
+void multiply(const mat<T, R, N, L>* lhs, const mat<T, N, C, L>* rhs, mat<T, R, C, L>* out, std::size_t n) {
+    if constexpr ((std::is_same<T, float>::value || std::is_same<T, double>::value) &&
+        R == 4 && N == 4 && C == 4) {
+        detail::dispatch([&](auto tier) {
+            if constexpr (decltype(tier)::value == simd_tier::scalar) {
+                for (std::size_t i = 0; i < n; ++ i) {
+                    out[i] = lhs[i] * rhs[i];
+                }
+            }
+            else {
+                for (std::size_t i = 0; i < n; ++ i) {
+                    if constexpr (std::is_same<L, column_major>::value) {
+                        detail::mul4_rows(lhs[i].data, rhs[i].data, out[i].data);
+                    }
+                    else {
+                        detail::mul4_rows(rhs[i].data, lhs[i].data, out[i].data);
+                    }
+                }
+            }
+        });
+    }
+    else {
+        for (std::size_t i = 0; i < n; ++ i) {
+            out[i] = lhs[i] * rhs[i];
+        }
+    }
+}
+
+/**
+ * Write inverse of each of the n matrices of in into out, which may be in.
+ * Same as inv for each of them, singular mat4x4 giving zero matrices.
+ */
+template <typename T, std::size_t D, typename L>
+void inv(const mat<T, D, D, L>* in, mat<T, D, D, L>* out, std::size_t n) {
+    std::size_t i = 0;
+
+    if constexpr ((std::is_same<T, float>::value || std::is_same<T, double>::value) && D == 4) {
+        i = detail::dispatch([&](auto tier) {
+            constexpr simd_tier K = detail::c_capped_tier<decltype(tier)::value, detail::c_inv_max_tier>;
+
+            return detail::inv_wide<c_tier_lanes<K, T>>(in, out, n);
+        });
+    }
+
+    for (; i < n; ++ i) {
+        out[i] = inv(in[i]);
+    }
+}
+
+/**
+ * Transform n vectors by the linear part of lhs.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void linear_map(const mat<T, R, C, L>& lhs, const vec<T, D>* in, vec<T, D>* out, std::size_t n) {
+    static_assert(D <= R && D <= C, "matrix must be at least DxD");
+
+    detail::map_points<detail::map_kind::linear, D>(lhs,
+        reinterpret_cast<const T*>(in), sizeof(vec<T, D>),
+        reinterpret_cast<T*>(out), sizeof(vec<T, D>), n);
+}
+
+/**
+ * Transform n vectors of D components by the linear part of lhs, reading and
+ * writing with the given byte strides.
+ */
+template <std::size_t D, typename T, std::size_t R, std::size_t C, typename L>
+void linear_map(const mat<T, R, C, L>& lhs, const T* in, std::size_t in_stride,
+    T* out, std::size_t out_stride, std::size_t n) {
+    static_assert(D <= R && D <= C, "matrix must be at least DxD");
+
+    detail::map_points<detail::map_kind::linear, D>(lhs, in, in_stride, out, out_stride, n);
+}
+
+/**
+ * Transform n points by the affine transformation lhs.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void affine_map(const mat<T, R, C, L>& lhs, const vec<T, D>* in, vec<T, D>* out, std::size_t n) {
+    static_assert(D <= R, "matrix row count must be greater or equal to vector dimension");
+    static_assert(D < C, "matrix column count must be greater than vector dimension");
+
+    detail::map_points<detail::map_kind::affine, D>(lhs,
+        reinterpret_cast<const T*>(in), sizeof(vec<T, D>),
+        reinterpret_cast<T*>(out), sizeof(vec<T, D>), n);
+}
+
+/**
+ * Transform n points of D components by the affine transformation lhs,
+ * reading and writing with the given byte strides.
+ */
+template <std::size_t D, typename T, std::size_t R, std::size_t C, typename L>
+void affine_map(const mat<T, R, C, L>& lhs, const T* in, std::size_t in_stride,
+    T* out, std::size_t out_stride, std::size_t n) {
+    static_assert(D <= R, "matrix row count must be greater or equal to vector dimension");
+    static_assert(D < C, "matrix column count must be greater than vector dimension");
+
+    detail::map_points<detail::map_kind::affine, D>(lhs, in, in_stride, out, out_stride, n);
+}
+
+/**
+ * Transform n points by the projective transformation lhs, with one
+ * reciprocal per point for the perspective division.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void projective_map(const mat<T, R, C, L>& lhs, const vec<T, D>* in, vec<T, D>* out, std::size_t n) {
+    static_assert(D < R, "matrix row count must be greater than vector dimension");
+    static_assert(D < C, "matrix column count must be greater than vector dimension");
+
+    detail::map_points<detail::map_kind::projective, D>(lhs,
+        reinterpret_cast<const T*>(in), sizeof(vec<T, D>),
+        reinterpret_cast<T*>(out), sizeof(vec<T, D>), n);
+}
+
+/**
+ * Transform n points of D components by the projective transformation lhs,
+ * reading and writing with the given byte strides, with one reciprocal per
+ * point for the perspective division.
+ */
+template <std::size_t D, typename T, std::size_t R, std::size_t C, typename L>
+void projective_map(const mat<T, R, C, L>& lhs, const T* in, std::size_t in_stride,
+    T* out, std::size_t out_stride, std::size_t n) {
+    static_assert(D < R, "matrix row count must be greater than vector dimension");
+    static_assert(D < C, "matrix column count must be greater than vector dimension");
+
+    detail::map_points<detail::map_kind::projective, D>(lhs, in, in_stride, out, out_stride, n);
+}
+
+} // namespace math
+} // namespace ee
@@ -8,37 +8,94 @@
 #pragma once
 
 #include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 #include "basis.hpp"
+#include "common.hpp"
 #include "mat.hpp"
+#include "simd.hpp"
 #include "vec_functions.hpp"
 
 namespace ee {
 namespace math {
 
+namespace detail {
+
+/**
+ * Transpose of any R x C matrix read through operator(), mat or view.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, typename M, std::size_t... Is>
+constexpr auto transpose(const M& m, std::index_sequence<Is...>) {
+    return mat<T, C, R, L>{
+        m(mat_i_to_c<L>(Is, {C, R}), mat_i_to_r<L>(Is, {C, R}))...
+    };
+}
+
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t... Is>
+constexpr auto as_transpose(const mat<T, R, C, L>& M, std::index_sequence<Is...>) {
+    return mat<T, C, R, transposed_layout<L>>{M.data[Is]...};
+}
+
+} // namespace detail
+
+/**
+ * Return the transpose of a matrix, in the same layout.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto transpose(const mat<T, R, C, L>& M) {
+    return detail::transpose<T, R, C, L>(M, std::make_index_sequence<R * C>());
+}
+
+/**
+ * Return the transpose of a matrix in the other layout, which data is the one
+ * of M : no component moves, e.g. a row-major matrix from a physics library
+ * read as the column-major transpose. Once inlined, it costs nothing.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto as_transpose(const mat<T, R, C, L>& M) {
+    return detail::as_transpose(M, std::make_index_sequence<R * C>());
+}
+
+/**
+ * Return M stored in layout LO, components moved if LO is not its layout.
+ */
+template <typename LO, typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto to_layout(const mat<T, R, C, L>& M) {
+    if constexpr (std::is_same<LO, L>::value) {
+        return M;
+    }
+    else {
+        return as_transpose(transpose(M));
+    }
+}
+
 /**
  * Standard perspective projection.
+ * Like every projection, viewport and view builder, it returns a column-major
+ * matrix unless row_major{} is passed as last argument.
  */
-template <typename T>
-constexpr mat<T, 4, 4> perspective(T fovy, T aspect, T near, T far) {
-    const T d = T{1L} / std::tan(fovy * T{0.5L});
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> perspective(T fovy, T aspect, T near, T far, L = {}) {
+    const T d = T{1L} / tan(fovy * T{0.5L});
 
 #if 1
     // OpenGL
     const T near_m_far = near - far;
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         d / aspect, T{0L},             T{0L}              ,   T{0L},
           T{0L}   ,   d  ,             T{0L}              ,   T{0L},
           T{0L}   , T{0L},    (near + far) / near_m_far   , - T{1L},
-          T{0L}   , T{0L}, T{2L} * near * far / near_m_far,   T{0L}};
+          T{0L}   , T{0L}, T{2L} * near * far / near_m_far,   T{0L}});
 #else
     // DirectX
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         d / aspect, T{0L},       T{0L}       ,          T{0L}           ,
           T{0L}   ,   d  ,       T{0L}       ,          T{0L}           ,
           T{0L}   , T{0L}, far / (far - near), near * far / (near - far),
-          T{0L}   , T{0L},       T{1L}       ,          T{0L}           };
+          T{0L}   , T{0L},       T{1L}       ,          T{0L}           });
 #endif
 }
 
@@ -47,28 +104,28 @@ constexpr mat<T, 4, 4> perspective(T fovy, T aspect, T near, T far) {
  * To avoid computing inverse.
  * Found empirically.
  */
-template <typename T>
-constexpr mat<T, 4, 4> perspective_inverse(T fovy, T aspect, T near, T far) {
-    const T rcp_d = std::tan(fovy * T{0.5L});
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> perspective_inverse(T fovy, T aspect, T near, T far, L = {}) {
+    const T rcp_d = tan(fovy * T{0.5L});
 
 #if 1
     // OpenGL
     const T _2nf = T{2L} * near * far;
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         aspect * rcp_d, T{0L},   T{0L},        T{0L}       ,
             T{0L}     , rcp_d,   T{0L},        T{0L}       ,
             T{0L}     , T{0L},   T{0L}, (near - far) / _2nf,
-            T{0L}     , T{0L}, - T{1L}, (near + far) / _2nf};
+            T{0L}     , T{0L}, - T{1L}, (near + far) / _2nf});
 #else
     // DirectX
     const T nf    = near * far;
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         aspect * rcp_d, T{0L},        T{0L}     ,   T{0L} ,
             T{0L}     , rcp_d,        T{0L}     ,   T{0L} ,
             T{0L}     , T{0L},        T{0L}     ,   T{1L} ,
-            T{0L}     , T{0L}, (near - far) / nf, far / nf};
+            T{0L}     , T{0L}, (near - far) / nf, far / nf});
 #endif
 }
 
@@ -77,198 +134,383 @@ constexpr mat<T, 4, 4> perspective_inverse(T fovy, T aspect, T near, T far) {
  * To avoid computing inverse.
  * Found empirically.
  */
-template <typename T>
-constexpr mat<T, 4, 4> perspective_inverse(const mat<T, 4, 4>& H_V) {
+template <typename T, typename L>
+constexpr mat<T, 4, 4, L> perspective_inverse(const mat<T, 4, 4, L>& H_V) {
 #if 1
     // OpenGL
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         T{1L} / H_V(0, 0),      T{0L}      ,   T{0L},        T{0L}         ,
               T{0L}      , T{1} / H_V(1, 1),   T{0L},        T{0L}         ,
               T{0L}      ,      T{0L}      ,   T{0L},   T{1L} / H_V(2, 3)  ,
-              T{0L}      ,      T{0L}      , - T{1L}, H_V(2, 2) / H_V(2, 3)};
+              T{0L}      ,      T{0L}      , - T{1L}, H_V(2, 2) / H_V(2, 3)});
 #else
     // DirectX
     const T nf    = near * far;
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         T{1L} / H_V(0, 0),      T{0L}      ,        T{0L}     ,         T{0L}        ,
               T{0L}      , T{1} / H_V(1, 1),        T{0L}     ,         T{0L}        ,
               T{0L}      ,      T{0L}      ,        T{0L}     ,         T{1L}        ,
-              T{0L}      ,      T{0L}      , T{1L} / H_V(3, 2), H_V(2, 2) / H_V(3, 2)};
+              T{0L}      ,      T{0L}      , T{1L} / H_V(3, 2), H_V(2, 2) / H_V(3, 2)});
 #endif
 }
 
 /**
  * Oblique perspective projection.
  */
-template <typename T>
-constexpr mat<T, 4, 4> perspective(T right, T left, T top, T bottom, T near, T far) {
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> perspective(T right, T left, T top, T bottom, T near, T far, L = {}) {
     const T _2near       = T{2L} * near;
     const T right_m_left = right - left;
     const T top_m_bottom = top - bottom;
     const T near_m_far   = near - far;
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
             _2near / right_m_left    ,              T{0L}           ,            T{0L}         ,   T{0L},
                     T{0L}            ,     _2near / top_m_bottom    ,            T{0L}         ,   T{0L},
         (right + left) / right_m_left, (top + bottom) / top_m_bottom, (near + far) / near_m_far, - T{1L},
-                    T{0L}            ,              T{0L}           , _2near * far / near_m_far,   T{0L}};
+                    T{0L}            ,              T{0L}           , _2near * far / near_m_far,   T{0L}});
 }
 
 /**
  * Infinite perspective projection.
  * http://chaosinmotion.com/blog/?p=555
  */
-template <typename T>
-constexpr mat<T, 4, 4> perspective(T fovy, T aspect, T near) {
-    const T d = T{1L} / std::tan(fovy * T{0.5L});
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> perspective(T fovy, T aspect, T near, L = {}) {
+    const T d = T{1L} / tan(fovy * T{0.5L});
 
 #if 1
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         d / aspect, T{0L},      T{0L}    ,   T{0L},
           T{0L}   ,   d  ,      T{0L}    ,   T{0L},
           T{0L}   , T{0L},    - T{1L}    , - T{1L},
-          T{0L}   , T{0L}, - T{2L} * near,   T{0L}};
+          T{0L}   , T{0L}, - T{2L} * near,   T{0L}});
 #else
     // TODO test !
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         d / aspect, T{0L},   T{0L},   T{0L},
           T{0L}   ,   d  ,   T{0L},   T{0L},
           T{0L}   , T{0L},   T{0L}, - T{1L},
-          T{0L}   , T{0L}, - near ,   T{0L}};
+          T{0L}   , T{0L}, - near ,   T{0L}});
 #endif
 }
 
 /**
  * Orthographic projection.
  */
-template <typename T>
-constexpr mat<T, 4, 4> orthographic(T left, T right, T bottom, T top, T near, T far) {
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> orthographic(T left, T right, T bottom, T top, T near, T far, L = {}) {
     const T near_m_far = near - far;
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
              T{2L} / (right - left)    ,               T{0L}            ,           T{0L}          , T{0L},
                      T{0L}             ,       T{2L} / (top - bottom)   ,           T{0L}          , T{0L},
                      T{0L}             ,               T{0L}            ,    T{2L} / near_m_far    , T{0L},
-        (left + right) / (left - right), (bottom + top) / (bottom - top), (near + far) / near_m_far, T{1L}};
+        (left + right) / (left - right), (bottom + top) / (bottom - top), (near + far) / near_m_far, T{1L}});
 }
 
-template <typename T>
-constexpr mat<T, 4, 4> orthographic(T width, T height, T near, T far) {
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> orthographic(T width, T height, T near, T far, L = {}) {
     const T near_m_far = near - far;
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         T{2L} / width,      T{0L}    ,           T{0L}          , T{0L},
              T{0L}   , T{2L} / height,           T{0L}          , T{0L},
              T{0L}   ,      T{0L}    ,    T{2L} / near_m_far    , T{0L},
-             T{0L}   ,      T{0L}    , (near + far) / near_m_far, T{1L}};
+             T{0L}   ,      T{0L}    , (near + far) / near_m_far, T{1L}});
 }
 
-template <typename T>
-constexpr mat<T, 4, 4> orthographic(T width, T height, T depth) {
-    return {
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> orthographic(T width, T height, T depth, L = {}) {
+    return to_layout<L>(mat<T, 4, 4>{
         T{2L} / width,      T{0L}    ,      T{0L}   , T{0L},
              T{0L}   , T{2L} / height,      T{0L}   , T{0L},
              T{0L}   ,      T{0L}    , T{2L} / depth, T{0L},
-             T{0L}   ,      T{0L}    ,      T{0L}   , T{1L}};
+             T{0L}   ,      T{0L}    ,      T{0L}   , T{1L}});
 }
 
 /**
  * Inverse of orthographic projection.
  * To avoid computing inverse.
  */
-template <typename T>
-constexpr mat<T, 4, 4> orthographic_inverse(T left, T right, T bottom, T top, T near, T far) {
-    return {
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> orthographic_inverse(T left, T right, T bottom, T top, T near, T far, L = {}) {
+    return to_layout<L>(mat<T, 4, 4>{
         (right - left) * T{0.5L},          T{0L}          ,          T{0L}          , T{0L},
                  T{0L}          , (top - bottom) * T{0.5L},          T{0L}          , T{0L},
                  T{0L}          ,          T{0L}          ,   (near - far) * T{0.5L}, T{0L},
-        (left + right) * T{0.5L}, (bottom + top) * T{0.5L}, - (near + far) * T{0.5L}, T{1L}};
+        (left + right) * T{0.5L}, (bottom + top) * T{0.5L}, - (near + far) * T{0.5L}, T{1L}});
 }
 
 /**
  * Viewport transformation matrix.
  */
-template <typename T>
-constexpr mat<T, 4, 4> viewport(const vec<std::uint32_t, 2>& lower_left,
-                                const vec<std::uint32_t, 2>& size,
-                                T near, T far) {
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> viewport(const vec<std::uint32_t, 2>& lower_left,
+                                                      const vec<std::uint32_t, 2>& size,
+                                                      T near, T far, L = {}) {
     auto half_size = size * T{0.5L};
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
                 half_size.w       ,            T{0L}          ,         T{0L}         , T{0L},
                    T{0L}          ,         half_size.h       ,         T{0L}         , T{0L},
                    T{0L}          ,            T{0L}          , (far - near) * T{0.5L}, T{0L},
-        lower_left.x + half_size.w, lower_left.y + half_size.h, (far + near) * T{0.5L}, T{1L}};
+        lower_left.x + half_size.w, lower_left.y + half_size.h, (far + near) * T{0.5L}, T{1L}});
 }
 
 /**
  * Viewport transformation matrix when lower left corner is (0, 0).
  */
-template <typename T>
-constexpr mat<T, 4, 4> viewport(const vec<std::uint32_t, 2>& size,
-                                T near, T far) {
+template <typename T, typename L = column_major>
+constexpr eif<is_layout<L>, mat<T, 4, 4, L>> viewport(const vec<std::uint32_t, 2>& size,
+                                                      T near, T far, L = {}) {
     auto half_size = size * T{0.5L};
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
         half_size.w,    T{0L}   ,         T{0L}         , T{0L},
            T{0L}   , half_size.h,         T{0L}         , T{0L},
            T{0L}   ,    T{0L}   , (far - near) * T{0.5L}, T{0L},
-        half_size.w, half_size.h, (far + near) * T{0.5L}, T{1L}};
+        half_size.w, half_size.h, (far + near) * T{0.5L}, T{1L}});
+}
+
+/**
+ * The trace of an n-by-n square matrix A is defined to be the sum of the
+ * elements on the main diagonal.
+ * https://en.wikipedia.org/wiki/Trace_%28linear_algebra%29
+ */
+template <typename T, std::size_t D, typename L>
+constexpr auto trace(const mat<T, D, D, L>& m) {
+    T sum{};
+
+    for (std::size_t d = 0ul; d < D; ++ d) {
+        sum += m(d, d);
+    }
+
+    return sum;
 }
 
 namespace detail {
 
-template <typename T, std::size_t R, std::size_t C, std::size_t... Is>
-constexpr auto transpose(const mat<T, R, C>& M, std::index_sequence<Is...>) {
-    return mat<T, C, R>{
-        M.data[Is / C + R * (Is % C)]...
+template <typename T, std::size_t R, std::size_t C, typename L, typename M, std::size_t... Is>
+constexpr auto cut(const M& m, const vec<std::size_t, 2>& rc,
+                   std::index_sequence<Is...>) {
+    return mat<T, R - 1, C - 1, L>{
+        m(mat_i_to_r<L>(Is, {R - 1, C - 1}) + (mat_i_to_r<L>(Is, {R - 1, C - 1}) >= rc(0)),
+          mat_i_to_c<L>(Is, {R - 1, C - 1}) + (mat_i_to_c<L>(Is, {R - 1, C - 1}) >= rc(1)))...
     };
 }
 
 } // namespace detail
 
 /**
- * Return the transpose of a matrix.
+ * Return the matrix obtained by removing row rc(0) and column rc(1).
  */
-template <typename T, std::size_t R, std::size_t C>
-constexpr auto transpose(const mat<T, R, C>& M) {
-    return detail::transpose(M, std::make_index_sequence<R * C>());
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto cut(const mat<T, R, C, L>& M, const vec<std::size_t, 2>& rc) {
+    static_assert(R > 1 && C > 1, "cannot cut a single row or column matrix");
+
+    return detail::cut<T, R, C, L>(M, rc, std::make_index_sequence<(R - 1) * (C - 1)>());
 }
 
 /**
- * The trace of an n-by-n square matrix A is defined to be the sum of the
- * elements on the main diagonal.
- * https://en.wikipedia.org/wiki/Trace_%28linear_algebra%29
+ * LU factorization with partial pivoting : P ∙ M = L ∙ U.
+ * L (unit lower triangular, its diagonal is not stored) and U are packed in
+ * lu. P is described by perm, row i of P ∙ M being row perm(i) of M, and
+ * parity is det(P).
+ * singular is set when a pivot was zero or negligible, at most D epsilon times
+ * the largest magnitude in M : rounding of the elimination seldom leaves an
+ * exact zero pivot for rank deficient matrices. M is then not invertible, or
+ * too close to a singular matrix for its inverse to have any correct digit.
+ * lu is column-major whatever the layout of M.
  */
 template <typename T, std::size_t D>
-constexpr auto trace(const mat<T, D, D>& m) {
-    T sum{};
+struct lu_decomposition {
+    mat<T, D, D> lu;
+    vec<std::size_t, D> perm;
+    T parity;
+    bool singular;
+};
 
-    for (std::size_t d = 0ul; d < D; ++ d) {
-        sum += m(d, d);
+/**
+ * Return the LU factorization of M.
+ * Costs O(D³) instead of the O(D!) of cofactor expansion, it is what det() and
+ * inv() use for floating point matrices from 5x5.
+ */
+template <typename T, std::size_t D, typename L>
+constexpr lu_decomposition<T, D> lu(const mat<T, D, D, L>& M) {
+    static_assert(std::is_floating_point<T>::value, "T must be a floating point type");
+
+    lu_decomposition<T, D> r{to_layout<column_major>(M), {}, T{1L}, false};
+
+    T tolerance{};
+
+    for (std::size_t i = 0; i < r.lu.size; ++ i) {
+        const T i_abs = r.lu.data[i] < T{0L} ? - r.lu.data[i] : r.lu.data[i];
+
+        tolerance = tolerance < i_abs ? i_abs : tolerance;
     }
 
-    return sum;
+    tolerance *= static_cast<T>(D) * std::numeric_limits<T>::epsilon();
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        r.perm(d) = d;
+    }
+
+    for (std::size_t k = 0; k < D; ++ k) {
+        // Partial pivoting : biggest magnitude in column k, from row k.
+        std::size_t p = k;
+        T p_abs = r.lu(k, k) < T{0L} ? - r.lu(k, k) : r.lu(k, k);
+
+        for (std::size_t i = k + 1; i < D; ++ i) {
+            const T i_abs = r.lu(i, k) < T{0L} ? - r.lu(i, k) : r.lu(i, k);
+
+            if (p_abs < i_abs) {
+                p     = i;
+                p_abs = i_abs;
+            }
+        }
+
+        if (p_abs <= tolerance) {
+            r.singular = true;
+
+            if (p_abs == T{0L}) {
+                continue;
+            }
+        }
+
+        if (p != k) {
+            for (std::size_t c = 0; c < D; ++ c) {
+                const T t = r.lu(k, c);
+                r.lu(k, c) = r.lu(p, c);
+                r.lu(p, c) = t;
+            }
+
+            const std::size_t t = r.perm(k);
+            r.perm(k) = r.perm(p);
+            r.perm(p) = t;
+
+            r.parity = - r.parity;
+        }
+
+        const T rcp_pivot = T{1L} / r.lu(k, k);
+
+        for (std::size_t i = k + 1; i < D; ++ i) {
+            const T l = r.lu(i, k) * rcp_pivot;
+
+            r.lu(i, k) = l;
+
+            for (std::size_t c = k + 1; c < D; ++ c) {
+                r.lu(i, c) -= l * r.lu(k, c);
+            }
+        }
+    }
+
+    return r;
 }
 
 /**
- * Return determinant of a given matrix.
+ * Return determinant of the matrix a LU factorization comes from.
  */
 template <typename T, std::size_t D>
-constexpr auto det(const mat<T, D, D>& M) {
-    T result{T{0L}};
+constexpr T det(const lu_decomposition<T, D>& f) {
+    T result = f.parity;
 
-    for (std::size_t d = 0ul; d < D; ++ d) {
-        result +=
-            ((d & 1) ? - T{1L} : T{1L})
-            * M(0, d)
-            * det(cut(M, {0, d}));
+    for (std::size_t d = 0; d < D; ++ d) {
+        result *= f.lu(d, d);
     }
 
     return result;
 }
 
+/**
+ * Return x such as M ∙ x = b, f being the LU factorization of M.
+ * M must be invertible.
+ */
+template <typename T, std::size_t D>
+constexpr vec<T, D> solve(const lu_decomposition<T, D>& f, const vec<T, D>& b) {
+    vec<T, D> x{};
+
+    // L ∙ y = P ∙ b
+    for (std::size_t r = 0; r < D; ++ r) {
+        T s = b(f.perm(r));
+
+        for (std::size_t c = 0; c < r; ++ c) {
+            s -= f.lu(r, c) * x(c);
+        }
+
+        x(r) = s;
+    }
+
+    // U ∙ x = y
+    for (std::size_t r = D; r -- > 0;) {
+        T s = x(r);
+
+        for (std::size_t c = r + 1; c < D; ++ c) {
+            s -= f.lu(r, c) * x(c);
+        }
+
+        x(r) = s / f.lu(r, r);
+    }
+
+    return x;
+}
+
+/**
+ * Return x such as M ∙ x = b.
+ * M must be invertible.
+ */
+template <typename T, std::size_t D, typename L>
+constexpr vec<T, D> solve(const mat<T, D, D, L>& M, const vec<T, D>& b) {
+    return solve(lu(M), b);
+}
+
+/**
+ * Return inverse of the matrix a LU factorization comes from.
+ * Solves M ∙ X = I column by column.
+ */
+template <typename T, std::size_t D>
+constexpr mat<T, D, D> inv(const lu_decomposition<T, D>& f) {
+    mat<T, D, D> result{};
+
+    for (std::size_t c = 0; c < D; ++ c) {
+        vec<T, D> e{};
+        e(c) = T{1L};
+
+        const vec<T, D> x = solve(f, e);
+
+        for (std::size_t r = 0; r < D; ++ r) {
+            result(r, c) = x(r);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Return determinant of a given matrix.
+ * Floating point matrices from 5x5 go through LU factorization, others use
+ * cofactor expansion along the first row.
+ */
+template <typename T, std::size_t D>
+constexpr auto det(const mat<T, D, D>& M) {
+    if constexpr (D >= 5 && std::is_floating_point<T>::value) {
+        return det(lu(M));
+    }
+    else {
+        T result{T{0L}};
+
+        for (std::size_t d = 0ul; d < D; ++ d) {
+            result +=
+                ((d & 1) ? - T{1L} : T{1L})
+                * M(0, d)
+                * det(cut(M, {0, d}));
+        }
+
+        return result;
+    }
+}
+
 /**
  * Return determinant of a square matrix.
  * This overload is mandatory to avoid generic det() to instantiate a mat0x0.
@@ -358,14 +600,21 @@ constexpr auto inv(const mat<T, D, D>& M, T rcp_d, std::index_sequence<Is...>) {
 /**
  * Return inverse of an invertible square matrix.
  * No test is done for determinant equals zero, input matrix must be invertible.
+ * Floating point matrices from 5x5 go through LU factorization, others use
+ * the adjugate matrix.
  */
 template <typename T, std::size_t D>
 constexpr auto inv(const mat<T, D, D>& M) {
-    const T d = det(M);
+    if constexpr (D >= 5 && std::is_floating_point<T>::value) {
+        return inv(lu(M));
+    }
+    else {
+        const T d = det(M);
 
-    const T rcp_d = T{1L} / d;
+        const T rcp_d = T{1L} / d;
 
-    return detail::inv(M, rcp_d, std::make_index_sequence<D * D>());
+        return detail::inv(M, rcp_d, std::make_index_sequence<D * D>());
+    }
 }
 
 /**
@@ -392,70 +641,385 @@ constexpr auto inv(const mat<T, 3, 3>& M) {
         M(0, 0) * M(1, 1) - M(1, 0) * M(0, 1)} * rcp_d;
 }
 
+namespace detail {
+
+/**
+ * 4x4 inverse through the twelve 2x2 minors of the upper (s) and lower (c)
+ * row pairs. Each minor is computed once and shared by the determinant and all
+ * sixteen cofactors.
+ * Branch free, so that the batch inverse also runs it on packs.
+ */
+template <typename T, typename L>
+constexpr T inv_minors(const mat<T, 4, 4, L>& M, T (&s)[6], T (&c)[6]) {
+    s[0] = M(0, 0) * M(1, 1) - M(1, 0) * M(0, 1);
+    s[1] = M(0, 0) * M(1, 2) - M(1, 0) * M(0, 2);
+    s[2] = M(0, 0) * M(1, 3) - M(1, 0) * M(0, 3);
+    s[3] = M(0, 1) * M(1, 2) - M(1, 1) * M(0, 2);
+    s[4] = M(0, 1) * M(1, 3) - M(1, 1) * M(0, 3);
+    s[5] = M(0, 2) * M(1, 3) - M(1, 2) * M(0, 3);
+
+    c[0] = M(2, 0) * M(3, 1) - M(3, 0) * M(2, 1);
+    c[1] = M(2, 0) * M(3, 2) - M(3, 0) * M(2, 2);
+    c[2] = M(2, 0) * M(3, 3) - M(3, 0) * M(2, 3);
+    c[3] = M(2, 1) * M(3, 2) - M(3, 1) * M(2, 2);
+    c[4] = M(2, 1) * M(3, 3) - M(3, 1) * M(2, 3);
+    c[5] = M(2, 2) * M(3, 3) - M(3, 2) * M(2, 3);
+
+    return s[0] * c[5] - s[1] * c[4] + s[2] * c[3] + s[3] * c[2] - s[4] * c[1] + s[5] * c[0];
+}
+
+template <typename T, typename L>
+constexpr void inv_from_minors(const mat<T, 4, 4, L>& M, const T (&s)[6], const T (&c)[6], const T& rcp_d,
+    mat<T, 4, 4, L>* result) {
+    mat<T, 4, 4, L>& R = *result;
+
+    R(0, 0) = (  M(1, 1) * c[5] - M(1, 2) * c[4] + M(1, 3) * c[3]) * rcp_d;
+    R(0, 1) = (- M(0, 1) * c[5] + M(0, 2) * c[4] - M(0, 3) * c[3]) * rcp_d;
+    R(0, 2) = (  M(3, 1) * s[5] - M(3, 2) * s[4] + M(3, 3) * s[3]) * rcp_d;
+    R(0, 3) = (- M(2, 1) * s[5] + M(2, 2) * s[4] - M(2, 3) * s[3]) * rcp_d;
+
+    R(1, 0) = (- M(1, 0) * c[5] + M(1, 2) * c[2] - M(1, 3) * c[1]) * rcp_d;
+    R(1, 1) = (  M(0, 0) * c[5] - M(0, 2) * c[2] + M(0, 3) * c[1]) * rcp_d;
+    R(1, 2) = (- M(3, 0) * s[5] + M(3, 2) * s[2] - M(3, 3) * s[1]) * rcp_d;
+    R(1, 3) = (  M(2, 0) * s[5] - M(2, 2) * s[2] + M(2, 3) * s[1]) * rcp_d;
+
+    R(2, 0) = (  M(1, 0) * c[4] - M(1, 1) * c[2] + M(1, 3) * c[0]) * rcp_d;
+    R(2, 1) = (- M(0, 0) * c[4] + M(0, 1) * c[2] - M(0, 3) * c[0]) * rcp_d;
+    R(2, 2) = (  M(3, 0) * s[4] - M(3, 1) * s[2] + M(3, 3) * s[0]) * rcp_d;
+    R(2, 3) = (- M(2, 0) * s[4] + M(2, 1) * s[2] - M(2, 3) * s[0]) * rcp_d;
+
+    R(3, 0) = (- M(1, 0) * c[3] + M(1, 1) * c[1] - M(1, 2) * c[0]) * rcp_d;
+    R(3, 1) = (  M(0, 0) * c[3] - M(0, 1) * c[1] + M(0, 2) * c[0]) * rcp_d;
+    R(3, 2) = (- M(3, 0) * s[3] + M(3, 1) * s[1] - M(3, 2) * s[0]) * rcp_d;
+    R(3, 3) = (  M(2, 0) * s[3] - M(2, 1) * s[1] + M(2, 2) * s[0]) * rcp_d;
+}
+
+/**
+ * 4x4 inverse, determinant stored in d. Returns false, leaving result
+ * untouched, when determinant is zero.
+ */
+template <typename T>
+constexpr bool inv(const mat<T, 4, 4>& M, mat<T, 4, 4>* result, T* d) {
+    T s[6]{};
+    T c[6]{};
+
+    *d = inv_minors(M, s, c);
+
+    if (*d == T{0L}) {
+        return false;
+    }
+
+    inv_from_minors(M, s, c, T{1L} / *d, result);
+
+    return true;
+}
+
+} // namespace detail
+
 /**
  * Return inverse of an invertible square matrix.
  * Overload for mat4x4.
+ * mat<float, 4, 4> uses the native kernel when available.
  */
 template <typename T>
 constexpr auto inv(const mat<T, 4, 4>& M) {
-    T d = det(M);
+    mat<T, 4, 4> result{};
+    T d{};
 
-    T rcp_d = T{1L} / d;
+    if constexpr (simd::is_native_mat4<mat<T, 4, 4>> && std::is_same<T, float>::value) {
+        if (! is_constant_evaluated()) {
+            simd::inv(M, &result, &d);
+
+            return result;
+        }
+    }
+
+    detail::inv(M, &result, &d);
+
+    return result;
+}
+
+/**
+ * Return determinant of a row-major square matrix, the one of its column-major
+ * transpose.
+ */
+template <typename T, std::size_t D>
+constexpr auto det(const mat<T, D, D, row_major>& M) {
+    return det(as_transpose(M));
+}
+
+/**
+ * Return inverse of an invertible row-major square matrix.
+ * As inv(Mᵀ) is inv(M)ᵀ, the column-major kernels run on the same data.
+ */
+template <typename T, std::size_t D>
+constexpr auto inv(const mat<T, D, D, row_major>& M) {
+    return as_transpose(inv(as_transpose(M)));
+}
+
+/**
+ * Compute inverse of a square matrix into result, unless it is singular.
+ * Returns false, leaving result untouched, when determinant is zero. When d is
+ * given, determinant is stored in it in both cases.
+ * The 4x4 overload gets determinant from the minors it computes anyway for the
+ * inverse, there is no separate det() pass.
+ */
+template <typename T, std::size_t D>
+constexpr bool try_inv(const mat<T, D, D>& M, mat<T, D, D>* result, T* d = nullptr) {
+    T det_M{};
+
+    if constexpr (D == 4) {
+        bool invertible = false;
+
+        if constexpr (simd::is_native_mat4<mat<T, 4, 4>> && std::is_same<T, float>::value) {
+            if (! is_constant_evaluated()) {
+                invertible = simd::inv(M, result, &det_M);
+            }
+            else {
+                invertible = detail::inv(M, result, &det_M);
+            }
+        }
+        else {
+            invertible = detail::inv(M, result, &det_M);
+        }
+
+        if (d) {
+            *d = det_M;
+        }
+
+        return invertible;
+    }
+    else if constexpr (D >= 5 && std::is_floating_point<T>::value) {
+        const auto f = lu(M);
+
+        det_M = det(f);
+
+        if (d) {
+            *d = det_M;
+        }
+
+        if (f.singular) {
+            return false;
+        }
+
+        *result = inv(f);
+
+        return true;
+    }
+    else {
+        det_M = det(M);
+
+        if (d) {
+            *d = det_M;
+        }
+
+        if (det_M == T{0L}) {
+            return false;
+        }
+
+        if constexpr (D == 3) {
+            *result = inv(M);
+        }
+        else {
+            *result = detail::inv(M, T{1L} / det_M, std::make_index_sequence<D * D>());
+        }
+
+        return true;
+    }
+}
+
+/**
+ * Same as try_inv, for row-major matrices.
+ */
+template <typename T, std::size_t D>
+constexpr bool try_inv(const mat<T, D, D, row_major>& M, mat<T, D, D, row_major>* result, T* d = nullptr) {
+    mat<T, D, D> transposed_result{};
+
+    if (! try_inv(as_transpose(M), &transposed_result, d)) {
+        return false;
+    }
+
+    *result = as_transpose(transposed_result);
 
-    return mat<T, 4, 4>{
-        (M(1, 1) * (M(2, 2) * M(3, 3) - M(2, 3) * M(3, 2)) +
-         M(1, 2) * (M(2, 3) * M(3, 1) - M(2, 1) * M(3, 3)) +
-         M(1, 3) * (M(2, 1) * M(3, 2) - M(2, 2) * M(3, 1))),
-        ( - (M(1, 0) * (M(2, 2) * M(3, 3) - M(2, 3) * M(3, 2)) +
-             M(1, 2) * (M(2, 3) * M(3, 0) - M(2, 0) * M(3, 3)) +
-             M(1, 3) * (M(2, 0) * M(3, 2) - M(2, 2) * M(3, 0)))),
-        (M(1, 0) * (M(2, 1) * M(3, 3) - M(2, 3) * M(3, 1)) +
-         M(1, 1) * (M(2, 3) * M(3, 0) - M(2, 0) * M(3, 3)) +
-         M(1, 3) * (M(2, 0) * M(3, 1) - M(2, 1) * M(3, 0))),
-        ( - (M(1, 0) * (M(2, 1) * M(3, 2) - M(2, 2) * M(3, 1)) +
-             M(1, 1) * (M(2, 2) * M(3, 0) - M(2, 0) * M(3, 2)) +
-             M(1, 2) * (M(2, 0) * M(3, 1) - M(2, 1) * M(3, 0)))),
-
-        ( - (M(0, 1) * (M(2, 2) * M(3, 3) - M(2, 3) * M(3, 2)) +
-             M(0, 2) * (M(2, 3) * M(3, 1) - M(2, 1) * M(3, 3)) +
-             M(0, 3) * (M(2, 1) * M(3, 2) - M(2, 2) * M(3, 1)))),
-        (M(0, 0) * (M(2, 2) * M(3, 3) - M(2, 3) * M(3, 2)) +
-         M(0, 2) * (M(2, 3) * M(3, 0) - M(2, 0) * M(3, 3)) +
-         M(0, 3) * (M(2, 0) * M(3, 2) - M(2, 2) * M(3, 0))),
-        ( - (M(0, 0) * (M(2, 1) * M(3, 3) - M(2, 3) * M(3, 1)) +
-             M(0, 1) * (M(2, 3) * M(3, 0) - M(2, 0) * M(3, 3)) +
-             M(0, 3) * (M(2, 0) * M(3, 1) - M(2, 1) * M(3, 0)))),
-        (M(0, 0) * (M(2, 1) * M(3, 2) - M(2, 2) * M(3, 1)) +
-         M(0, 1) * (M(2, 2) * M(3, 0) - M(2, 0) * M(3, 2)) +
-         M(0, 2) * (M(2, 0) * M(3, 1) - M(2, 1) * M(3, 0))),
-
-        (M(0, 1) * (M(1, 2) * M(3, 3) - M(1, 3) * M(3, 2)) +
-         M(0, 2) * (M(1, 3) * M(3, 1) - M(1, 1) * M(3, 3)) +
-         M(0, 3) * (M(1, 1) * M(3, 2) - M(1, 2) * M(3, 1))),
-        ( - (M(0, 0) * (M(1, 2) * M(3, 3) - M(1, 3) * M(3, 2)) +
-             M(0, 2) * (M(1, 3) * M(3, 0) - M(1, 0) * M(3, 3)) +
-             M(0, 3) * (M(1, 0) * M(3, 2) - M(1, 2) * M(3, 0)))),
-        (M(0, 0) * (M(1, 1) * M(3, 3) - M(1, 3) * M(3, 1)) +
-         M(0, 1) * (M(1, 3) * M(3, 0) - M(1, 0) * M(3, 3)) +
-         M(0, 3) * (M(1, 0) * M(3, 1) - M(1, 1) * M(3, 0))),
-        ( - (M(0, 0) * (M(1, 1) * M(3, 2) - M(1, 2) * M(3, 1)) +
-             M(0, 1) * (M(1, 2) * M(3, 0) - M(1, 0) * M(3, 2)) +
-             M(0, 2) * (M(1, 0) * M(3, 1) - M(1, 1) * M(3, 0)))),
-
-        ( - (M(0, 1) * (M(1, 2) * M(2, 3) - M(1, 3) * M(2, 2)) +
-             M(0, 2) * (M(1, 3) * M(2, 1) - M(1, 1) * M(2, 3)) +
-             M(0, 3) * (M(1, 1) * M(2, 2) - M(1, 2) * M(2, 1)))),
-        (M(0, 0) * (M(1, 2) * M(2, 3) - M(1, 3) * M(2, 2)) +
-         M(0, 2) * (M(1, 3) * M(2, 0) - M(1, 0) * M(2, 3)) +
-         M(0, 3) * (M(1, 0) * M(2, 2) - M(1, 2) * M(2, 0))),
-        ( - (M(0, 0) * (M(1, 1) * M(2, 3) - M(1, 3) * M(2, 1)) +
-             M(0, 1) * (M(1, 3) * M(2, 0) - M(1, 0) * M(2, 3)) +
-             M(0, 3) * (M(1, 0) * M(2, 1) - M(1, 1) * M(2, 0)))),
-        (M(0, 0) * (M(1, 1) * M(2, 2) - M(1, 2) * M(2, 1)) +
-         M(0, 1) * (M(1, 2) * M(2, 0) - M(1, 0) * M(2, 2)) +
-         M(0, 2) * (M(1, 0) * M(2, 1) - M(1, 1) * M(2, 0)))} * rcp_d;
+    return true;
 }
 
+/**
+ * Return product of two affine transformation matrices, i.e. matrices which
+ * last row is 0 0 0 1. Input last rows are neither read nor checked.
+ * Only the 3x3 linear parts and translations are combined : 36
+ * multiplications instead of 64.
+ */
+template <typename T, typename L>
+constexpr mat<T, 4, 4, L> mul_affine(const mat<T, 4, 4, L>& lhs, const mat<T, 4, 4, L>& rhs) {
+    mat<T, 4, 4, L> result{};
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        for (std::size_t r = 0; r < 3; ++ r) {
+            result(r, c) =
+                lhs(r, 0) * rhs(0, c) +
+                lhs(r, 1) * rhs(1, c) +
+                lhs(r, 2) * rhs(2, c);
+        }
+    }
+
+    result(0, 3) += lhs(0, 3);
+    result(1, 3) += lhs(1, 3);
+    result(2, 3) += lhs(2, 3);
+    result(3, 3)  = T{1L};
+
+    return result;
+}
+
+namespace detail {
+
+/**
+ * Inverse of an affine transformation matrix from the inverse of its linear
+ * part : │L t│⁻¹ = │L⁻¹ - L⁻¹ ∙ t│
+ *        │0 1│     │ 0       1   │
+ * Works for mat4x4 and for mat3x4 which last row is implicit.
+ */
+template <typename T, std::size_t R, typename L>
+constexpr mat<T, R, 4, L> inv_affine(const mat<T, 3, 3>& L_inv, const mat<T, R, 4, L>& M) {
+    mat<T, R, 4, L> result{};
+
+    for (std::size_t r = 0; r < 3; ++ r) {
+        for (std::size_t c = 0; c < 3; ++ c) {
+            result(r, c) = L_inv(r, c);
+        }
+
+        result(r, 3) = - (
+            L_inv(r, 0) * M(0, 3) +
+            L_inv(r, 1) * M(1, 3) +
+            L_inv(r, 2) * M(2, 3));
+    }
+
+    if constexpr (R == 4) {
+        result(3, 3) = T{1L};
+    }
+
+    return result;
+}
+
+template <typename T, std::size_t R, typename L>
+constexpr mat<T, 3, 3> linear_part(const mat<T, R, 4, L>& M) {
+    return {
+        M(0, 0), M(1, 0), M(2, 0),
+        M(0, 1), M(1, 1), M(2, 1),
+        M(0, 2), M(1, 2), M(2, 2)};
+}
+
+} // namespace detail
+
+/**
+ * Return inverse of an invertible affine transformation matrix (last row is
+ * 0 0 0 1, not read). Costs a 3x3 inverse and a matrix-vector product.
+ */
+template <typename T, typename L>
+constexpr mat<T, 4, 4, L> inv_affine(const mat<T, 4, 4, L>& M) {
+    return detail::inv_affine(inv(detail::linear_part(M)), M);
+}
+
+/**
+ * Return inverse of a rigid transformation matrix : rotation (orthonormal
+ * linear part) and translation, last row being 0 0 0 1 (not read).
+ * Same as mat_look_at does, rotation is inverted by transposing it.
+ */
+template <typename T, typename L>
+constexpr mat<T, 4, 4, L> inv_rigid(const mat<T, 4, 4, L>& M) {
+    return detail::inv_affine(transpose(detail::linear_part(M)), M);
+}
+
+/**
+ * Return inverse of an invertible affine transformation mat3x4, which last
+ * row is implicitly 0 0 0 1.
+ */
+template <typename T, typename L>
+constexpr mat<T, 3, 4, L> inv(const mat<T, 3, 4, L>& M) {
+    return detail::inv_affine(inv(detail::linear_part(M)), M);
+}
+
+/**
+ * Return inverse of a rigid transformation mat3x4 (orthonormal linear part).
+ */
+template <typename T, typename L>
+constexpr mat<T, 3, 4, L> inv_rigid(const mat<T, 3, 4, L>& M) {
+    return detail::inv_affine(transpose(detail::linear_part(M)), M);
+}
+
+/**
+ * Return the affine transformation mat3x4 made of the first three rows of M.
+ * M last row is expected to be 0 0 0 1 and is not read.
+ */
+template <typename T, typename L>
+constexpr mat<T, 3, 4, L> affine_from(const mat<T, 4, 4, L>& M) {
+    return to_layout<L>(mat<T, 3, 4>{
+        M(0, 0), M(1, 0), M(2, 0),
+        M(0, 1), M(1, 1), M(2, 1),
+        M(0, 2), M(1, 2), M(2, 2),
+        M(0, 3), M(1, 3), M(2, 3)});
+}
+
+/**
+ * Return the mat4x4 equivalent to an affine transformation mat3x4, adding
+ * the implicit 0 0 0 1 last row.
+ */
+template <typename T, typename L>
+constexpr mat<T, 4, 4, L> projective_from(const mat<T, 3, 4, L>& M) {
+    return to_layout<L>(mat<T, 4, 4>{
+        M(0, 0), M(1, 0), M(2, 0), T{0L},
+        M(0, 1), M(1, 1), M(2, 1), T{0L},
+        M(0, 2), M(1, 2), M(2, 2), T{0L},
+        M(0, 3), M(1, 3), M(2, 3), T{1L}});
+}
+
+namespace detail {
+
+/**
+ * Return a transformation matrix of R rows and C columns, mat3x3, mat3x4
+ * (affine) or mat4x4, from its rotation part, translation being null.
+ * Used by mat_from<R, C> builders, which so only compute 9 values.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> rotation_as(const mat<T, 3, 3>& M) {
+    static_assert((R == 3 && (C == 3 || C == 4)) || (R == 4 && C == 4),
+                  "only mat3x3, mat3x4 and mat4x4 can be built");
+
+    if constexpr (C == 3) {
+        return M;
+    }
+    else if constexpr (R == 3) {
+        return {
+            M(0, 0), M(1, 0), M(2, 0),
+            M(0, 1), M(1, 1), M(2, 1),
+            M(0, 2), M(1, 2), M(2, 2),
+            T{0L},   T{0L},   T{0L}};
+    }
+    else {
+        return {
+            M(0, 0), M(1, 0), M(2, 0), T{0L},
+            M(0, 1), M(1, 1), M(2, 1), T{0L},
+            M(0, 2), M(1, 2), M(2, 2), T{0L},
+            T{0L},   T{0L},   T{0L},   T{1L}};
+    }
+}
+
+/**
+ * Return the rotation part of a mat3x3, mat3x4 or mat4x4 transformation
+ * matrix, the inverse of rotation_as.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr mat<T, 3, 3> rotation_of(const mat<T, R, C, L>& M) {
+    static_assert(R >= 3 && C >= 3, "M must have 3 rows and columns at least");
+
+    return {
+        M(0, 0), M(1, 0), M(2, 0),
+        M(0, 1), M(1, 1), M(2, 1),
+        M(0, 2), M(1, 2), M(2, 2)};
+}
+
+} // namespace detail
+
 /**
  * Compute a view matrix (generally V_W). This matrix is the inverse of the W_M
  * matrix we would need if we wanted to render the concerned camera as an object
@@ -472,8 +1036,8 @@ constexpr auto inv(const mat<T, 4, 4>& M) {
  * with dot products (negated due to inverse translation), avoiding all the
  * identity "part" of the translation matrix).
  */
-template <typename T>
-mat<T, 4, 4> mat_look_at(const vec<T, 3>& pos, const vec<T, 3>& at, const vec<T, 3>& up) {
+template <typename T, typename L = column_major>
+eif<is_layout<L>, mat<T, 4, 4, L>> mat_look_at(const vec<T, 3>& pos, const vec<T, 3>& at, const vec<T, 3>& up, L = {}) {
     // We should get the identity matrix when the camera is placed at world's
     // origin looking along world's forward. If forward is -Z, we won't get this
     // identity matrix so we use backward vector which is POS minus AT. It's
@@ -485,21 +1049,26 @@ mat<T, 4, 4> mat_look_at(const vec<T, 3>& pos, const vec<T, 3>& at, const vec<T,
     vec<T, 3> u, r;
     orthonormal_basis(b, up, &u, &r);
 
-    return {
+    return to_layout<L>(mat<T, 4, 4>{
               r.x,           u.x,           b.x,     T{0L},
               r.y,           u.y,           b.y,     T{0L},
               r.z,           u.z,           b.z,     T{0L},
-        - dot(r, pos), - dot(u, pos), - dot(b, pos), T{1L}};
+        - dot(r, pos), - dot(u, pos), - dot(b, pos), T{1L}});
 }
 
 namespace detail {
 
+/**
+ * Map kernels, from taking any R x C matrix and DI vector read through
+ * operator() : mat and vec, or their views.
+ */
 template <std::size_t DO, typename T, std::size_t R, std::size_t C, std::size_t DI>
 struct linear_map_to {
     static_assert(DO <= R, "matrix row count must be greater or equal to output dimension");
     static_assert(DI <= C, "matrix column count must be greater or equal to input dimension");
 
-    constexpr static vec<T, DO> from(const mat<T, R, C>& lhs, const vec<T, DI>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, DO> from(const M& lhs, const V& rhs) {
         vec<T, DO> result{};
 
         for (std::size_t r = 0; r < DO; ++ r) {
@@ -517,7 +1086,8 @@ struct linear_map_to<2, T, R, C, 2> {
     static_assert(2 <= R, "matrix row count must be greater or equal to 2");
     static_assert(2 <= C, "matrix column count must be greater or equal to 2");
 
-    constexpr static vec<T, 2> from(const mat<T, R, C>& lhs, const vec<T, 2>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, 2> from(const M& lhs, const V& rhs) {
         vec<T, 2> result{
             lhs(0, 0) * rhs(0) + lhs(0, 1) * rhs(1),
             lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1)
@@ -532,7 +1102,8 @@ struct linear_map_to<3, T, R, C, 3> {
     static_assert(3 <= R, "matrix row count must be greater or equal to 3");
     static_assert(3 <= C, "matrix column count must be greater or equal to 3");
 
-    constexpr static vec<T, 3> from(const mat<T, R, C>& lhs, const vec<T, 3>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, 3> from(const M& lhs, const V& rhs) {
         vec<T, 3> result{
             lhs(0, 0) * rhs(0) + lhs(0, 1) * rhs(1) + lhs(0, 2) * rhs(2),
             lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1) + lhs(1, 2) * rhs(2),
@@ -548,7 +1119,8 @@ struct affine_map_to {
     static_assert(DO <= R, "matrix row count must be greater or equal to output dimension");
     static_assert(DI < C, "matrix column count must be greater than input dimension");
 
-    constexpr static vec<T, DO> from(const mat<T, R, C>& lhs, const vec<T, DI>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, DO> from(const M& lhs, const V& rhs) {
         vec<T, DO> result{};
 
         for (std::size_t r = 0; r < DO; ++ r) {
@@ -568,10 +1140,11 @@ struct affine_map_to<2, T, R, C, 2> {
     static_assert(2 <= R, "matrix row count must be greater or equal to 2");
     static_assert(2 <= C, "matrix column count must be greater or equal to 2");
 
-    constexpr static vec<T, 2> from(const mat<T, R, C>& lhs, const vec<T, 2>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, 2> from(const M& lhs, const V& rhs) {
         vec<T, 2> result{
             lhs(0, 0) * rhs(0) + lhs(0, 1) * rhs(1) + lhs(0, 2),
-            lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1) + rhs(1, 2)
+            lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1) + lhs(1, 2)
         };
 
         return result;
@@ -583,7 +1156,8 @@ struct affine_map_to<3, T, R, C, 3> {
     static_assert(3 <= R, "matrix row count must be greater or equal to 3");
     static_assert(3 <= C, "matrix column count must be greater or equal to 3");
 
-    constexpr static vec<T, 3> from(const mat<T, R, C>& lhs, const vec<T, 3>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, 3> from(const M& lhs, const V& rhs) {
         vec<T, 3> result{
             lhs(0, 0) * rhs(0) + lhs(0, 1) * rhs(1) + lhs(0, 2) * rhs(2) + lhs(0, 3),
             lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1) + lhs(1, 2) * rhs(2) + lhs(1, 3),
@@ -604,7 +1178,8 @@ struct projective_map_to {
     static_assert(DO < R, "matrix row count must be greater than output dimension");
     static_assert(DI < C, "matrix column count must be greater than input dimension");
 
-    constexpr static vec<T, DO> from(const mat<T, R, C>& lhs, const vec<T, DI>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, DO> from(const M& lhs, const V& rhs) {
         vec<T, DO + 1> result{};
 
         for (std::size_t r = 0; r < DO + 1; ++ r) {
@@ -624,13 +1199,14 @@ struct projective_map_to<2, T, R, C, 2> {
     static_assert(2 < R, "matrix row count must be greater than 2");
     static_assert(2 < C, "matrix column count must be greater than 2");
 
-    constexpr static vec<T, 2> from(const mat<T, R, C>& lhs, const vec<T, 2>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, 2> from(const M& lhs, const V& rhs) {
         vec<T, 2> result{
             lhs(0, 0) * rhs(0) + lhs(0, 1) * rhs(1) + lhs(0, 2),
-            lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1) + rhs(1, 2)
+            lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1) + lhs(1, 2)
         };
 
-        T denum = lhs(2, 0) * rhs(0) + lhs(2, 1) * rhs(1) + rhs(2, 2);
+        T denum = lhs(2, 0) * rhs(0) + lhs(2, 1) * rhs(1) + lhs(2, 2);
 
         return result / denum;
     }
@@ -641,7 +1217,8 @@ struct projective_map_to<3, T, R, C, 3> {
     static_assert(3 < R, "matrix row count must be greater than 3");
     static_assert(3 < C, "matrix column count must be greater than 3");
 
-    constexpr static vec<T, 3> from(const mat<T, R, C>& lhs, const vec<T, 3>& rhs) {
+    template <typename M, typename V>
+    constexpr static vec<T, 3> from(const M& lhs, const V& rhs) {
         vec<T, 3> result{
             lhs(0, 0) * rhs(0) + lhs(0, 1) * rhs(1) + lhs(0, 2) * rhs(2) + lhs(0, 3),
             lhs(1, 0) * rhs(0) + lhs(1, 1) * rhs(1) + lhs(1, 2) * rhs(2) + lhs(1, 3),
@@ -656,33 +1233,33 @@ struct projective_map_to<3, T, R, C, 3> {
 
 } // namespace detail
 
-template <std::size_t DO, typename T, std::size_t R, std::size_t C, std::size_t DI>
-constexpr vec<T, DO> linear_map_to(const mat<T, R, C>& lhs, const vec<T, DI>& rhs) {
+template <std::size_t DO, typename T, std::size_t R, std::size_t C, typename L, std::size_t DI>
+constexpr vec<T, DO> linear_map_to(const mat<T, R, C, L>& lhs, const vec<T, DI>& rhs) {
     return detail::linear_map_to<DO, T, R, C, DI>::from(lhs, rhs);
 }
 
-template <typename T, std::size_t R, std::size_t C, std::size_t D>
-constexpr vec<T, D> linear_map(const mat<T, R, C>& lhs, const vec<T, D>& rhs) {
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+constexpr vec<T, D> linear_map(const mat<T, R, C, L>& lhs, const vec<T, D>& rhs) {
     return detail::linear_map_to<D, T, R, C, D>::from(lhs, rhs);
 }
 
-template <std::size_t DO, typename T, std::size_t R, std::size_t C, std::size_t DI>
-constexpr vec<T, DO> affine_map_to(const mat<T, R, C>& lhs, const vec<T, DI>& rhs) {
+template <std::size_t DO, typename T, std::size_t R, std::size_t C, typename L, std::size_t DI>
+constexpr vec<T, DO> affine_map_to(const mat<T, R, C, L>& lhs, const vec<T, DI>& rhs) {
     return detail::affine_map_to<DO, T, R, C, DI>::from(lhs, rhs);
 }
 
-template <typename T, std::size_t R, std::size_t C, std::size_t D>
-constexpr vec<T, D> affine_map(const mat<T, R, C>& lhs, const vec<T, D>& rhs) {
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+constexpr vec<T, D> affine_map(const mat<T, R, C, L>& lhs, const vec<T, D>& rhs) {
     return detail::affine_map_to<D, T, R, C, D>::from(lhs, rhs);
 }
 
-template <std::size_t DO, typename T, std::size_t R, std::size_t C, std::size_t DI>
-constexpr vec<T, DO> projective_map_to(const mat<T, R, C>& lhs, const vec<T, DI>& rhs) {
+template <std::size_t DO, typename T, std::size_t R, std::size_t C, typename L, std::size_t DI>
+constexpr vec<T, DO> projective_map_to(const mat<T, R, C, L>& lhs, const vec<T, DI>& rhs) {
     return detail::projective_map_to<DO, T, R, C, DI>::from(lhs, rhs);
 }
 
-template <typename T, std::size_t R, std::size_t C, std::size_t D>
-constexpr vec<T, D> projective_map(const mat<T, R, C>& lhs, const vec<T, D>& rhs) {
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+constexpr vec<T, D> projective_map(const mat<T, R, C, L>& lhs, const vec<T, D>& rhs) {
     return detail::projective_map_to<D, T, R, C, D>::from(lhs, rhs);
 }
 
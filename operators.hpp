@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include <ee_utils/componentwise.hpp>
 
 #include "mat.hpp"
@@ -14,6 +16,7 @@
 #include "quat.hpp"
 #include "common.hpp"
 #include "functions.hpp"
+#include "simd.hpp"
 
 namespace ee {
 namespace math {
@@ -30,6 +33,12 @@ using tutil::eif;
  */
 template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
 constexpr bool operator==(const T& lhs, const T& rhs) {
+    if constexpr (simd::is_native<T>) {
+        if (! is_constant_evaluated()) {
+            return simd::equal(lhs, rhs);
+        }
+    }
+
     for (std::size_t i = 0; i < T::size; ++ i) {
         if (lhs.data[i] != rhs.data[i]) {
             return false;
@@ -98,21 +107,21 @@ constexpr bool operator>=(const T& lhs, const T& rhs) {
 
 /**
  * +.
- * For mat and vec.
+ * For mat, vec and quat.
  * Yeah, does nothing...
  */
-template <typename T, typename = eif<is_mat<T> || is_vec<T>>>
+template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
 constexpr auto operator+(const T& rhs) {
     return rhs;
 }
 
 /**
  * Opposite.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename T, typename = eif<is_mat<T> || is_vec<T>>>
+template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
 constexpr auto operator-(const T& rhs) {
-    return cwise(opp, rhs);
+    return simd::cwise(opp, rhs);
 }
 
 /**
@@ -121,10 +130,18 @@ constexpr auto operator-(const T& rhs) {
 
 /**
  * Matrix-matrix multiplication.
+ * Result has the layout of lhs. Mixing layouts goes through the generic loop,
+ * same layouts get the native kernel when available.
  */
-template <typename T, std::size_t R, std::size_t LC, std::size_t RC>
-constexpr auto operator*(const mat<T, R, LC>& lhs, const mat<T, LC, RC>& rhs) {
-    mat<T, R, RC> result{};
+template <typename T, std::size_t R, std::size_t LC, std::size_t RC, typename LL, typename RL>
+constexpr auto operator*(const mat<T, R, LC, LL>& lhs, const mat<T, LC, RC, RL>& rhs) {
+    if constexpr (simd::is_native_mat4<mat<T, R, LC, LL>> && std::is_same<LL, RL>::value) {
+        if (! is_constant_evaluated()) {
+            return simd::product(lhs, rhs);
+        }
+    }
+
+    mat<T, R, RC, LL> result{};
 
     for (std::size_t k = 0; k < RC; ++ k) {
         for (std::size_t j = 0; j < R; ++ j) {
@@ -142,11 +159,43 @@ constexpr auto operator*(const mat<T, R, LC>& lhs, const mat<T, LC, RC>& rhs) {
     return result;
 }
 
+/**
+ * Affine transformation composition.
+ * mat3x4 are affine transformation matrices which implicit last row is
+ * 0 0 0 1, the product is the one of the equivalent mat4x4 without ever
+ * materializing that row : 36 multiplications.
+ */
+template <typename T, typename L>
+constexpr auto operator*(const mat<T, 3, 4, L>& lhs, const mat<T, 3, 4, L>& rhs) {
+    mat<T, 3, 4, L> result{};
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        for (std::size_t r = 0; r < 3; ++ r) {
+            result(r, c) =
+                lhs(r, 0) * rhs(0, c) +
+                lhs(r, 1) * rhs(1, c) +
+                lhs(r, 2) * rhs(2, c);
+        }
+    }
+
+    result(0, 3) += lhs(0, 3);
+    result(1, 3) += lhs(1, 3);
+    result(2, 3) += lhs(2, 3);
+
+    return result;
+}
+
 /**
  * Matrix-vector multiplication.
  */
-template <typename T, std::size_t R, std::size_t C>
-constexpr auto operator*(const mat<T, R, C>& lhs, const vec<T, C>& rhs) {
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto operator*(const mat<T, R, C, L>& lhs, const vec<T, C>& rhs) {
+    if constexpr (simd::is_native_mat4<mat<T, R, C, L>>) {
+        if (! is_constant_evaluated()) {
+            return simd::product(lhs, rhs);
+        }
+    }
+
     vec<T, R> result{};
 
     for (std::size_t r = 0; r < R; ++ r) {
@@ -164,47 +213,47 @@ constexpr auto operator*(const mat<T, R, C>& lhs, const vec<T, C>& rhs) {
 
 /**
  * Scalar multiplication.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
+template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT> || is_quat<LT>) && is_num<RT>>>
 constexpr auto operator*(const LT& lhs, RT rhs) {
-    return cwise(mul, lhs, rhs);
+    return simd::cwise(mul, lhs, rhs);
 }
 
 /**
  * Scalar multiplication.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename LT, typename RT, typename = eif<is_num<LT> && (is_mat<RT> || is_vec<RT>)>>
+template <typename LT, typename RT, typename = eif<is_num<LT> && (is_mat<RT> || is_vec<RT> || is_quat<RT>)>>
 constexpr auto operator*(LT lhs, const RT& rhs) {
-    return cwise(mul, lhs, rhs);
+    return simd::cwise(mul, lhs, rhs);
 }
 
 /**
  * Scalar division.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
+template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT> || is_quat<LT>) && is_num<RT>>>
 constexpr auto operator/(const LT& lhs, RT rhs) {
-    return cwise(div, lhs, rhs);
+    return simd::cwise(div, lhs, rhs);
 }
 
 /**
  * Addition.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename T, typename = eif<is_mat<T> || is_vec<T>>>
+template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
 constexpr auto operator+(const T& lhs, const T& rhs) {
-    return cwise(add, lhs, rhs);
+    return simd::cwise(add, lhs, rhs);
 }
 
 /**
  * Subtraction.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename T, typename = eif<is_mat<T> || is_vec<T>>>
+template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
 constexpr auto operator-(const T& lhs, const T& rhs) {
-    return cwise(sub, lhs, rhs);
+    return simd::cwise(sub, lhs, rhs);
 }
 
 /**
@@ -213,9 +262,10 @@ constexpr auto operator-(const T& lhs, const T& rhs) {
 
 /**
  * Matrix-matrix multiplication.
+ * Also affine transformation composition for mat3x4.
  */
-template <typename T, std::size_t R, std::size_t C>
-constexpr const auto& operator*=(mat<T, R, C>& lhs, const mat<T, R, C>& rhs) {
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr const auto& operator*=(mat<T, R, C, L>& lhs, const mat<T, R, C, L>& rhs) {
     lhs = lhs * rhs;
 
     return lhs;
@@ -223,38 +273,38 @@ constexpr const auto& operator*=(mat<T, R, C>& lhs, const mat<T, R, C>& rhs) {
 
 /**
  * Scalar multiplication.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
+template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT> || is_quat<LT>) && is_num<RT>>>
 constexpr const auto& operator*=(LT& lhs, RT rhs) {
-    return lhs = cwise(mul, lhs, rhs);
+    return lhs = simd::cwise(mul, lhs, rhs);
 }
 
 /**
  * Scalar division.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
+template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT> || is_quat<LT>) && is_num<RT>>>
 constexpr const auto& operator/=(LT& lhs, RT rhs) {
-    return lhs = cwise(div, lhs, rhs);
+    return lhs = simd::cwise(div, lhs, rhs);
 }
 
 /**
  * Addition.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename T, typename = eif<is_mat<T> || is_vec<T>>>
+template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
 constexpr const auto& operator+=(T& lhs, const T& rhs) {
-    return lhs = cwise(add, lhs, rhs);
+    return lhs = simd::cwise(add, lhs, rhs);
 }
 
 /**
  * Subtraction.
- * For mat and vec.
+ * For mat, vec and quat.
  */
-template <typename T, typename = eif<is_mat<T> || is_vec<T>>>
+template <typename T, typename = eif<is_mat<T> || is_vec<T> || is_quat<T>>>
 constexpr const auto& operator-=(T& lhs, const T& rhs) {
-    return lhs = cwise(sub, lhs, rhs);
+    return lhs = simd::cwise(sub, lhs, rhs);
 }
 
 /**
@@ -267,7 +317,7 @@ constexpr const auto& operator-=(T& lhs, const T& rhs) {
  */
 template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
 constexpr const auto& operator<<=(LT& lhs, RT rhs) {
-    return lhs = cwise(lshift, lhs, rhs);
+    return lhs = simd::cwise(lshift, lhs, rhs);
 }
 
 /**
@@ -276,7 +326,7 @@ constexpr const auto& operator<<=(LT& lhs, RT rhs) {
  */
 template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
 constexpr auto operator<<(const LT& lhs, RT rhs) {
-    return cwise(lshift, lhs, rhs);
+    return simd::cwise(lshift, lhs, rhs);
 }
 
 /**
@@ -285,7 +335,7 @@ constexpr auto operator<<(const LT& lhs, RT rhs) {
  */
 template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
 constexpr const auto& operator>>=(LT& lhs, RT rhs) {
-    return lhs = cwise(rshift, lhs, rhs);
+    return lhs = simd::cwise(rshift, lhs, rhs);
 }
 
 /**
@@ -294,7 +344,7 @@ constexpr const auto& operator>>=(LT& lhs, RT rhs) {
  */
 template <typename LT, typename RT, typename = eif<(is_mat<LT> || is_vec<LT>) && is_num<RT>>>
 constexpr auto operator>>(const LT& lhs, RT rhs) {
-    return cwise(rshift, lhs, rhs);
+    return simd::cwise(rshift, lhs, rhs);
 }
 
 } // namespace math
@@ -0,0 +1,590 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#include <ee_utils/componentwise.hpp>
+#include <ee_utils/templates.hpp>
+
+#include "common.hpp"
+#include "functions.hpp"
+#include "mat.hpp"
+#include "quat.hpp"
+#include "vec.hpp"
+
+namespace ee {
+namespace math {
+
+using tutil::eif;
+
+/**
+ * N lanes of T behaving as a single number, to use as T of vec, mat and quat :
+ * their operators and functions then compute N results at once, e.g. cross
+ * of two vec<float8, 3> gives 8 cross products.
+ * Lanes are a GCC / Clang vector, operations compile to the widest registers
+ * the target has (SSE, AVX, AVX-512), several of them when the pack is wider.
+ * Arithmetic operators also take scalars, broadcast to all lanes.
+ * Functors from functions.hpp apply lane by lane, libm ones through a call per
+ * lane except sqrt. Functions branching on values (comparisons) do not
+ * accept packs.
+ */
+template <typename T, std::size_t N>
+struct pack {
+    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(N > 1 && (N & (N - 1)) == 0, "N must be a power of 2");
+
+    using lane_type   = T;
+    typedef T native_type __attribute__((vector_size(N * sizeof(T))));
+
+    /**
+     * Same, for loads and stores from memory holding T values.
+     */
+    typedef T unaligned_type __attribute__((vector_size(N * sizeof(T)), aligned(alignof(T)), may_alias));
+
+    constexpr static std::size_t lanes = N;
+
+    native_type v;
+
+    pack() = default;
+
+    constexpr pack(const native_type& n) : v(n) {
+    }
+
+    /**
+     * All lanes set to s.
+     */
+    template <typename U, typename = eif<std::is_arithmetic<U>::value>>
+    constexpr pack(U s) : pack(static_cast<T>(s), std::make_index_sequence<N>()) {
+    }
+
+    inline constexpr T operator[](std::size_t lane) const {
+        return v[lane];
+    }
+
+    /**
+     * Lanes from the N values at p, any alignment of T.
+     */
+    static pack load(const T* p) {
+        return native_type(*reinterpret_cast<const unaligned_type*>(p));
+    }
+
+    /**
+     * Store lanes to the N values at p, any alignment of T.
+     */
+    void store(T* p) const {
+        *reinterpret_cast<unaligned_type*>(p) = v;
+    }
+
+    friend constexpr pack operator+(const pack& rhs) {
+        return rhs;
+    }
+
+    friend constexpr pack operator-(const pack& rhs) {
+        return - rhs.v;
+    }
+
+    friend constexpr pack operator+(const pack& lhs, const pack& rhs) {
+        return lhs.v + rhs.v;
+    }
+
+    friend constexpr pack operator-(const pack& lhs, const pack& rhs) {
+        return lhs.v - rhs.v;
+    }
+
+    friend constexpr pack operator*(const pack& lhs, const pack& rhs) {
+        return lhs.v * rhs.v;
+    }
+
+    friend constexpr pack operator/(const pack& lhs, const pack& rhs) {
+        return lhs.v / rhs.v;
+    }
+
+    friend constexpr pack& operator+=(pack& lhs, const pack& rhs) {
+        lhs.v += rhs.v;
+
+        return lhs;
+    }
+
+    friend constexpr pack& operator-=(pack& lhs, const pack& rhs) {
+        lhs.v -= rhs.v;
+
+        return lhs;
+    }
+
+    friend constexpr pack& operator*=(pack& lhs, const pack& rhs) {
+        lhs.v *= rhs.v;
+
+        return lhs;
+    }
+
+    friend constexpr pack& operator/=(pack& lhs, const pack& rhs) {
+        lhs.v /= rhs.v;
+
+        return lhs;
+    }
+
+private:
+    template <std::size_t... Ls>
+    constexpr pack(T s, std::index_sequence<Ls...>) : v{(static_cast<void>(Ls), s)...} {
+    }
+};
+
+using float4  = pack<float, 4>;
+using float8  = pack<float, 8>;
+using float16 = pack<float, 16>;
+using double2 = pack<double, 2>;
+using double4 = pack<double, 4>;
+using double8 = pack<double, 8>;
+
+namespace detail {
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_shufflevector)
+#define EE_MATH_HAS_SHUFFLEVECTOR 1
+#endif
+#endif
+
+template <typename R, typename T, std::size_t N, typename F>
+pack<T, N> by_register(const pack<T, N>& p, F f);
+
+#if defined(EE_MATH_HAS_SHUFFLEVECTOR)
+template <typename R, typename T, std::size_t N, typename F, std::size_t... Hs, std::size_t... Is>
+pack<T, N> by_halves(const pack<T, N>& p, F f, std::index_sequence<Hs...>, std::index_sequence<Is...>) {
+    const pack<T, N / 2> lo = by_register<R>(pack<T, N / 2>{__builtin_shufflevector(p.v, p.v, Hs...)}, f);
+    const pack<T, N / 2> hi = by_register<R>(pack<T, N / 2>{__builtin_shufflevector(p.v, p.v, (N / 2 + Hs)...)}, f);
+
+    return pack<T, N>{__builtin_shufflevector(lo.v, hi.v, Is...)};
+}
+#endif
+
+/**
+ * f on each register sized part of p, R being the register type.
+ * Halves are split and joined in registers where the compiler can, as going
+ * through memory stalls on store forwarding.
+ */
+template <typename R, typename T, std::size_t N, typename F>
+pack<T, N> by_register(const pack<T, N>& p, F f) {
+#if defined(EE_MATH_HAS_SHUFFLEVECTOR)
+    if constexpr (sizeof(p.v) == sizeof(R)) {
+        return pack<T, N>{(typename pack<T, N>::native_type)(f((R)(p.v)))};
+    } else {
+        return by_halves<R>(p, f, std::make_index_sequence<N / 2>{}, std::make_index_sequence<N>{});
+    }
+#else
+    pack<T, N> result;
+
+    for (std::size_t o = 0; o < sizeof(p.v); o += sizeof(R)) {
+        R r;
+
+        std::memcpy(&r, reinterpret_cast<const char*>(&p.v) + o, sizeof(R));
+        r = f(r);
+        std::memcpy(reinterpret_cast<char*>(&result.v) + o, &r, sizeof(R));
+    }
+
+    return result;
+#endif
+}
+
+/**
+ * Square root instructions, libm call per lane where the target has none.
+ */
+template <typename T, std::size_t N>
+pack<T, N> sqrt_lanes(const pack<T, N>& p) {
+    constexpr bool is_float  = std::is_same<T, float>::value;
+    constexpr bool is_double = std::is_same<T, double>::value;
+
+#if defined(__AVX512F__)
+    if constexpr (sizeof(p.v) % 64 == 0 && is_float) {
+        return by_register<__m512>(p, [](__m512 r) { return _mm512_sqrt_ps(r); });
+    } else if constexpr (sizeof(p.v) % 64 == 0 && is_double) {
+        return by_register<__m512d>(p, [](__m512d r) { return _mm512_sqrt_pd(r); });
+    }
+#endif
+
+#if defined(__AVX__)
+    if constexpr (sizeof(p.v) % 32 == 0 && is_float) {
+        return by_register<__m256>(p, [](__m256 r) { return _mm256_sqrt_ps(r); });
+    } else if constexpr (sizeof(p.v) % 32 == 0 && is_double) {
+        return by_register<__m256d>(p, [](__m256d r) { return _mm256_sqrt_pd(r); });
+    }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    if constexpr (sizeof(p.v) % 16 == 0 && is_float) {
+        return by_register<__m128>(p, [](__m128 r) { return _mm_sqrt_ps(r); });
+    } else if constexpr (sizeof(p.v) % 16 == 0 && is_double) {
+        return by_register<__m128d>(p, [](__m128d r) { return _mm_sqrt_pd(r); });
+    }
+#endif
+
+    return lanewise([](T v) { return sqrt(v); }, p);
+}
+
+} // namespace detail
+
+/**
+ * E (vec, mat or quat) with N lanes, e.g. wide<vec<float, 3>, 8> is
+ * vec<float8, 3>.
+ */
+template <typename E, std::size_t N>
+using wide = typename ee::but<E, pack<typename E::value_type, N>>::type;
+
+namespace detail {
+
+/**
+ * Lanes of a and b picked by Is, index i < N picking lane i of a and N + i
+ * lane i of b.
+ */
+template <std::size_t... Is, typename T, std::size_t N>
+inline pack<T, N> shuffle(const pack<T, N>& a, const pack<T, N>& b) {
+#if defined(__clang__)
+    return __builtin_shufflevector(a.v, b.v, Is...);
+#else
+    using I = std::conditional_t<sizeof(T) == 4, std::int32_t, std::int64_t>;
+    typedef I mask_type __attribute__((vector_size(N * sizeof(T))));
+
+    return __builtin_shuffle(a.v, b.v, mask_type{I(Is)...});
+#endif
+}
+
+/**
+ * Transposition of N consecutive E, E::size values each, through shuffles of
+ * contiguous blocks of N values, for E small enough for these to be fewer
+ * than the lane by lane inserts and extracts.
+ * Gathering component d merges, one shuffle each, the blocks holding its
+ * lanes; scattering block j merges the components it holds.
+ */
+constexpr std::size_t gather_index(std::size_t s, std::size_t n, std::size_t d, std::size_t j, std::size_t l) {
+    const std::size_t first = d / n;
+    const std::size_t b = (l * s + d) / n;
+    const std::size_t o = (l * s + d) % n;
+
+    if (j == first + 1) {
+        return b == first ? o : b == j ? n + o : 0;
+    }
+
+    return b == j ? n + o : l;
+}
+
+constexpr std::size_t scatter_index(std::size_t s, std::size_t n, std::size_t j, std::size_t t, std::size_t k) {
+    const std::size_t c0 = j * n % s;
+    const std::size_t c = (j * n + k) % s;
+    const std::size_t l = (j * n + k) / s;
+
+    if (t == 1) {
+        return c == c0 ? l : c == (c0 + 1) % s ? n + l : 0;
+    }
+
+    return c == (c0 + t) % s ? n + l : k;
+}
+
+template <std::size_t S, std::size_t N>
+constexpr std::size_t c_shuffle_count() {
+    std::size_t count = 0;
+
+    for (std::size_t d = 0; d < S; ++ d) {
+        count += ((N - 1) * S + d) / N - d / N;
+    }
+
+    return count + S * ((N < S ? N : S) - 1);
+}
+
+/**
+ * Shuffles being about twice the cost of an insert or an extract, ties going
+ * to shuffles which leave ports free for the arithmetic.
+ */
+template <typename E, std::size_t N>
+constexpr bool c_gather_by_shuffles =
+    (sizeof(typename E::value_type) == 4 || sizeof(typename E::value_type) == 8) &&
+    sizeof(E) == E::size * sizeof(typename E::value_type) &&
+    2 * c_shuffle_count<E::size, N>() <= 2 * E::size * N;
+
+template <std::size_t S, std::size_t D, std::size_t J, typename P, std::size_t... Ls>
+P gather_step(const P& a, const P& b, std::index_sequence<Ls...>) {
+    return shuffle<gather_index(S, P::lanes, D, J, Ls)...>(a, b);
+}
+
+template <std::size_t S, std::size_t D, typename P, std::size_t... Js>
+P gather_component(const P (&blocks)[S], std::index_sequence<Js...>) {
+    constexpr std::size_t N = P::lanes;
+    constexpr std::size_t first = D / N;
+    constexpr std::size_t last = ((N - 1) * S + D) / N;
+    constexpr std::size_t second = first + 1 < last ? first + 1 : last;
+
+    P r = gather_step<S, D, first + 1>(blocks[first], blocks[second], std::make_index_sequence<N>());
+
+    ((r = gather_step<S, D, first + 2 + Js>(r, blocks[first + 2 + Js], std::make_index_sequence<N>())), ...);
+
+    return r;
+}
+
+template <std::size_t S, std::size_t J, std::size_t T, typename P, std::size_t... Ks>
+P scatter_step(const P& a, const P& b, std::index_sequence<Ks...>) {
+    return shuffle<scatter_index(S, P::lanes, J, T, Ks)...>(a, b);
+}
+
+template <std::size_t S, std::size_t J, typename P, std::size_t... Ts>
+P scatter_block(const P (&components)[S], std::index_sequence<Ts...>) {
+    constexpr std::size_t N = P::lanes;
+    constexpr std::size_t c0 = J * N % S;
+
+    P r = scatter_step<S, J, 1>(components[c0], components[(c0 + 1) % S], std::make_index_sequence<N>());
+
+    ((r = scatter_step<S, J, 2 + Ts>(r, components[(c0 + 2 + Ts) % S], std::make_index_sequence<N>())), ...);
+
+    return r;
+}
+
+/**
+ * Size of the widest vector registers of the target.
+ */
+constexpr std::size_t c_register_size =
+#if defined(__AVX512F__)
+    64;
+#elif defined(__AVX__)
+    32;
+#else
+    16;
+#endif
+
+/**
+ * Transposition of E whose size is a multiple of N, by blocks of N components :
+ * N loads (or stores) of N values, one per element, and N log2(N) shuffles,
+ * e.g. for quat or mat4x4 in 4 lanes.
+ * Only for packs held by one register, the compiler splitting shuffles of
+ * wider ones lane by lane. Packs of 128 bits interleave rows k and k + N / 2
+ * at each step, as unpcklps and unpckhps do. Wider ones swap off diagonal
+ * blocks of 1, 2, ... N / 2 lanes, the first steps staying within 128 bits
+ * (AVX unpcklpd) and the last one moving halves (vperm2f128).
+ */
+template <typename E, std::size_t N>
+constexpr bool c_transpose_by_blocks =
+    (sizeof(typename E::value_type) == 4 || sizeof(typename E::value_type) == 8) &&
+    sizeof(E) == E::size * sizeof(typename E::value_type) &&
+    E::size >= N && N * sizeof(typename E::value_type) <= c_register_size;
+
+template <typename P>
+struct rows {
+    P r[P::lanes];
+};
+
+constexpr std::size_t interleave_index(std::size_t n, bool high, std::size_t j) {
+    return (j % 2 == 0 ? 0 : n) + (high ? n / 2 : 0) + j / 2;
+}
+
+constexpr std::size_t swap_index(std::size_t n, std::size_t b, bool high, std::size_t j) {
+    return j / b % 2 == 0 ? j + (high ? b : 0) : n + j - (high ? 0 : b);
+}
+
+/**
+ * Row k after a step, B being 0 for interleaves, or the size of swapped blocks.
+ */
+template <std::size_t B, std::size_t K, typename P, std::size_t... Js>
+inline P transposed_row(const rows<P>& x, std::index_sequence<Js...>) {
+    constexpr std::size_t N = P::lanes;
+
+    if constexpr (B == 0) {
+        return shuffle<interleave_index(N, K % 2 == 1, Js)...>(x.r[K / 2], x.r[N / 2 + K / 2]);
+    }
+    else if constexpr (K / B % 2 == 0) {
+        return shuffle<swap_index(N, B, false, Js)...>(x.r[K], x.r[K + B]);
+    }
+    else {
+        return shuffle<swap_index(N, B, true, Js)...>(x.r[K - B], x.r[K]);
+    }
+}
+
+template <std::size_t B, typename P, std::size_t... Ks>
+inline rows<P> transpose_step(const rows<P>& x, std::index_sequence<Ks...>) {
+    return {{transposed_row<B, Ks>(x, std::make_index_sequence<P::lanes>())...}};
+}
+
+template <typename P>
+constexpr std::size_t c_log2_lanes = P::lanes == 2 ? 1 : P::lanes == 4 ? 2 : P::lanes == 8 ? 3 : 4;
+
+template <std::size_t S = 0, typename P>
+inline rows<P> transpose(const rows<P>& x) {
+    constexpr std::size_t B = sizeof(typename P::native_type) <= 16 ? 0 : std::size_t{1} << S;
+
+    if constexpr (S + 1 == c_log2_lanes<P>) {
+        return transpose_step<B>(x, std::make_index_sequence<P::lanes>());
+    }
+    else {
+        return transpose<S + 1>(transpose_step<B>(x, std::make_index_sequence<P::lanes>()));
+    }
+}
+
+template <typename P, typename T, std::size_t S, std::size_t... Ls>
+inline void gather_transposed(const T* values, std::size_t b, P* components, std::index_sequence<Ls...>) {
+    const rows<P> r = transpose(rows<P>{{P::load(values + Ls * S + b * P::lanes)...}});
+
+    ((components[b * P::lanes + Ls] = r.r[Ls]), ...);
+}
+
+template <typename P, typename T, std::size_t S, std::size_t... Ls>
+inline void scatter_transposed(const P* components, std::size_t b, T* values, std::index_sequence<Ls...>) {
+    const rows<P> r = transpose(rows<P>{{components[b * P::lanes + Ls]...}});
+
+    (r.r[Ls].store(values + Ls * S + b * P::lanes), ...);
+}
+
+/**
+ * Lane by lane gathers and scatters, unrolled for the compiler to use inserts
+ * and extracts.
+ */
+template <typename T, std::size_t N, typename E, std::size_t... Ls>
+pack<T, N> gather_lanes(const E* p, std::size_t d, std::index_sequence<Ls...>) {
+    return typename pack<T, N>::native_type{p[Ls].data[d]...};
+}
+
+template <typename T, std::size_t N, typename E, std::size_t... Ls>
+void scatter_lanes(const pack<T, N>& c, E* p, std::size_t d, std::index_sequence<Ls...>) {
+    ((p[Ls].data[d] = c.v[Ls]), ...);
+}
+
+template <typename W, typename E, std::size_t... Ds>
+W gather(const E* p, std::index_sequence<Ds...>) {
+    using T = typename E::value_type;
+    using P = typename W::value_type;
+
+    constexpr std::size_t S = E::size;
+    constexpr std::size_t N = P::lanes;
+
+    W w;
+
+    if constexpr (c_transpose_by_blocks<E, N>) {
+        const T* values = reinterpret_cast<const T*>(p);
+
+        for (std::size_t b = 0; b < S / N; ++ b) {
+            gather_transposed<P, T, S>(values, b, w.data, std::make_index_sequence<N>());
+        }
+
+        for (std::size_t d = S / N * N; d < S; ++ d) {
+            w.data[d] = gather_lanes<T, N>(p, d, std::make_index_sequence<N>());
+        }
+    }
+    else if constexpr (c_gather_by_shuffles<E, N>) {
+        const T* values = reinterpret_cast<const T*>(p);
+
+        const P blocks[S] = {P::load(values + Ds * N)...};
+
+        ((w.data[Ds] = gather_component<S, Ds>(blocks,
+            std::make_index_sequence<(((N - 1) * S + Ds) / N - Ds / N > 1 ? ((N - 1) * S + Ds) / N - Ds / N - 1 : 0)>())), ...);
+    }
+    else {
+        ((w.data[Ds] = gather_lanes<T, N>(p, Ds, std::make_index_sequence<N>())), ...);
+    }
+
+    return w;
+}
+
+template <typename W, typename E, std::size_t... Ds>
+void scatter(const W& w, E* p, std::index_sequence<Ds...>) {
+    using T = typename E::value_type;
+    using P = typename W::value_type;
+
+    constexpr std::size_t S = E::size;
+    constexpr std::size_t N = P::lanes;
+
+    if constexpr (c_transpose_by_blocks<E, N>) {
+        T* values = reinterpret_cast<T*>(p);
+
+        for (std::size_t b = 0; b < S / N; ++ b) {
+            scatter_transposed<P, T, S>(w.data, b, values, std::make_index_sequence<N>());
+        }
+
+        for (std::size_t d = S / N * N; d < S; ++ d) {
+            scatter_lanes(w.data[d], p, d, std::make_index_sequence<N>());
+        }
+    }
+    else if constexpr (c_gather_by_shuffles<E, N>) {
+        T* values = reinterpret_cast<T*>(p);
+
+        constexpr std::size_t m = N < S ? N : S;
+
+        (scatter_block<S, Ds>(w.data, std::make_index_sequence<(m > 2 ? m - 2 : 0)>()).store(values + Ds * N), ...);
+    }
+    else {
+        (scatter_lanes(w.data[Ds], p, Ds, std::make_index_sequence<N>()), ...);
+    }
+}
+
+} // namespace detail
+
+/**
+ * Return the wide E made of the n (at most N) consecutive elements of an AoS
+ * array starting at p, lane l being p[l]. Remaining lanes are zeroed.
+ */
+template <std::size_t N, typename E, typename = eif<is_vec<E> || is_mat<E> || is_quat<E>>>
+wide<E, N> gather(const E* p, std::size_t n = N) {
+    if (n == N) {
+        return detail::gather<wide<E, N>>(p, std::make_index_sequence<E::size>{});
+    }
+
+    wide<E, N> w{};
+
+    for (std::size_t l = 0; l < n; ++ l) {
+        for (std::size_t d = 0; d < E::size; ++ d) {
+            w.data[d].v[l] = p[l].data[d];
+        }
+    }
+
+    return w;
+}
+
+/**
+ * Store the n first lanes of w to consecutive elements of an AoS array
+ * starting at p, lane l going to p[l].
+ */
+template <typename W, typename E, typename = eif<is_vec<E> || is_mat<E> || is_quat<E>>>
+void scatter(const W& w, E* p, std::size_t n = W::value_type::lanes) {
+    constexpr std::size_t N = W::value_type::lanes;
+
+    static_assert(std::is_same<W, wide<E, N>>::value, "W must be a wide E");
+
+    if (n == N) {
+        detail::scatter(w, p, std::make_index_sequence<E::size>{});
+
+        return;
+    }
+
+    for (std::size_t l = 0; l < n; ++ l) {
+        for (std::size_t d = 0; d < E::size; ++ d) {
+            p[l].data[d] = w.data[d].v[l];
+        }
+    }
+}
+
+/**
+ * Output formatting
+ */
+template <typename T, std::size_t N>
+std::ostream& operator<<(std::ostream& output, const pack<T, N>& p) {
+    output << "pack<" << typeid(T).name() << ", " << N << "> {";
+
+    for (std::size_t l = 0; l < N; ++ l) {
+        output << p[l] << (l + 1 == N ? "}" : ", ");
+    }
+
+    return output;
+}
+
+} // namespace math
+} // namespace ee
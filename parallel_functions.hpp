@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "basis_functions.hpp"
+#include "mat.hpp"
+#include "mat_batch_functions.hpp"
+#include "thread_pool.hpp"
+#include "vec.hpp"
+
+/**
+ * Multithreaded counterparts of the bulk functions, over a thread_pool.
+ * Batches are split in chunks of about c_parallel_chunk_bytes of input and
+ * output, small enough to stay in a core private cache and numerous enough
+ * for work stealing to balance the load. Each chunk goes through the single
+ * threaded bulk function. out may be in.
+ */
+
+namespace ee {
+namespace math {
+
+namespace detail {
+
+constexpr std::size_t c_parallel_chunk_bytes = 64 * 1024;
+
+/**
+ * Elements of E per chunk, input and output included.
+ */
+template <typename E>
+constexpr std::size_t parallel_grain() {
+    return c_parallel_chunk_bytes / (2 * sizeof(E)) > 0 ? c_parallel_chunk_bytes / (2 * sizeof(E)) : 1;
+}
+
+} // namespace detail
+
+/**
+ * Transform n vectors by the linear part of lhs, over pool.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void linear_map(thread_pool& pool, const mat<T, R, C, L>& lhs, const vec<T, D>* in, vec<T, D>* out,
+    std::size_t n) {
+    pool.parallel_for(n, detail::parallel_grain<vec<T, D>>(), [&](std::size_t begin, std::size_t end) {
+        linear_map(lhs, in + begin, out + begin, end - begin);
+    });
+}
+
+/**
+ * Transform n points by the affine transformation lhs, over pool.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void affine_map(thread_pool& pool, const mat<T, R, C, L>& lhs, const vec<T, D>* in, vec<T, D>* out,
+    std::size_t n) {
+    pool.parallel_for(n, detail::parallel_grain<vec<T, D>>(), [&](std::size_t begin, std::size_t end) {
+        affine_map(lhs, in + begin, out + begin, end - begin);
+    });
+}
+
+/**
+ * Transform n points by the projective transformation lhs, over pool.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void projective_map(thread_pool& pool, const mat<T, R, C, L>& lhs, const vec<T, D>* in, vec<T, D>* out,
+    std::size_t n) {
+    pool.parallel_for(n, detail::parallel_grain<vec<T, D>>(), [&](std::size_t begin, std::size_t end) {
+        projective_map(lhs, in + begin, out + begin, end - begin);
+    });
+}
+
+/**
+ * Express n vectors, matrices or quaternions in B, over pool.
+ * Same input constraints as the single element to_basis.
+ */
+template <typename B, typename E>
+void to_basis(thread_pool& pool, const E* in, E* out, std::size_t n) {
+    pool.parallel_for(n, detail::parallel_grain<E>(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++ i) {
+            out[i] = to_basis<B>(in[i]);
+        }
+    });
+}
+
+/**
+ * Express n vectors, matrices or quaternions in basis<xpos, ypos, zpos>, over
+ * pool. Same input constraints as the single element from_basis.
+ */
+template <typename B, typename E>
+void from_basis(thread_pool& pool, const E* in, E* out, std::size_t n) {
+    pool.parallel_for(n, detail::parallel_grain<E>(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++ i) {
+            out[i] = from_basis<B>(in[i]);
+        }
+    });
+}
+
+} // namespace math
+} // namespace ee
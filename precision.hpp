@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <type_traits>
+
+namespace ee {
+namespace math {
+
+/**
+ * Precision policies, passed as last argument to functions having
+ * approximations : rsqrt, sin, cos, sincos, atan2, acos, normalize,
+ * scoords conversions and rotation builders. Errors below are for float and
+ * double alike, on top of which float adds its own rounding (a few ulp, up to
+ * 1e-6 for sin and cos near 2^16).
+ *
+ * precise : libm, as without policy.
+ *
+ * fast :
+ * - rsqrt : relative error below 5e-7.
+ * - sin, cos : absolute error below 2e-9 for |x| < 2^16.
+ * - atan2 : absolute error below 2e-8.
+ * - acos : absolute error below 3e-8.
+ *
+ * fastest :
+ * - rsqrt : relative error below 2e-3.
+ * - sin, cos : absolute error below 4e-5 for |x| < 2^16.
+ * - atan2 : absolute error below 2e-5.
+ * - acos : absolute error below 7e-5.
+ *
+ * A policy only changes code where its approximation is faster than libm
+ * (see bench/precision_report), elsewhere it runs the precise code :
+ * - sqrt and mag : same code for every policy, the square root instruction
+ *   being as fast as the approximations through rsqrt.
+ * - float sin, cos and sincos, and so the float rotation builders : fast is
+ *   precise, libm sinf and cosf (glibc) being as fast as its polynomial.
+ *   fastest changes code.
+ * - Everything else, double sin, cos and sincos included : fast and fastest
+ *   both change code.
+ *
+ * sin, cos and sincos approximations reduce their argument exactly up to
+ * |x| of about 1.03e5 (2^16 pi / 2), beyond which they call libm.
+ * Approximations are meant for finite values (in their domain for acos),
+ * signed zeros are not told apart. Constant evaluation of rsqrt gives
+ * precise results.
+ */
+struct precise {};
+struct fast {};
+struct fastest {};
+
+/**
+ * Tell if P is one of the precision policies.
+ */
+template <typename P>
+constexpr bool is_precision =
+    std::is_same<P, precise>::value ||
+    std::is_same<P, fast>::value ||
+    std::is_same<P, fastest>::value;
+
+} // namespace math
+} // namespace ee
@@ -11,6 +11,7 @@
 
 #include <ee_utils/componentwise.hpp>
 
+#include "common.hpp"
 #include "vec.hpp"
 
 namespace ee {
@@ -21,7 +22,7 @@ namespace math {
  */
 template <typename T>
 struct quat {
-    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(is_num<T>, "T must be arithmetic type or pack");
 
     using value_type      = T;
     using reference       = value_type&;
@@ -0,0 +1,398 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "quat.hpp"
+#include "quat_functions.hpp"
+#include "simd.hpp"
+
+/**
+ * Batched quaternion interpolation, for blending whole poses at once.
+ * Quaternions are either given as arrays of quat (AoS) or as four streams of
+ * x, y, z and w components (SoA). All quaternions of a batch share the same
+ * interpolation factor t. out may be one of the inputs.
+ * With EE_MATH_SIMD, quat<float> batches are processed four at a time, AoS
+ * ones being transposed in registers.
+ */
+
+namespace ee {
+namespace math {
+
+#if EE_MATH_SSE
+namespace simd {
+namespace detail {
+
+inline __m128 dot(const __m128* a, const __m128* b) {
+    __m128 r = _mm_mul_ps(a[0], b[0]);
+
+    r = madd(a[1], b[1], r);
+    r = madd(a[2], b[2], r);
+
+    return madd(a[3], b[3], r);
+}
+
+/**
+ * Flip b where its dot product with a is negative, return abs(dot(a, b)).
+ */
+inline __m128 shortest_path(const __m128* a, __m128* b) {
+    const __m128 d = dot(a, b);
+    const __m128 sign = _mm_and_ps(d, _mm_set1_ps(-0.0f));
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        b[c] = _mm_xor_ps(b[c], sign);
+    }
+
+    return _mm_xor_ps(d, sign);
+}
+
+inline __m128 slerp_weight(__m128 t, __m128 xm1) {
+    constexpr const auto& c = math::detail::c_slerp_coefficients<float>;
+
+    const __m128 t2 = _mm_mul_ps(t, t);
+
+    __m128 f = _mm_setzero_ps();
+
+    for (std::size_t i = c.size; i -- > 0;) {
+        const __m128 b = _mm_mul_ps(
+            _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(c.u[i]), t2), _mm_set1_ps(c.v[i])),
+            xm1);
+
+        f = madd(b, f, b);
+    }
+
+    return madd(t, f, t);
+}
+
+inline void nlerp(const __m128* a, const __m128* b, __m128 t, __m128* out) {
+    __m128 bs[4] = {b[0], b[1], b[2], b[3]};
+
+    shortest_path(a, bs);
+
+    const __m128 t1 = _mm_sub_ps(_mm_set1_ps(1.0f), t);
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        out[c] = madd(bs[c], t, _mm_mul_ps(a[c], t1));
+    }
+
+    const __m128 m = _mm_sqrt_ps(dot(out, out));
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        out[c] = _mm_div_ps(out[c], m);
+    }
+}
+
+/**
+ * a where m is set, b elsewhere.
+ */
+inline __m128 select(__m128 m, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+
+/**
+ * Slerp between a and b, x being their dot product, at least 0.
+ */
+inline void slerp(const __m128* a, const __m128* b, __m128 x, __m128 t, __m128* out) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 xm1 = _mm_sub_ps(x, one);
+
+    const __m128 w1 = slerp_weight(_mm_sub_ps(one, t), xm1);
+    const __m128 w2 = slerp_weight(t, xm1);
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        out[c] = madd(b[c], w2, _mm_mul_ps(a[c], w1));
+    }
+}
+
+inline void slerp(const __m128* a, const __m128* b, __m128 t, __m128* out) {
+    __m128 bs[4] = {b[0], b[1], b[2], b[3]};
+
+    slerp(a, bs, shortest_path(a, bs), t, out);
+}
+
+/**
+ * Slerp between a and b as given, along the long arc where their dot product
+ * is negative. Such lanes only go over the half of the arc t falls in, from a
+ * or to its midpoint, to keep the weights polynomial within a quarter turn.
+ */
+inline void slerp_arc(const __m128* a, const __m128* b, __m128 t, __m128* out) {
+    const __m128 d = dot(a, b);
+    const __m128 neg = _mm_cmplt_ps(d, _mm_setzero_ps());
+
+    if (! _mm_movemask_ps(neg)) {
+        slerp(a, b, d, t, out);
+
+        return;
+    }
+
+    const __m128 upper = _mm_and_ps(neg, _mm_cmpge_ps(t, _mm_set1_ps(0.5f)));
+    const __m128 lower = _mm_andnot_ps(upper, neg);
+
+    __m128 m[4], lo[4], hi[4];
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        m[c] = _mm_add_ps(a[c], b[c]);
+    }
+
+    const __m128 len = _mm_sqrt_ps(dot(m, m));
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        m[c] = _mm_div_ps(m[c], len);
+        lo[c] = select(upper, m[c], a[c]);
+        hi[c] = select(lower, m[c], b[c]);
+    }
+
+    const __m128 th = _mm_sub_ps(_mm_add_ps(t, t), _mm_and_ps(upper, _mm_set1_ps(1.0f)));
+
+    slerp(lo, hi, dot(lo, hi), select(neg, th, t), out);
+}
+
+/**
+ * Squad along the control points as given, see the scalar squad.
+ */
+inline void squad(const __m128* q1, const __m128* a, const __m128* b,
+    const __m128* q2, __m128 t, __m128* out) {
+    __m128 outer[4];
+    __m128 inner[4];
+
+    slerp_arc(q1, q2, t, outer);
+    slerp_arc(a, b, t, inner);
+
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 h = _mm_mul_ps(_mm_mul_ps(two, t), _mm_sub_ps(_mm_set1_ps(1.0f), t));
+
+    slerp_arc(outer, inner, h, out);
+}
+
+inline void load(const quat<float>* p, __m128* r) {
+    r[0] = _mm_loadu_ps(p[0].data);
+    r[1] = _mm_loadu_ps(p[1].data);
+    r[2] = _mm_loadu_ps(p[2].data);
+    r[3] = _mm_loadu_ps(p[3].data);
+
+    _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+}
+
+inline void store(__m128* r, quat<float>* p) {
+    _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+
+    _mm_storeu_ps(p[0].data, r[0]);
+    _mm_storeu_ps(p[1].data, r[1]);
+    _mm_storeu_ps(p[2].data, r[2]);
+    _mm_storeu_ps(p[3].data, r[3]);
+}
+
+inline void load(const float* const* s, std::size_t i, __m128* r) {
+    for (std::size_t c = 0; c < 4; ++ c) {
+        r[c] = _mm_loadu_ps(s[c] + i);
+    }
+}
+
+inline void store(const __m128* r, float* const* s, std::size_t i) {
+    for (std::size_t c = 0; c < 4; ++ c) {
+        _mm_storeu_ps(s[c] + i, r[c]);
+    }
+}
+
+} // namespace detail
+} // namespace simd
+#endif
+
+namespace detail {
+
+template <typename T>
+quat<T> load_quat(const T* const* s, std::size_t i) {
+    return {s[0][i], s[1][i], s[2][i], s[3][i]};
+}
+
+template <typename T>
+void store_quat(const quat<T>& q, T* const* s, std::size_t i) {
+    for (std::size_t c = 0; c < 4; ++ c) {
+        s[c][i] = q(c);
+    }
+}
+
+} // namespace detail
+
+/**
+ * Normalized linear interpolation of n quaternion pairs.
+ */
+template <typename T>
+void nlerp(const quat<T>* q1, const quat<T>* q2, T t, quat<T>* out, std::size_t n) {
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value) {
+        const __m128 t4 = _mm_set1_ps(t);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 a[4], b[4], r[4];
+
+            simd::detail::load(q1 + i, a);
+            simd::detail::load(q2 + i, b);
+            simd::detail::nlerp(a, b, t4, r);
+            simd::detail::store(r, out + i);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        out[i] = nlerp(q1[i], q2[i], t);
+    }
+}
+
+/**
+ * Normalized linear interpolation of n quaternion pairs, SoA layout.
+ */
+template <typename T>
+void nlerp(const T* const q1[4], const T* const q2[4], T t, T* const out[4], std::size_t n) {
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value) {
+        const __m128 t4 = _mm_set1_ps(t);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 a[4], b[4], r[4];
+
+            simd::detail::load(q1, i, a);
+            simd::detail::load(q2, i, b);
+            simd::detail::nlerp(a, b, t4, r);
+            simd::detail::store(r, out, i);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        detail::store_quat(nlerp(detail::load_quat(q1, i), detail::load_quat(q2, i), t), out, i);
+    }
+}
+
+/**
+ * Spherical linear interpolation of n normalized quaternion pairs.
+ */
+template <typename T>
+void slerp(const quat<T>* q1, const quat<T>* q2, T t, quat<T>* out, std::size_t n) {
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value) {
+        const __m128 t4 = _mm_set1_ps(t);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 a[4], b[4], r[4];
+
+            simd::detail::load(q1 + i, a);
+            simd::detail::load(q2 + i, b);
+            simd::detail::slerp(a, b, t4, r);
+            simd::detail::store(r, out + i);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        out[i] = slerp(q1[i], q2[i], t);
+    }
+}
+
+/**
+ * Spherical linear interpolation of n normalized quaternion pairs, SoA layout.
+ */
+template <typename T>
+void slerp(const T* const q1[4], const T* const q2[4], T t, T* const out[4], std::size_t n) {
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value) {
+        const __m128 t4 = _mm_set1_ps(t);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 a[4], b[4], r[4];
+
+            simd::detail::load(q1, i, a);
+            simd::detail::load(q2, i, b);
+            simd::detail::slerp(a, b, t4, r);
+            simd::detail::store(r, out, i);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        detail::store_quat(slerp(detail::load_quat(q1, i), detail::load_quat(q2, i), t), out, i);
+    }
+}
+
+/**
+ * Spherical quadrangle interpolation of n normalized quaternion pairs, with
+ * their inner control points a and b, all aligned to one hemisphere as for
+ * the scalar squad.
+ */
+template <typename T>
+void squad(const quat<T>* q1, const quat<T>* a, const quat<T>* b,
+    const quat<T>* q2, T t, quat<T>* out, std::size_t n) {
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value) {
+        const __m128 t4 = _mm_set1_ps(t);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 p[4], c1[4], c2[4], q[4], r[4];
+
+            simd::detail::load(q1 + i, p);
+            simd::detail::load(a + i, c1);
+            simd::detail::load(b + i, c2);
+            simd::detail::load(q2 + i, q);
+            simd::detail::squad(p, c1, c2, q, t4, r);
+            simd::detail::store(r, out + i);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        out[i] = squad(q1[i], a[i], b[i], q2[i], t);
+    }
+}
+
+/**
+ * Spherical quadrangle interpolation of n normalized quaternion pairs, with
+ * their inner control points a and b, all aligned to one hemisphere as for
+ * the scalar squad, SoA layout.
+ */
+template <typename T>
+void squad(const T* const q1[4], const T* const a[4], const T* const b[4],
+    const T* const q2[4], T t, T* const out[4], std::size_t n) {
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value) {
+        const __m128 t4 = _mm_set1_ps(t);
+
+        for (; i + 4 <= n; i += 4) {
+            __m128 p[4], c1[4], c2[4], q[4], r[4];
+
+            simd::detail::load(q1, i, p);
+            simd::detail::load(a, i, c1);
+            simd::detail::load(b, i, c2);
+            simd::detail::load(q2, i, q);
+            simd::detail::squad(p, c1, c2, q, t4, r);
+            simd::detail::store(r, out, i);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        detail::store_quat(squad(detail::load_quat(q1, i), detail::load_quat(a, i),
+            detail::load_quat(b, i), detail::load_quat(q2, i), t), out, i);
+    }
+}
+
+} // namespace math
+} // namespace ee
@@ -0,0 +1,304 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "mat.hpp"
+#include "mat_functions.hpp"
+#include "operators.hpp"
+#include "quat.hpp"
+#include "vec.hpp"
+#include "vec_functions.hpp"
+
+namespace ee {
+namespace math {
+
+/**
+ * Hamilton product, rotation q2 followed by rotation q1.
+ */
+template <typename T>
+constexpr quat<T> operator*(const quat<T>& q1, const quat<T>& q2) {
+    return {
+        q1(3) * q2(0) + q1(0) * q2(3) + q1(1) * q2(2) - q1(2) * q2(1),
+        q1(3) * q2(1) - q1(0) * q2(2) + q1(1) * q2(3) + q1(2) * q2(0),
+        q1(3) * q2(2) + q1(0) * q2(1) - q1(1) * q2(0) + q1(2) * q2(3),
+        q1(3) * q2(3) - q1(0) * q2(0) - q1(1) * q2(1) - q1(2) * q2(2)};
+}
+
+/**
+ * Hamilton product.
+ */
+template <typename T>
+constexpr const quat<T>& operator*=(quat<T>& lhs, const quat<T>& rhs) {
+    lhs = lhs * rhs;
+
+    return lhs;
+}
+
+/**
+ * Return the conjugate of q, which is also its inverse when q is normalized.
+ */
+template <typename T>
+constexpr quat<T> conjugate(const quat<T>& q) {
+    return {- q(0), - q(1), - q(2), q(3)};
+}
+
+/**
+ * Return the inverse of q, q doesn't need to be normalized.
+ */
+template <typename T>
+constexpr quat<T> inv(const quat<T>& q) {
+    return conjugate(q) / dot(q, q);
+}
+
+/**
+ * Rotate v by the normalized quaternion q.
+ * Same as q * v * conjugate(q), expanded to two cross products.
+ */
+template <typename T>
+constexpr vec<T, 3> rotate(const quat<T>& q, const vec<T, 3>& v) {
+    // t = 2 * cross(q.xyz, v)
+    const T tx = T{2L} * (q(1) * v(2) - q(2) * v(1));
+    const T ty = T{2L} * (q(2) * v(0) - q(0) * v(2));
+    const T tz = T{2L} * (q(0) * v(1) - q(1) * v(0));
+
+    // v + q.w * t + cross(q.xyz, t)
+    return {
+        v(0) + q(3) * tx + (q(1) * tz - q(2) * ty),
+        v(1) + q(3) * ty + (q(2) * tx - q(0) * tz),
+        v(2) + q(3) * tz + (q(0) * ty - q(1) * tx)};
+}
+
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation of the normalized quaternion q.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr mat<T, R, C> mat_from(const quat<T>& q) {
+    const T x2 = q(0) + q(0);
+    const T y2 = q(1) + q(1);
+    const T z2 = q(2) + q(2);
+
+    const T xx2 = q(0) * x2;
+    const T xy2 = q(0) * y2;
+    const T xz2 = q(0) * z2;
+    const T yy2 = q(1) * y2;
+    const T yz2 = q(1) * z2;
+    const T zz2 = q(2) * z2;
+    const T wx2 = q(3) * x2;
+    const T wy2 = q(3) * y2;
+    const T wz2 = q(3) * z2;
+
+    return detail::rotation_as<R, C>(mat<T, 3, 3>{
+        // X axis
+        T{1L} - yy2 - zz2,
+        xy2 + wz2,
+        xz2 - wy2,
+
+        // Y axis
+        xy2 - wz2,
+        T{1L} - xx2 - zz2,
+        yz2 + wx2,
+
+        // Z axis
+        xz2 + wy2,
+        yz2 - wx2,
+        T{1L} - xx2 - yy2});
+}
+
+/**
+ * Return the matrix describing rotation of the normalized quaternion q.
+ */
+template <typename T>
+constexpr mat<T, 4, 4> mat_from(const quat<T>& q) {
+    return mat_from<4, 4>(q);
+}
+
+/**
+ * Return the normalized quaternion describing rotation held in the upper 3x3
+ * part of m, which must be a rotation matrix.
+ * Branchless : m gives every term of the symmetric matrix k = 4 q q^T, the
+ * row of its largest diagonal term is the most accurate source for q. w is
+ * kept positive.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+quat<T> quat_from(const mat<T, R, C, L>& m) {
+    static_assert(R >= 3 && C >= 3, "matrix must be at least 3x3");
+
+    const T d0 = m(0, 0);
+    const T d1 = m(1, 1);
+    const T d2 = m(2, 2);
+
+    const T xy = m(1, 0) + m(0, 1);
+    const T xz = m(0, 2) + m(2, 0);
+    const T yz = m(2, 1) + m(1, 2);
+    const T xw = m(2, 1) - m(1, 2);
+    const T yw = m(0, 2) - m(2, 0);
+    const T zw = m(1, 0) - m(0, 1);
+
+    const T k[4][4] = {
+        {T{1L} + d0 - d1 - d2, xy, xz, xw},
+        {xy, T{1L} - d0 + d1 - d2, yz, yw},
+        {xz, yz, T{1L} - d0 - d1 + d2, zw},
+        {xw, yw, zw, T{1L} + d0 + d1 + d2}};
+
+    const std::size_t i01 = k[1][1] > k[0][0] ? 1 : 0;
+    const std::size_t i23 = k[3][3] > k[2][2] ? 3 : 2;
+    const std::size_t i = k[i23][i23] > k[i01][i01] ? i23 : i01;
+
+    const T s = std::copysign(T{0.5L} / std::sqrt(k[i][i]), k[i][3]);
+
+    return {k[i][0] * s, k[i][1] * s, k[i][2] * s, k[i][3] * s};
+}
+
+namespace detail {
+
+/**
+ * Coefficients of sin(t a) / sin(a) as a polynomial in (cos(a) - 1), from
+ * Eberly, "A Fast and Accurate Algorithm for Computing SLERP". 16 terms, the
+ * last one scaled by one_plus_mu to spread the truncation error, max error is
+ * 3.1e-8 for a in [0, pi / 2] and t in [0, 1].
+ */
+template <typename T>
+struct slerp_coefficients {
+    constexpr static std::size_t size = 16;
+    constexpr static long double one_plus_mu = 1.91666805791355840L;
+
+    T u[size];
+    T v[size];
+};
+
+template <typename T>
+constexpr slerp_coefficients<T> make_slerp_coefficients() {
+    using sc = slerp_coefficients<T>;
+
+    sc c{};
+
+    for (std::size_t i = 0; i < sc::size; ++ i) {
+        const long double n = i + 1;
+        const long double scale = i + 1 == sc::size ? sc::one_plus_mu : 1.0L;
+
+        c.u[i] = static_cast<T>(scale / (n * (2.0L * n + 1.0L)));
+        c.v[i] = static_cast<T>(scale * n / (2.0L * n + 1.0L));
+    }
+
+    return c;
+}
+
+template <typename T>
+constexpr slerp_coefficients<T> c_slerp_coefficients = make_slerp_coefficients<T>();
+
+/**
+ * Return sin(t a) / sin(a), xm1 being cos(a) - 1.
+ */
+template <typename T>
+constexpr T slerp_weight(T t, T xm1) {
+    constexpr const auto& c = c_slerp_coefficients<T>;
+
+    const T t2 = t * t;
+
+    T f{};
+
+    for (std::size_t i = c.size; i -- > 0;) {
+        f = (c.u[i] * t2 - c.v[i]) * xm1 * (T{1L} + f);
+    }
+
+    return t * (T{1L} + f);
+}
+
+} // namespace detail
+
+/**
+ * Normalized linear interpolation between q1 and q2, along the shortest path.
+ */
+template <typename T>
+quat<T> nlerp(const quat<T>& q1, const quat<T>& q2, T t) {
+    const T t2 = dot(q1, q2) < T{0L} ? - t : t;
+
+    return normalize(q1 * (T{1L} - t) + q2 * t2);
+}
+
+namespace detail {
+
+/**
+ * Spherical linear interpolation between normalized q1 and q2 * s, x being
+ * dot(q1, q2) * s.
+ */
+template <typename T>
+quat<T> slerp(const quat<T>& q1, const quat<T>& q2, T t, T x, T s) {
+    if constexpr (std::is_same<T, float>::value) {
+        // The polynomial only holds up to a quarter turn.
+        if (x >= T{0L}) {
+            const T w1 = slerp_weight(T{1L} - t, x - T{1L});
+            const T w2 = slerp_weight(t, x - T{1L}) * s;
+
+            return q1 * w1 + q2 * w2;
+        }
+    }
+
+    // Nearly identical rotations, sin(a) would vanish.
+    if (x > T{1L} - T{1e-6L}) {
+        return normalize(q1 * (T{1L} - t) + q2 * (t * s));
+    }
+
+    const T a = std::acos(x);
+    const T inv_sin_a = T{1L} / std::sin(a);
+
+    const T w1 = std::sin((T{1L} - t) * a) * inv_sin_a;
+    const T w2 = std::sin(t * a) * inv_sin_a * s;
+
+    return q1 * w1 + q2 * w2;
+}
+
+/**
+ * Spherical linear interpolation between normalized q1 and q2 as given,
+ * along the long arc when their dot product is negative. Unlike the shortest
+ * path one, it is continuous as q1 and q2 move.
+ */
+template <typename T>
+quat<T> slerp_arc(const quat<T>& q1, const quat<T>& q2, T t) {
+    return slerp(q1, q2, t, dot(q1, q2), T{1L});
+}
+
+} // namespace detail
+
+/**
+ * Spherical linear interpolation between normalized q1 and q2, along the
+ * shortest path.
+ * For float, weights come from a polynomial instead of acos and sin, accurate
+ * to float precision. Other types use acos and sin.
+ */
+template <typename T>
+quat<T> slerp(const quat<T>& q1, const quat<T>& q2, T t) {
+    const T d = dot(q1, q2);
+    const T s = d < T{0L} ? T{-1L} : T{1L};
+
+    return detail::slerp(q1, q2, t, d * s, s);
+}
+
+/**
+ * Spherical quadrangle interpolation between q1 and q2, using a and b as
+ * inner control points.
+ * The three interpolations follow the control points as given, never the
+ * shortest path, else the curve would jump where one of them switches arc.
+ * Align the keys to one hemisphere once beforehand (negate each key whose dot
+ * product with the previous one is negative), then compute a and b from the
+ * aligned keys.
+ */
+template <typename T>
+quat<T> squad(const quat<T>& q1, const quat<T>& a, const quat<T>& b,
+    const quat<T>& q2, T t) {
+    return detail::slerp_arc(detail::slerp_arc(q1, q2, t), detail::slerp_arc(a, b, t),
+        T{2L} * t * (T{1L} - t));
+}
+
+} // namespace math
+} // namespace ee
@@ -8,12 +8,16 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 
 #include "scoords.hpp"
 
 #include "basis_functions.hpp"
 #include "constants.hpp"
+#include "mat.hpp"
+#include "mat_functions.hpp"
 #include "vec.hpp"
+#include "vec_functions.hpp"
 #include "quat.hpp"
 
 namespace ee {
@@ -22,12 +26,14 @@ namespace math {
 /**
  * Return unit vector pointing in same direction than input.
  */
-template <typename T, typename B>
-vec<T, 3> vec_from(const scoords_usphere<T, B>& scu) {
-    const T cos_theta = std::cos(scu.theta);
-    const T sin_theta = std::sin(scu.theta);
-    const T cos_phi   = std::cos(scu.phi);
-    const T sin_phi   = std::sin(scu.phi);
+template <typename T, typename B, typename P = precise>
+constexpr vec<T, 3> vec_from(const scoords_usphere<T, B>& scu, P p = {}) {
+    const sin_cos<vec<T, 2>> sc = sincos(vec<T, 2>{scu.theta, scu.phi}, p);
+
+    const T cos_theta = sc.cos(0);
+    const T sin_theta = sc.sin(0);
+    const T cos_phi   = sc.cos(1);
+    const T sin_phi   = sc.sin(1);
 
     return from_basis<B>(
         vec<T, 3>{cos_theta * sin_phi, sin_theta * sin_phi, cos_phi});
@@ -36,26 +42,27 @@ vec<T, 3> vec_from(const scoords_usphere<T, B>& scu) {
 /**
  * Return cartesian coordinates from spherical coordinates.
  */
-template <typename T, typename B>
-vec<T, 3> vec_from(const scoords<T, B>& sc) {
-    return sc.r * vec_from(sc.usphere);
+template <typename T, typename B, typename P = precise>
+constexpr vec<T, 3> vec_from(const scoords<T, B>& sc, P p = {}) {
+    return sc.r * vec_from(sc.usphere, p);
 }
 
 /**
  * Return the quaternion describing rotation required to transform scu's
  * azimuth reference into scu's direction vector.
  */
-template <typename T, typename B>
-quat<T> quat_from(const scoords_usphere<T, B>& scu) {
-    const T     t = T{0.5L} * scu.theta;
-    const T cos_t = std::cos(t);
-    const T sin_t = std::sin(t);
-
+template <typename T, typename B, typename P = precise>
+constexpr quat<T> quat_from(const scoords_usphere<T, B>& scu, P p = {}) {
     // Phi is angle from zenith CCW, we are not at zenith but on reference plane
     // so we need Pi/2 - Phi, but we will have to rotate CW so Phi - Pi/2
-    const T     p = T{0.5L} * (scu.phi - c_half_pi<T>);
-    const T cos_p = std::cos(p);
-    const T sin_p = std::sin(p);
+    const sin_cos<vec<T, 2>> sc = sincos(vec<T, 2>{
+        T{0.5L} * scu.theta,
+        T{0.5L} * (scu.phi - c_half_pi<T>)}, p);
+
+    const T cos_t = sc.cos(0);
+    const T sin_t = sc.sin(0);
+    const T cos_p = sc.cos(1);
+    const T sin_p = sc.sin(1);
 
     return from_basis<B>(quat<T>{
         - sin_t * sin_p,
@@ -64,32 +71,41 @@ quat<T> quat_from(const scoords_usphere<T, B>& scu) {
           cos_t * cos_p});
 }
 
+/**
+ * Return the transformation matrix (mat3x3, mat3x4 or mat4x4) describing
+ * rotation required to transform scu's azimuth reference into scu's
+ * direction vector.
+ */
+template <std::size_t R, std::size_t C, typename T, typename B, typename P = precise>
+constexpr mat<T, R, C> mat_from(const scoords_usphere<T, B>& scu, P p = {}) {
+    const sin_cos<vec<T, 2>> sc = sincos(vec<T, 2>{scu.theta, scu.phi - c_half_pi<T>}, p);
+
+    const T cos_t = sc.cos(0);
+    const T sin_t = sc.sin(0);
+    const T cos_p = sc.cos(1);
+    const T sin_p = sc.sin(1);
+
+    return detail::rotation_as<R, C>(from_basis<B>(mat<T, 3, 3>{
+        cos_t * cos_p, sin_t * cos_p, - sin_p,
+          - sin_t    ,     cos_t    ,   T{0L},
+        cos_t * sin_p, sin_t * sin_p,   cos_p}));
+}
+
 /**
  * Return the matrix describing rotation required to transform scu's
  * azimuth reference into scu's direction vector.
  */
-template <typename T, typename B>
-mat<T, 4, 4> mat_from(const scoords_usphere<T, B>& scu) {
-    const T cos_t = std::cos(scu.theta);
-    const T sin_t = std::sin(scu.theta);
-
-    const T p = scu.phi - c_half_pi<T>;
-    const T cos_p = std::cos(p);
-    const T sin_p = std::sin(p);
-
-    return from_basis<B>(mat<T, 4, 4>{
-        cos_t * cos_p, sin_t * cos_p, - sin_p, T{0L},
-          - sin_t    ,     cos_t    ,   T{0L}, T{0L},
-        cos_t * sin_p, sin_t * sin_p,   cos_p, T{0L},
-            T{0L}    ,     T{0L}    ,   T{0L}, T{1L}});
+template <typename T, typename B, typename P = precise>
+constexpr mat<T, 4, 4> mat_from(const scoords_usphere<T, B>& scu, P p = {}) {
+    return mat_from<4, 4>(scu, p);
 }
 
 namespace detail {
 
-template <typename B, typename T>
-scoords_usphere<T, B> scoords_usphere_from(const vec<T, 3>& p) {
-    const T theta = std::atan2(p.y, p.x);
-    const T phi   = std::acos(p.z);
+template <typename B, typename T, typename P>
+constexpr scoords_usphere<T, B> scoords_usphere_from(const vec<T, 3>& p, P precision) {
+    const T theta = atan2(p(1), p(0), precision);
+    const T phi   = acos(p(2), precision);
 
     return {theta, phi};
 }
@@ -100,26 +116,26 @@ scoords_usphere<T, B> scoords_usphere_from(const vec<T, 3>& p) {
  * Return scoords_usphere from any cartesian coordinates of the unit sphere.
  * Input vector must be normalized.
  */
-template <typename B = initial_basis, typename T>
-scoords_usphere<T, B> scoords_usphere_from(const vec<T, 3>& xyz) {
+template <typename B = initial_basis, typename T, typename P = precise>
+constexpr scoords_usphere<T, B> scoords_usphere_from(const vec<T, 3>& xyz, P precision = {}) {
     const vec<T, 3> p = to_basis<B>(xyz);
 
-    return detail::scoords_usphere_from<B>(p);
+    return detail::scoords_usphere_from<B>(p, precision);
 }
 
 /**
  * Return scoords from cartesian coordinates.
  */
-template <typename B = initial_basis, typename T>
-scoords<T, B> scoords_from(const vec<T, 3>& xyz) {
+template <typename B = initial_basis, typename T, typename P = precise>
+constexpr scoords<T, B> scoords_from(const vec<T, 3>& xyz, P precision = {}) {
     const vec<T, 3> p = to_basis<B>(xyz);
 
-    const T m = mag(p);
+    const T m = mag(p, precision);
 
     // we only divide z since x/y is equal to (x/l)/(z/l) so atan2 gives same
     // result anyway.
     const scoords_usphere<T, B> scu =
-        detail::scoords_usphere_from<B>(vec<T, 3>{p.x, p.y, p.z / m});
+        detail::scoords_usphere_from<B>(vec<T, 3>{p(0), p(1), p(2) / m}, precision);
 
     return {m, scu};
 }
@@ -0,0 +1,1058 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <ee_utils/componentwise.hpp>
+#include <ee_utils/templates.hpp>
+
+#include "common.hpp"
+#include "functions.hpp"
+#include "vec.hpp"
+#include "mat.hpp"
+#include "quat.hpp"
+
+/**
+ * Opt-in SIMD backend.
+ * Define EE_MATH_SIMD to 1 (before including any ee_math header or from the
+ * build system) to make vec<float, 4>, vec<std::int32_t, 4> and quat<float>
+ * use SSE registers for componentwise operators, comparison, dot and mag2.
+ * Building with AVX enabled only changes instruction encoding (VEX), these
+ * types fit in a single 128 bits register anyway.
+ *
+ * mat<float, 4, 4> and mat<double, 4, 4> products (matrix-matrix and
+ * matrix-vector) also get a register-blocked kernel, using AVX for double
+ * when available and FMA when available. With FMA, products are not rounded
+ * before accumulation so results may differ from the generic loop by an ulp.
+ *
+ * Storage is left untouched (no alignment requirement, unions and member
+ * aliases as before), values are loaded and stored unaligned.
+ * Results are bit-identical to the scalar path : same operations, in the same
+ * order, lane by lane.
+ */
+#ifndef EE_MATH_SIMD
+#define EE_MATH_SIMD 0
+#endif
+
+#if EE_MATH_SIMD && (defined(__SSE2__) || defined(_M_X64))
+#define EE_MATH_SSE 1
+#include <immintrin.h>
+#else
+#define EE_MATH_SSE 0
+#endif
+
+namespace ee {
+namespace math {
+namespace simd {
+
+using tutil::eif;
+
+namespace detail {
+
+template <typename T>
+constexpr bool is_f32x4 =
+    std::is_same<std::decay_t<T>, vec<float, 4>>::value ||
+    std::is_same<std::decay_t<T>, quat<float>>::value;
+
+template <typename T>
+constexpr bool is_i32x4 =
+    std::is_same<std::decay_t<T>, vec<std::int32_t, 4>>::value;
+
+} // namespace detail
+
+/**
+ * Tell if T is handled by a single native register.
+ */
+template <typename T>
+constexpr bool is_native = EE_MATH_SSE && (detail::is_f32x4<T> || detail::is_i32x4<T>);
+
+/**
+ * Native equality, dot product and squared magnitude.
+ * Only defined when is_native<V> is true.
+ */
+template <typename V>
+bool equal(const V& lhs, const V& rhs);
+
+template <typename V>
+typename V::value_type dot(const V& lhs, const V& rhs);
+
+/**
+ * Tell if M is a 4x4 matrix with native product kernels, in either layout.
+ */
+template <typename M>
+constexpr bool is_native_mat4 = EE_MATH_SSE && (
+    std::is_same<std::decay_t<M>, mat<float, 4, 4, column_major>>::value ||
+    std::is_same<std::decay_t<M>, mat<double, 4, 4, column_major>>::value ||
+    std::is_same<std::decay_t<M>, mat<float, 4, 4, row_major>>::value ||
+    std::is_same<std::decay_t<M>, mat<double, 4, 4, row_major>>::value);
+
+/**
+ * Native signed swizzle of a float V : lane n of the result is lane In of v,
+ * negated when Sn is negative. A single shuffle and, when a sign changes, a
+ * single sign mask xor.
+ * Only defined when is_native<V> is true.
+ */
+template <int I0, int I1, int I2, int I3, int S0, int S1, int S2, int S3, typename V>
+V swizzle(const V& v);
+
+/**
+ * Native signed swizzle of both rows and columns of a mat<float, 4, 4> :
+ * result(r, c) is m(Ir, Ic), negated when Sr and Sc differ. Being the same
+ * on rows and columns, it works on storage blocks of either layout : one
+ * shuffle and one sign mask xor per block.
+ * Only defined when is_native_mat4<mat<float, 4, 4, L>> is true.
+ */
+template <int I0, int I1, int I2, int I3, int S0, int S1, int S2, int S3, typename L>
+mat<float, 4, 4, L> swizzle(const mat<float, 4, 4, L>& m);
+
+/**
+ * Native 4x4 matrix-matrix and matrix-vector products.
+ * Only defined when is_native_mat4<mat<T, 4, 4, L>> is true.
+ */
+template <typename T, typename L>
+mat<T, 4, 4, L> product(const mat<T, 4, 4, L>& lhs, const mat<T, 4, 4, L>& rhs);
+
+template <typename T, typename L>
+vec<T, 4> product(const mat<T, 4, 4, L>& lhs, const vec<T, 4>& rhs);
+
+/**
+ * Native mat<float, 4, 4> inverse.
+ * Same contract as detail::inv in mat_functions.hpp : determinant is stored
+ * in d, returns false leaving result untouched when it is zero.
+ */
+bool inv(const mat<float, 4, 4>& M, mat<float, 4, 4>* result, float* d);
+
+/**
+ * Native sine and cosine of all components of v, for D up to 4.
+ * Components are computed in double lanes (one AVX register, or two SSE2
+ * ones) sharing a single argument reduction and polynomial evaluation. Double
+ * results are within 1 ulp of the correctly rounded ones, float ones are
+ * correctly rounded but for rare double rounding cases. Returns false,
+ * leaving s and c untouched, when a component is not finite or not below
+ * c_sincos_max.
+ */
+template <typename T, std::size_t D>
+bool sincos(const vec<T, D>& v, vec<T, D>* s, vec<T, D>* c);
+
+/**
+ * Largest magnitude handled by simd::sincos, 2^19 pi / 2, so that reduction
+ * products are exact.
+ */
+constexpr double c_sincos_max = 823549.6595376281;
+
+#if EE_MATH_SSE
+
+namespace detail {
+
+inline __m128 load(const float* p) {
+    return _mm_loadu_ps(p);
+}
+
+inline __m128i load(const std::int32_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+template <typename V>
+inline V store(__m128 r) {
+    V v;
+    _mm_storeu_ps(v.data, r);
+
+    return v;
+}
+
+template <typename V>
+inline V store(__m128i r) {
+    V v;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(v.data), r);
+
+    return v;
+}
+
+} // namespace detail
+
+#if defined(__SSE4_1__)
+constexpr bool has_mullo_epi32 = true;
+#else
+constexpr bool has_mullo_epi32 = false;
+#endif
+
+#if defined(__AVX__)
+constexpr bool has_avx = true;
+#else
+constexpr bool has_avx = false;
+#endif
+
+/**
+ * Native componentwise operations, one overload per functor.
+ * Scalar operands must exactly be the value type, any other type goes through
+ * the generic path which may promote the result.
+ */
+template <typename V, typename = eif<is_native<V>>>
+inline V native(decltype(add), const V& lhs, const V& rhs) {
+    if constexpr (detail::is_f32x4<V>) {
+        return detail::store<V>(_mm_add_ps(detail::load(lhs.data), detail::load(rhs.data)));
+    }
+    else {
+        return detail::store<V>(_mm_add_epi32(detail::load(lhs.data), detail::load(rhs.data)));
+    }
+}
+
+template <typename V, typename = eif<is_native<V>>>
+inline V native(decltype(sub), const V& lhs, const V& rhs) {
+    if constexpr (detail::is_f32x4<V>) {
+        return detail::store<V>(_mm_sub_ps(detail::load(lhs.data), detail::load(rhs.data)));
+    }
+    else {
+        return detail::store<V>(_mm_sub_epi32(detail::load(lhs.data), detail::load(rhs.data)));
+    }
+}
+
+template <typename V, typename = eif<is_native<V>>>
+inline V native(decltype(opp), const V& rhs) {
+    if constexpr (detail::is_f32x4<V>) {
+        // Negation only flips the sign bit, as scalar negation does.
+        return detail::store<V>(_mm_xor_ps(detail::load(rhs.data), _mm_set1_ps(- 0.0f)));
+    }
+    else {
+        return detail::store<V>(_mm_sub_epi32(_mm_setzero_si128(), detail::load(rhs.data)));
+    }
+}
+
+template <typename V, typename S, typename = eif<
+    (detail::is_f32x4<V> && std::is_same<S, float>::value) ||
+    (detail::is_i32x4<V> && std::is_same<S, std::int32_t>::value && has_mullo_epi32)>>
+inline V native(decltype(mul), const V& lhs, const S& rhs) {
+    if constexpr (detail::is_f32x4<V>) {
+        return detail::store<V>(_mm_mul_ps(detail::load(lhs.data), _mm_set1_ps(rhs)));
+    }
+    else {
+#if defined(__SSE4_1__)
+        return detail::store<V>(_mm_mullo_epi32(detail::load(lhs.data), _mm_set1_epi32(rhs)));
+#endif
+    }
+}
+
+template <typename S, typename V, typename = eif<is_native<V> && is_num<S>>>
+inline auto native(decltype(mul), const S& lhs, const V& rhs) -> decltype(native(mul, rhs, lhs)) {
+    // Scalar multiplication commutes exactly.
+    return native(mul, rhs, lhs);
+}
+
+template <typename V, typename S, typename = eif<detail::is_f32x4<V> && std::is_same<S, float>::value>>
+inline V native(decltype(div), const V& lhs, const S& rhs) {
+    return detail::store<V>(_mm_div_ps(detail::load(lhs.data), _mm_set1_ps(rhs)));
+}
+
+template <typename V, typename S, typename = eif<detail::is_i32x4<V> && std::is_same<S, std::int32_t>::value>>
+inline V native(decltype(lshift), const V& lhs, const S& rhs) {
+    return detail::store<V>(_mm_sll_epi32(detail::load(lhs.data), _mm_cvtsi32_si128(rhs)));
+}
+
+template <typename V, typename S, typename = eif<detail::is_i32x4<V> && std::is_same<S, std::int32_t>::value>>
+inline V native(decltype(rshift), const V& lhs, const S& rhs) {
+    return detail::store<V>(_mm_sra_epi32(detail::load(lhs.data), _mm_cvtsi32_si128(rhs)));
+}
+
+template <typename V>
+inline bool equal(const V& lhs, const V& rhs) {
+    static_assert(is_native<V>, "V must be a native type");
+
+    if constexpr (detail::is_f32x4<V>) {
+        return _mm_movemask_ps(
+            _mm_cmpeq_ps(detail::load(lhs.data), detail::load(rhs.data))) == 0xF;
+    }
+    else {
+        return _mm_movemask_epi8(
+            _mm_cmpeq_epi32(detail::load(lhs.data), detail::load(rhs.data))) == 0xFFFF;
+    }
+}
+
+template <typename V>
+inline typename V::value_type dot(const V& lhs, const V& rhs) {
+    static_assert(is_native<V>, "V must be a native type");
+
+    if constexpr (detail::is_f32x4<V>) {
+        const __m128 p = _mm_mul_ps(detail::load(lhs.data), detail::load(rhs.data));
+
+        // Sum lanes in the same order as the scalar loop does, starting from
+        // a positive zero, so that rounding (and the sign of zero) match.
+        __m128 s = _mm_add_ss(_mm_setzero_ps(), p);
+        s = _mm_add_ss(s, _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1)));
+        s = _mm_add_ss(s, _mm_movehl_ps(p, p));
+        s = _mm_add_ss(s, _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3)));
+
+        return _mm_cvtss_f32(s);
+    }
+    else {
+#if defined(__SSE4_1__)
+        const __m128i p = _mm_mullo_epi32(detail::load(lhs.data), detail::load(rhs.data));
+
+        // Integer wrap-around addition is associative, any order will do.
+        __m128i s = _mm_add_epi32(p, _mm_shuffle_epi32(p, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        return _mm_cvtsi128_si32(s);
+#else
+        typename V::value_type r{};
+
+        for (std::size_t i = 0; i < V::size; ++ i) {
+            r += lhs.data[i] * rhs.data[i];
+        }
+
+        return r;
+#endif
+    }
+}
+
+namespace detail {
+
+inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+/**
+ * 4 vec<float, 3> to x, y and z registers, and back.
+ */
+inline void deinterleave3(const float* p, __m128* x, __m128* y, __m128* z) {
+    const __m128 a = _mm_loadu_ps(p);
+    const __m128 b = _mm_loadu_ps(p + 4);
+    const __m128 c = _mm_loadu_ps(p + 8);
+
+    *x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    *y = _mm_shuffle_ps(
+        _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+        _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    *z = _mm_shuffle_ps(
+        _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+        _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+inline void interleave3(__m128 x, __m128 y, __m128 z, float* p) {
+    const __m128 xy01 = _mm_unpacklo_ps(x, y);
+    const __m128 xy23 = _mm_unpackhi_ps(x, y);
+
+    const __m128 a = _mm_shuffle_ps(xy01, _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+    const __m128 b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), xy23, _MM_SHUFFLE(1, 0, 2, 0));
+    const __m128 c = _mm_shuffle_ps(
+        _mm_shuffle_ps(z, xy23, _MM_SHUFFLE(2, 2, 2, 2)),
+        _mm_shuffle_ps(xy23, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+    _mm_storeu_ps(p, a);
+    _mm_storeu_ps(p + 4, b);
+    _mm_storeu_ps(p + 8, c);
+}
+
+#if defined(__AVX__)
+inline __m256d madd(__m256d a, __m256d b, __m256d c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+
+inline __m256 madd(__m256 a, __m256 b, __m256 c) {
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+/**
+ * 8 vec<float, 3> to x, y and z registers, and back. Same shuffles as the 4
+ * wide versions, points 0 to 3 in the low lane and 4 to 7 in the high one.
+ */
+inline __m256 load2(const float* lo, const float* hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+inline void store2(__m256 r, float* lo, float* hi) {
+    _mm_storeu_ps(lo, _mm256_castps256_ps128(r));
+    _mm_storeu_ps(hi, _mm256_extractf128_ps(r, 1));
+}
+
+inline void deinterleave3(const float* p, __m256* x, __m256* y, __m256* z) {
+    const __m256 a = load2(p, p + 12);
+    const __m256 b = load2(p + 4, p + 16);
+    const __m256 c = load2(p + 8, p + 20);
+
+    *x = _mm256_shuffle_ps(a, _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+    *y = _mm256_shuffle_ps(
+        _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+        _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    *z = _mm256_shuffle_ps(
+        _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+        _mm256_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+inline void interleave3(__m256 x, __m256 y, __m256 z, float* p) {
+    const __m256 xy01 = _mm256_unpacklo_ps(x, y);
+    const __m256 xy23 = _mm256_unpackhi_ps(x, y);
+
+    const __m256 a = _mm256_shuffle_ps(xy01, _mm256_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0));
+    const __m256 b = _mm256_shuffle_ps(_mm256_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), xy23, _MM_SHUFFLE(1, 0, 2, 0));
+    const __m256 c = _mm256_shuffle_ps(
+        _mm256_shuffle_ps(z, xy23, _MM_SHUFFLE(2, 2, 2, 2)),
+        _mm256_shuffle_ps(xy23, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+    store2(a, p, p + 12);
+    store2(b, p + 4, p + 16);
+    store2(c, p + 8, p + 20);
+}
+#endif
+
+/**
+ * Register-blocked 4x4 product kernel.
+ * Computes N blocks of 4 values as out[n] = p[0] * q[n][0] + ... + p[3] *
+ * q[n][3], with p[i] and out[n] blocks of 4 consecutive values and q[n][i]
+ * scalars broadcasted. The 4 p blocks stay in registers for the whole product.
+ *
+ * Column-major : p are lhs columns, q[n] is rhs column n.
+ * Row-major    : p are rhs rows, q[n] is lhs row n.
+ */
+template <std::size_t N>
+inline void mul4(const float* p, const float* q, float* out) {
+    const __m128 p0 = _mm_loadu_ps(p);
+    const __m128 p1 = _mm_loadu_ps(p + 4);
+    const __m128 p2 = _mm_loadu_ps(p + 8);
+    const __m128 p3 = _mm_loadu_ps(p + 12);
+
+    for (std::size_t n = 0; n < N; ++ n) {
+        const float* qn = q + 4 * n;
+
+        __m128 r = _mm_mul_ps(p0, _mm_set1_ps(qn[0]));
+        r = madd(p1, _mm_set1_ps(qn[1]), r);
+        r = madd(p2, _mm_set1_ps(qn[2]), r);
+        r = madd(p3, _mm_set1_ps(qn[3]), r);
+
+        _mm_storeu_ps(out + 4 * n, r);
+    }
+}
+
+template <std::size_t N>
+inline void mul4(const double* p, const double* q, double* out) {
+#if defined(__AVX__)
+    const __m256d p0 = _mm256_loadu_pd(p);
+    const __m256d p1 = _mm256_loadu_pd(p + 4);
+    const __m256d p2 = _mm256_loadu_pd(p + 8);
+    const __m256d p3 = _mm256_loadu_pd(p + 12);
+
+    for (std::size_t n = 0; n < N; ++ n) {
+        const double* qn = q + 4 * n;
+
+        __m256d r = _mm256_mul_pd(p0, _mm256_set1_pd(qn[0]));
+        r = madd(p1, _mm256_set1_pd(qn[1]), r);
+        r = madd(p2, _mm256_set1_pd(qn[2]), r);
+        r = madd(p3, _mm256_set1_pd(qn[3]), r);
+
+        _mm256_storeu_pd(out + 4 * n, r);
+    }
+#else
+    // Two SSE2 registers per block.
+    for (std::size_t n = 0; n < N; ++ n) {
+        const double* qn = q + 4 * n;
+
+        __m128d lo = _mm_setzero_pd();
+        __m128d hi = _mm_setzero_pd();
+
+        for (std::size_t i = 0; i < 4; ++ i) {
+            const __m128d b = _mm_set1_pd(qn[i]);
+
+            lo = _mm_add_pd(lo, _mm_mul_pd(_mm_loadu_pd(p + 4 * i), b));
+            hi = _mm_add_pd(hi, _mm_mul_pd(_mm_loadu_pd(p + 4 * i + 2), b));
+        }
+
+        _mm_storeu_pd(out + 4 * n, lo);
+        _mm_storeu_pd(out + 4 * n + 2, hi);
+    }
+#endif
+}
+
+/**
+ * Four dot products of 4 values : out[r] = p[r] ∙ q, with p[r] blocks of 4
+ * consecutive values (row-major rows). Products are summed horizontally by
+ * transposing pairs, without going through memory.
+ */
+inline void dot4_rows(const float* p, const float* q, float* out) {
+    const __m128 v = _mm_loadu_ps(q);
+
+    const __m128 m0 = _mm_mul_ps(_mm_loadu_ps(p), v);
+    const __m128 m1 = _mm_mul_ps(_mm_loadu_ps(p + 4), v);
+    const __m128 m2 = _mm_mul_ps(_mm_loadu_ps(p + 8), v);
+    const __m128 m3 = _mm_mul_ps(_mm_loadu_ps(p + 12), v);
+
+    // (m0₀ + m0₂, m1₀ + m1₂, m0₁ + m0₃, m1₁ + m1₃), same with m2 and m3.
+    const __m128 a = _mm_add_ps(_mm_unpacklo_ps(m0, m1), _mm_unpackhi_ps(m0, m1));
+    const __m128 b = _mm_add_ps(_mm_unpacklo_ps(m2, m3), _mm_unpackhi_ps(m2, m3));
+
+    _mm_storeu_ps(out, _mm_add_ps(_mm_movelh_ps(a, b), _mm_movehl_ps(b, a)));
+}
+
+inline void dot4_rows(const double* p, const double* q, double* out) {
+#if defined(__AVX__)
+    const __m256d v = _mm256_loadu_pd(q);
+
+    const __m256d m0 = _mm256_mul_pd(_mm256_loadu_pd(p), v);
+    const __m256d m1 = _mm256_mul_pd(_mm256_loadu_pd(p + 4), v);
+    const __m256d m2 = _mm256_mul_pd(_mm256_loadu_pd(p + 8), v);
+    const __m256d m3 = _mm256_mul_pd(_mm256_loadu_pd(p + 12), v);
+
+    // (m0₀ + m0₁, m1₀ + m1₁, m0₂ + m0₃, m1₂ + m1₃), same with m2 and m3.
+    const __m256d a = _mm256_add_pd(_mm256_unpacklo_pd(m0, m1), _mm256_unpackhi_pd(m0, m1));
+    const __m256d b = _mm256_add_pd(_mm256_unpacklo_pd(m2, m3), _mm256_unpackhi_pd(m2, m3));
+
+    _mm256_storeu_pd(out, _mm256_add_pd(
+        _mm256_permute2f128_pd(a, b, 0x20),
+        _mm256_permute2f128_pd(a, b, 0x31)));
+#else
+    // Two SSE2 registers per row, then pairs summed.
+    const __m128d lo = _mm_loadu_pd(q);
+    const __m128d hi = _mm_loadu_pd(q + 2);
+
+    __m128d m[4];
+
+    for (std::size_t r = 0; r < 4; ++ r) {
+        m[r] = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(p + 4 * r), lo), _mm_mul_pd(_mm_loadu_pd(p + 4 * r + 2), hi));
+    }
+
+    _mm_storeu_pd(out, _mm_add_pd(_mm_unpacklo_pd(m[0], m[1]), _mm_unpackhi_pd(m[0], m[1])));
+    _mm_storeu_pd(out + 2, _mm_add_pd(_mm_unpacklo_pd(m[2], m[3]), _mm_unpackhi_pd(m[2], m[3])));
+#endif
+}
+
+} // namespace detail
+
+template <typename T, typename L>
+inline mat<T, 4, 4, L> product(const mat<T, 4, 4, L>& lhs, const mat<T, 4, 4, L>& rhs) {
+    static_assert(is_native_mat4<mat<T, 4, 4, L>>, "T must be float or double");
+
+    mat<T, 4, 4, L> result;
+
+    if constexpr (std::is_same<L, column_major>::value) {
+        detail::mul4<4>(lhs.data, rhs.data, result.data);
+    }
+    else {
+        // Row-major data is the column-major transpose : (lhs rhs)ᵀ = rhsᵀ lhsᵀ.
+        detail::mul4<4>(rhs.data, lhs.data, result.data);
+    }
+
+    return result;
+}
+
+template <typename T, typename L>
+inline vec<T, 4> product(const mat<T, 4, 4, L>& lhs, const vec<T, 4>& rhs) {
+    static_assert(is_native_mat4<mat<T, 4, 4, L>>, "T must be float or double");
+
+    vec<T, 4> result;
+
+    if constexpr (std::is_same<L, column_major>::value) {
+        detail::mul4<1>(lhs.data, rhs.data, result.data);
+    }
+    else {
+        detail::dot4_rows(lhs.data, rhs.data, result.data);
+    }
+
+    return result;
+}
+
+namespace detail {
+
+template <int X, int Y, int Z, int W>
+inline __m128 swizzle(__m128 v) {
+    return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), _MM_SHUFFLE(W, Z, Y, X)));
+}
+
+template <int X, int Y, int Z, int W>
+inline __m128 shuffle(__m128 a, __m128 b) {
+    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+}
+
+/**
+ * 2x2 blocks are stored as (a00, a01, a10, a11).
+ * A ∙ B.
+ */
+inline __m128 mat2_mul(__m128 a, __m128 b) {
+    return _mm_add_ps(
+        _mm_mul_ps(a, swizzle<0, 3, 0, 3>(b)),
+        _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+/**
+ * adj(A) ∙ B.
+ */
+inline __m128 mat2_adj_mul(__m128 a, __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(swizzle<3, 3, 0, 0>(a), b),
+        _mm_mul_ps(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+}
+
+/**
+ * A ∙ adj(B).
+ */
+inline __m128 mat2_mul_adj(__m128 a, __m128 b) {
+    return _mm_sub_ps(
+        _mm_mul_ps(a, swizzle<3, 0, 3, 0>(b)),
+        _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+} // namespace detail
+
+template <int I0, int I1, int I2, int I3, int S0, int S1, int S2, int S3, typename V>
+inline V swizzle(const V& v) {
+    static_assert(detail::is_f32x4<V>, "V must be a native float type");
+
+    const __m128 r = detail::swizzle<I0, I1, I2, I3>(detail::load(v.data));
+
+    if constexpr (S0 < 0 || S1 < 0 || S2 < 0 || S3 < 0) {
+        // Negation only flips the sign bit, as scalar negation does.
+        return detail::store<V>(_mm_xor_ps(r, _mm_setr_ps(
+            S0 < 0 ? - 0.0f : 0.0f,
+            S1 < 0 ? - 0.0f : 0.0f,
+            S2 < 0 ? - 0.0f : 0.0f,
+            S3 < 0 ? - 0.0f : 0.0f)));
+    }
+    else {
+        return detail::store<V>(r);
+    }
+}
+
+template <int I0, int I1, int I2, int I3, int S0, int S1, int S2, int S3, typename L>
+inline mat<float, 4, 4, L> swizzle(const mat<float, 4, 4, L>& m) {
+    const __m128 mask = _mm_setr_ps(
+        S0 < 0 ? - 0.0f : 0.0f,
+        S1 < 0 ? - 0.0f : 0.0f,
+        S2 < 0 ? - 0.0f : 0.0f,
+        S3 < 0 ? - 0.0f : 0.0f);
+
+    mat<float, 4, 4, L> result;
+
+    // Block b is block Ib, lanes signs all flipped when Sb is negative.
+    const auto block = [&](int b, int i, int s) {
+        const __m128 r = detail::swizzle<I0, I1, I2, I3>(_mm_loadu_ps(m.data + 4 * i));
+
+        _mm_storeu_ps(result.data + 4 * b, _mm_xor_ps(r,
+            s < 0 ? _mm_xor_ps(mask, _mm_set1_ps(- 0.0f)) : mask));
+    };
+
+    block(0, I0, S0);
+    block(1, I1, S1);
+    block(2, I2, S2);
+    block(3, I3, S3);
+
+    return result;
+}
+
+/**
+ * Block-wise inverse : M is seen as 2x2 blocks │A B│
+ *                                              │C D│
+ * The four block determinants come from a single multiply-subtract, every
+ * 2x2 minor is then shared through block adjugate products, and one division
+ * gives signed reciprocal determinant for all outputs.
+ * Storage blocks of 4 values are taken as rows, as inv(transpose(M)) is
+ * transpose(inv(M)) it works unchanged with column-major storage.
+ */
+inline bool inv(const mat<float, 4, 4>& M, mat<float, 4, 4>* result, float* d) {
+    const __m128 r0 = _mm_loadu_ps(M.data);
+    const __m128 r1 = _mm_loadu_ps(M.data + 4);
+    const __m128 r2 = _mm_loadu_ps(M.data + 8);
+    const __m128 r3 = _mm_loadu_ps(M.data + 12);
+
+    const __m128 A = _mm_movelh_ps(r0, r1);
+    const __m128 B = _mm_movehl_ps(r1, r0);
+    const __m128 C = _mm_movelh_ps(r2, r3);
+    const __m128 D = _mm_movehl_ps(r3, r2);
+
+    // (|A|, |B|, |C|, |D|)
+    const __m128 det_sub = _mm_sub_ps(
+        _mm_mul_ps(detail::shuffle<0, 2, 0, 2>(r0, r2), detail::shuffle<1, 3, 1, 3>(r1, r3)),
+        _mm_mul_ps(detail::shuffle<1, 3, 1, 3>(r0, r2), detail::shuffle<0, 2, 0, 2>(r1, r3)));
+
+    const __m128 det_A = detail::swizzle<0, 0, 0, 0>(det_sub);
+    const __m128 det_B = detail::swizzle<1, 1, 1, 1>(det_sub);
+    const __m128 det_C = detail::swizzle<2, 2, 2, 2>(det_sub);
+    const __m128 det_D = detail::swizzle<3, 3, 3, 3>(det_sub);
+
+    const __m128 D_C = detail::mat2_adj_mul(D, C);
+    const __m128 A_B = detail::mat2_adj_mul(A, B);
+
+    // Adjugates of the inverse blocks :
+    // inv(M) = 1 / |M| ∙ │X Y│
+    //                   │Z W│
+    __m128 X = _mm_sub_ps(_mm_mul_ps(det_D, A), detail::mat2_mul(B, D_C));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(det_A, D), detail::mat2_mul(C, A_B));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(det_B, C), detail::mat2_mul_adj(D, A_B));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(det_C, B), detail::mat2_mul_adj(A, D_C));
+
+    // |M| = |A| |D| + |B| |C| - tr(adj(A) B adj(D) C)
+    __m128 tr = _mm_mul_ps(A_B, detail::swizzle<0, 2, 1, 3>(D_C));
+    tr = _mm_add_ps(tr, detail::swizzle<2, 3, 0, 1>(tr));
+    tr = _mm_add_ps(tr, detail::swizzle<1, 0, 3, 2>(tr));
+
+    const __m128 det_M = _mm_sub_ps(
+        _mm_add_ps(_mm_mul_ps(det_A, det_D), _mm_mul_ps(det_B, det_C)), tr);
+
+    *d = _mm_cvtss_f32(det_M);
+
+    if (*d == 0.0f) {
+        return false;
+    }
+
+    const __m128 rcp_det_M = _mm_div_ps(_mm_setr_ps(1.0f, - 1.0f, - 1.0f, 1.0f), det_M);
+
+    X = _mm_mul_ps(X, rcp_det_M);
+    Y = _mm_mul_ps(Y, rcp_det_M);
+    Z = _mm_mul_ps(Z, rcp_det_M);
+    W = _mm_mul_ps(W, rcp_det_M);
+
+    // Adjugate shuffles merged with block to storage shuffles.
+    _mm_storeu_ps(result->data,      detail::shuffle<3, 1, 3, 1>(X, Y));
+    _mm_storeu_ps(result->data + 4,  detail::shuffle<2, 0, 2, 0>(X, Y));
+    _mm_storeu_ps(result->data + 8,  detail::shuffle<3, 1, 3, 1>(Z, W));
+    _mm_storeu_ps(result->data + 12, detail::shuffle<2, 0, 2, 0>(Z, W));
+
+    return true;
+}
+
+namespace detail {
+
+/**
+ * 4 double lanes and the operations used by the sincos kernel : one AVX
+ * register, or a pair of SSE2 ones. Float values are converted to double by
+ * set and back by store.
+ */
+#if defined(__AVX__)
+struct f64x4 {
+    using type = __m256d;
+
+    static __m256d set(double x0, double x1, double x2, double x3) {
+        return _mm256_set_pd(x3, x2, x1, x0);
+    }
+
+    static __m256d set(float x0, float x1, float x2, float x3) {
+        return _mm256_cvtps_pd(_mm_set_ps(x3, x2, x1, x0));
+    }
+
+    static void store(__m256d r, double* p) {
+        _mm256_storeu_pd(p, r);
+    }
+
+    static void store(__m256d r, float* p) {
+        _mm_storeu_ps(p, _mm256_cvtpd_ps(r));
+    }
+
+    static __m256d set1(double v) {
+        return _mm256_set1_pd(v);
+    }
+
+    static __m256d add(__m256d a, __m256d b) {
+        return _mm256_add_pd(a, b);
+    }
+
+    static __m256d sub(__m256d a, __m256d b) {
+        return _mm256_sub_pd(a, b);
+    }
+
+    static __m256d mul(__m256d a, __m256d b) {
+        return _mm256_mul_pd(a, b);
+    }
+
+    static __m256d madd(__m256d a, __m256d b, __m256d c) {
+        return detail::madd(a, b, c);
+    }
+
+    static __m256d and_(__m256d a, __m256d b) {
+        return _mm256_and_pd(a, b);
+    }
+
+    static __m256d xor_(__m256d a, __m256d b) {
+        return _mm256_xor_pd(a, b);
+    }
+
+    static __m256d abs(__m256d a) {
+        return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a);
+    }
+
+    /**
+     * a where m is set, b elsewhere.
+     */
+    static __m256d select(__m256d m, __m256d a, __m256d b) {
+        return _mm256_blendv_pd(b, a, m);
+    }
+
+    static bool all_le(__m256d a, __m256d b) {
+        return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ)) == 0xf;
+    }
+
+    /**
+     * Nearest integers, also stored as 32 bits integers in k.
+     */
+    static __m256d round(__m256d a, __m128i* k) {
+        *k = _mm256_cvtpd_epi32(a);
+
+        return _mm256_cvtepi32_pd(*k);
+    }
+
+    /**
+     * Lanes mask from 32 bits integer masks computed on round's k.
+     */
+    static __m256d mask(__m128i m) {
+        return _mm256_insertf128_pd(
+            _mm256_castpd128_pd256(_mm_castsi128_pd(_mm_unpacklo_epi32(m, m))),
+            _mm_castsi128_pd(_mm_unpackhi_epi32(m, m)), 1);
+    }
+};
+#else
+struct f64x4 {
+    struct type {
+        __m128d lo;
+        __m128d hi;
+    };
+
+    static type set(double x0, double x1, double x2, double x3) {
+        return {_mm_set_pd(x1, x0), _mm_set_pd(x3, x2)};
+    }
+
+    static type set(float x0, float x1, float x2, float x3) {
+        const __m128 f = _mm_set_ps(x3, x2, x1, x0);
+
+        return {_mm_cvtps_pd(f), _mm_cvtps_pd(_mm_movehl_ps(f, f))};
+    }
+
+    static void store(type r, double* p) {
+        _mm_storeu_pd(p, r.lo);
+        _mm_storeu_pd(p + 2, r.hi);
+    }
+
+    static void store(type r, float* p) {
+        _mm_storeu_ps(p, _mm_movelh_ps(_mm_cvtpd_ps(r.lo), _mm_cvtpd_ps(r.hi)));
+    }
+
+    static type set1(double v) {
+        const __m128d r = _mm_set1_pd(v);
+
+        return {r, r};
+    }
+
+    static type add(type a, type b) {
+        return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)};
+    }
+
+    static type sub(type a, type b) {
+        return {_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)};
+    }
+
+    static type mul(type a, type b) {
+        return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)};
+    }
+
+    static type madd(type a, type b, type c) {
+        return add(mul(a, b), c);
+    }
+
+    static type and_(type a, type b) {
+        return {_mm_and_pd(a.lo, b.lo), _mm_and_pd(a.hi, b.hi)};
+    }
+
+    static type xor_(type a, type b) {
+        return {_mm_xor_pd(a.lo, b.lo), _mm_xor_pd(a.hi, b.hi)};
+    }
+
+    static type abs(type a) {
+        const __m128d sign = _mm_set1_pd(-0.0);
+
+        return {_mm_andnot_pd(sign, a.lo), _mm_andnot_pd(sign, a.hi)};
+    }
+
+    static type select(type m, type a, type b) {
+        return {
+            _mm_or_pd(_mm_and_pd(m.lo, a.lo), _mm_andnot_pd(m.lo, b.lo)),
+            _mm_or_pd(_mm_and_pd(m.hi, a.hi), _mm_andnot_pd(m.hi, b.hi))};
+    }
+
+    static bool all_le(type a, type b) {
+        return (_mm_movemask_pd(_mm_cmple_pd(a.lo, b.lo)) & _mm_movemask_pd(_mm_cmple_pd(a.hi, b.hi))) == 0x3;
+    }
+
+    static type round(type a, __m128i* k) {
+        const __m128i lo = _mm_cvtpd_epi32(a.lo);
+        const __m128i hi = _mm_cvtpd_epi32(a.hi);
+
+        *k = _mm_unpacklo_epi64(lo, hi);
+
+        return {_mm_cvtepi32_pd(lo), _mm_cvtepi32_pd(hi)};
+    }
+
+    static type mask(__m128i m) {
+        return {
+            _mm_castsi128_pd(_mm_unpacklo_epi32(m, m)),
+            _mm_castsi128_pd(_mm_unpackhi_epi32(m, m))};
+    }
+};
+#endif
+
+/**
+ * Sines and cosines of the lanes of v.
+ * Cody-Waite reduction to y0 + y1 in [-pi / 4, pi / 4] with pi / 2 split in
+ * parts of 33 bits (fdlibm ones), then fdlibm sin and cos kernels on y0 + y1,
+ * swapped and negated according to the quadrant.
+ */
+inline bool sincos(f64x4::type v, f64x4::type* s, f64x4::type* c) {
+    using L = f64x4;
+    using V = L::type;
+
+    constexpr double inv_pio2 = 6.36619772367581382433e-01;
+    constexpr double pio2_1   = 1.57079632673412561417e+00;
+    constexpr double pio2_2   = 6.07710050630396597660e-11;
+    constexpr double pio2_2t  = 2.02226624879595063154e-21;
+
+    // Also false for NaN.
+    if (! L::all_le(L::abs(v), L::set1(c_sincos_max))) {
+        return false;
+    }
+
+    __m128i k;
+    const V n = L::round(L::mul(v, L::set1(inv_pio2)), &k);
+
+    // v - n pio2_1 is exact, the remainder is then kept as y0 + y1.
+    const V t = L::sub(v, L::mul(n, L::set1(pio2_1)));
+    V w = L::mul(n, L::set1(pio2_2));
+    const V r = L::sub(t, w);
+    w = L::sub(L::mul(n, L::set1(pio2_2t)), L::sub(L::sub(t, r), w));
+
+    const V y0 = L::sub(r, w);
+    const V y1 = L::sub(L::sub(r, y0), w);
+
+    const V half = L::set1(0.5);
+    const V one = L::set1(1.0);
+    const V z = L::mul(y0, y0);
+
+    // y0 - ((z (y1 / 2 - y0 z ps) - y1) - y0 z S1).
+    V ps = L::set1(1.58969099521155010221e-10);
+    ps = L::madd(ps, z, L::set1(-2.50507602534068634195e-08));
+    ps = L::madd(ps, z, L::set1(2.75573137070700676789e-06));
+    ps = L::madd(ps, z, L::set1(-1.98412698298579493134e-04));
+    ps = L::madd(ps, z, L::set1(8.33333333332248946124e-03));
+
+    const V zy0 = L::mul(z, y0);
+    const V sin_r = L::sub(y0, L::sub(
+        L::sub(L::mul(z, L::sub(L::mul(half, y1), L::mul(zy0, ps))), y1),
+        L::mul(zy0, L::set1(-1.66666666666666324348e-01))));
+
+    // 1 - z / 2 + z^2 pc - y0 y1, recovering the rounding error of 1 - z / 2.
+    V pc = L::set1(-1.13596475577881948265e-11);
+    pc = L::madd(pc, z, L::set1(2.08757232129817482790e-09));
+    pc = L::madd(pc, z, L::set1(-2.75573143513906633035e-07));
+    pc = L::madd(pc, z, L::set1(2.48015872894767294178e-05));
+    pc = L::madd(pc, z, L::set1(-1.38888888888741095749e-03));
+    pc = L::madd(pc, z, L::set1(4.16666666666666019037e-02));
+
+    const V hz = L::mul(half, z);
+    const V h = L::sub(one, hz);
+    const V cos_r = L::add(h, L::add(L::sub(L::sub(one, h), hz),
+        L::sub(L::mul(L::mul(z, z), pc), L::mul(y0, y1))));
+
+    const __m128i bit0 = _mm_set1_epi32(1);
+    const __m128i bit1 = _mm_set1_epi32(2);
+
+    const V odd = L::mask(_mm_cmpeq_epi32(_mm_and_si128(k, bit0), bit0));
+    const V high = L::mask(_mm_cmpeq_epi32(_mm_and_si128(k, bit1), bit1));
+    const V sign = L::set1(-0.0);
+
+    // Quadrants 2 and 3 negate sine, quadrants 1 and 2 negate cosine.
+    *s = L::xor_(L::select(odd, cos_r, sin_r), L::and_(high, sign));
+    *c = L::xor_(L::select(odd, sin_r, cos_r), L::and_(L::xor_(odd, high), sign));
+
+    return true;
+}
+
+} // namespace detail
+
+template <typename T, std::size_t D>
+inline bool sincos(const vec<T, D>& v, vec<T, D>* s, vec<T, D>* c) {
+    static_assert(std::is_floating_point<T>::value && D <= 4, "4 floating point components at most");
+
+    using L = detail::f64x4;
+
+    T x[4] = {};
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        x[d] = v.data[d];
+    }
+
+    L::type vs{};
+    L::type vc{};
+
+    if (! detail::sincos(L::set(x[0], x[1], x[2], x[3]), &vs, &vc)) {
+        return false;
+    }
+
+    T sd[4];
+    T cd[4];
+
+    L::store(vs, sd);
+    L::store(vc, cd);
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        s->data[d] = sd[d];
+        c->data[d] = cd[d];
+    }
+
+    return true;
+}
+
+#endif
+
+namespace detail {
+
+template <typename, typename = void>
+struct has_native_impl : std::false_type {};
+
+template <typename F, typename... Ts>
+struct has_native_impl<std::tuple<F, Ts...>,
+    std::void_t<decltype(native(std::declval<F>(), std::declval<const Ts&>()...))>>
+    : std::true_type {};
+
+} // namespace detail
+
+/**
+ * Tell if a native overload exists for functor F applied to Ts.
+ */
+template <typename F, typename... Ts>
+constexpr bool has_native =
+    detail::has_native_impl<std::tuple<std::decay_t<F>, std::decay_t<Ts>...>>::value;
+
+/**
+ * Componentwise operation.
+ * Same as ee::cwise but using native instructions when available for the
+ * given functor and operand types. Constant evaluation always uses the
+ * generic path.
+ */
+template <typename F, typename... Ts>
+constexpr auto cwise(F f, const Ts&... ts) {
+    if constexpr (has_native<F, Ts...>) {
+        if (! is_constant_evaluated()) {
+            return native(f, ts...);
+        }
+    }
+
+    return ee::cwise(f, ts...);
+}
+
+} // namespace simd
+} // namespace math
+} // namespace ee
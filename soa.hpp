@@ -0,0 +1,351 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "mat.hpp"
+#include "quat.hpp"
+#include "simd.hpp"
+#include "vec.hpp"
+
+namespace ee {
+namespace math {
+
+/**
+ * Structure of arrays container for vec, mat and quat batches.
+ * Each component (data index of E) lives in its own stream. Streams are
+ * aligned on soa::alignment bytes and their length is padded to a whole number
+ * of soa::lanes, padding being kept zeroed, so lane-parallel kernels can run
+ * over the whole capacity without remainder loop.
+ * Element access goes through a proxy, converting from and to E.
+ * streams() gives the stream pointers, as expected by batched functions taking
+ * SoA input.
+ */
+template <typename E>
+class soa {
+    static_assert(is_vec<E> || is_mat<E> || is_quat<E>, "E must be a vec, a mat or a quat");
+
+public:
+    using value_type  = E;
+    using scalar_type = typename E::value_type;
+
+    constexpr static std::size_t stream_count = E::size;
+    constexpr static std::size_t alignment    = 64;
+    constexpr static std::size_t lanes        = alignment / sizeof(scalar_type);
+
+    /**
+     * Proxy to the element at a given index.
+     */
+    class reference {
+    public:
+        reference(soa* s, std::size_t i) : m_soa(s), m_index(i) {}
+
+        reference(const reference&) = default;
+
+        operator E() const {
+            return static_cast<const soa&>(*m_soa)[m_index];
+        }
+
+        reference& operator=(const E& e) {
+            for (std::size_t d = 0; d < stream_count; ++ d) {
+                m_soa->m_streams[d][m_index] = e.data[d];
+            }
+
+            return *this;
+        }
+
+        reference& operator=(const reference& other) {
+            return *this = static_cast<E>(other);
+        }
+
+        scalar_type& operator[](std::size_t d) const {
+            return m_soa->m_streams[d][m_index];
+        }
+
+    private:
+        soa* m_soa;
+        std::size_t m_index;
+    };
+
+    soa() = default;
+
+    explicit soa(std::size_t n) {
+        allocate(n);
+    }
+
+    soa(const E* p, std::size_t n) {
+        allocate(n);
+        to_soa(p, n, this);
+    }
+
+    soa(const soa& other) {
+        allocate(other.m_size);
+
+        if (m_data) {
+            std::memcpy(m_data, other.m_data, bytes());
+        }
+    }
+
+    soa(soa&& other) noexcept {
+        swap(other);
+    }
+
+    soa& operator=(soa other) noexcept {
+        swap(other);
+
+        return *this;
+    }
+
+    ~soa() {
+        release();
+    }
+
+    void swap(soa& other) noexcept {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_capacity, other.m_capacity);
+
+        for (std::size_t d = 0; d < stream_count; ++ d) {
+            std::swap(m_streams[d], other.m_streams[d]);
+        }
+    }
+
+    /**
+     * Number of elements.
+     */
+    std::size_t size() const {
+        return m_size;
+    }
+
+    /**
+     * Padded length of each stream, a multiple of lanes.
+     */
+    std::size_t capacity() const {
+        return m_capacity;
+    }
+
+    /**
+     * Resize, keeping existing elements. New elements are zeroed.
+     */
+    void resize(std::size_t n) {
+        if (n <= m_capacity) {
+            m_size = std::min(n, m_size);
+            clear_padding();
+            m_size = n;
+
+            return;
+        }
+
+        soa other(n);
+
+        for (std::size_t d = 0; d < stream_count; ++ d) {
+            std::copy(m_streams[d], m_streams[d] + m_size, other.m_streams[d]);
+        }
+
+        swap(other);
+    }
+
+    /**
+     * Zero stream padding, for kernels writing over the whole capacity.
+     */
+    void clear_padding() {
+        for (std::size_t d = 0; d < stream_count; ++ d) {
+            std::fill(m_streams[d] + m_size, m_streams[d] + m_capacity, scalar_type{});
+        }
+    }
+
+    reference operator[](std::size_t i) {
+        return {this, i};
+    }
+
+    E operator[](std::size_t i) const {
+        E e;
+
+        for (std::size_t d = 0; d < stream_count; ++ d) {
+            e.data[d] = m_streams[d][i];
+        }
+
+        return e;
+    }
+
+    /**
+     * Stream holding component d of every element.
+     */
+    scalar_type* stream(std::size_t d) {
+        return m_streams[d];
+    }
+
+    const scalar_type* stream(std::size_t d) const {
+        return m_streams[d];
+    }
+
+    /**
+     * All streams, in component order.
+     */
+    scalar_type* const* streams() {
+        return m_streams;
+    }
+
+    const scalar_type* const* streams() const {
+        return m_streams;
+    }
+
+private:
+    std::size_t bytes() const {
+        return m_capacity * stream_count * sizeof(scalar_type);
+    }
+
+    void allocate(std::size_t n) {
+        m_size = n;
+        m_capacity = (n + lanes - 1) / lanes * lanes;
+
+        if (m_capacity == 0) {
+            return;
+        }
+
+        m_data = static_cast<scalar_type*>(
+            ::operator new(bytes(), std::align_val_t{alignment}));
+
+        std::fill(m_data, m_data + m_capacity * stream_count, scalar_type{});
+
+        for (std::size_t d = 0; d < stream_count; ++ d) {
+            m_streams[d] = m_data + d * m_capacity;
+        }
+    }
+
+    void release() {
+        if (m_data) {
+            ::operator delete(m_data, std::align_val_t{alignment});
+        }
+    }
+
+    scalar_type* m_data = nullptr;
+    scalar_type* m_streams[stream_count] = {};
+    std::size_t m_size = 0;
+    std::size_t m_capacity = 0;
+};
+
+/**
+ * A way to identify soa containers.
+ */
+namespace detail {
+
+template <typename>
+struct is_soa_impl : std::false_type {};
+
+template <typename E>
+struct is_soa_impl<soa<E>> : std::true_type {};
+
+} // namespace detail
+
+template <typename T>
+constexpr bool is_soa = detail::is_soa_impl<std::decay_t<T>>::value;
+
+/**
+ * Copy n elements from p (AoS) into out (SoA), resizing out if needed.
+ */
+template <typename E>
+void to_soa(const E* p, std::size_t n, soa<E>* out) {
+    if (out->size() != n) {
+        out->resize(n);
+    }
+
+    using T = typename E::value_type;
+
+    T* const* s = out->streams();
+
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value && E::size == 4) {
+        for (; i + 4 <= n; i += 4) {
+            __m128 r0 = _mm_loadu_ps(p[i    ].data);
+            __m128 r1 = _mm_loadu_ps(p[i + 1].data);
+            __m128 r2 = _mm_loadu_ps(p[i + 2].data);
+            __m128 r3 = _mm_loadu_ps(p[i + 3].data);
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            _mm_store_ps(s[0] + i, r0);
+            _mm_store_ps(s[1] + i, r1);
+            _mm_store_ps(s[2] + i, r2);
+            _mm_store_ps(s[3] + i, r3);
+        }
+    } else if constexpr (std::is_same<T, float>::value && E::size == 3) {
+        for (; i + 4 <= n; i += 4) {
+            __m128 x, y, z;
+
+            simd::detail::deinterleave3(p[i].data, &x, &y, &z);
+
+            _mm_store_ps(s[0] + i, x);
+            _mm_store_ps(s[1] + i, y);
+            _mm_store_ps(s[2] + i, z);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        for (std::size_t d = 0; d < E::size; ++ d) {
+            s[d][i] = p[i].data[d];
+        }
+    }
+}
+
+/**
+ * Copy all elements of s (SoA) into out (AoS), which must hold s.size()
+ * elements.
+ */
+template <typename E>
+void to_aos(const soa<E>& s, E* out) {
+    using T = typename E::value_type;
+
+    const T* const* st = s.streams();
+    const std::size_t n = s.size();
+
+    std::size_t i = 0;
+
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value && E::size == 4) {
+        for (; i + 4 <= n; i += 4) {
+            __m128 r0 = _mm_load_ps(st[0] + i);
+            __m128 r1 = _mm_load_ps(st[1] + i);
+            __m128 r2 = _mm_load_ps(st[2] + i);
+            __m128 r3 = _mm_load_ps(st[3] + i);
+
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+            _mm_storeu_ps(out[i    ].data, r0);
+            _mm_storeu_ps(out[i + 1].data, r1);
+            _mm_storeu_ps(out[i + 2].data, r2);
+            _mm_storeu_ps(out[i + 3].data, r3);
+        }
+    } else if constexpr (std::is_same<T, float>::value && E::size == 3) {
+        for (; i + 4 <= n; i += 4) {
+            simd::detail::interleave3(
+                _mm_load_ps(st[0] + i),
+                _mm_load_ps(st[1] + i),
+                _mm_load_ps(st[2] + i), out[i].data);
+        }
+    }
+#endif
+
+    for (; i < n; ++ i) {
+        for (std::size_t d = 0; d < E::size; ++ d) {
+            out[i].data[d] = st[d][i];
+        }
+    }
+}
+
+} // namespace math
+} // namespace ee
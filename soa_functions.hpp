@@ -0,0 +1,278 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include "mat.hpp"
+#include "mat_batch_functions.hpp"
+#include "soa.hpp"
+#include "vec.hpp"
+
+/**
+ * Lane-parallel counterparts of vec_functions.hpp and mat_functions.hpp over
+ * soa containers.
+ * Kernels walk the streams one block of soa::lanes elements at a time, over
+ * the whole padded capacity. Each block is a fixed size loop of independent
+ * lanes, with component sums unrolled at compile time, which the compiler
+ * turns into SIMD code for any scalar type.
+ */
+
+namespace ee {
+namespace math {
+
+namespace detail {
+
+/**
+ * Sum of a(d) * b(d) over d, for one block of L lanes.
+ */
+template <std::size_t L, typename T, std::size_t... Ds>
+void dot_block(const T* const* a, const T* const* b, std::size_t i, T* out,
+    std::index_sequence<Ds...>) {
+    for (std::size_t k = 0; k < L; ++ k) {
+        out[k] = (... + (a[Ds][i + k] * b[Ds][i + k]));
+    }
+}
+
+/**
+ * Sum of m[c] * v(c) over c, plus m[sizeof...(Cs)], for one block of L lanes.
+ * Same operation order as affine_map_to.
+ */
+template <std::size_t L, typename T, std::size_t... Cs>
+void row_block(const T* m, const T* const* v, std::size_t i, T* out,
+    std::index_sequence<Cs...>) {
+    for (std::size_t k = 0; k < L; ++ k) {
+        out[k] = (... + (m[Cs] * v[Cs][i + k])) + m[sizeof...(Cs)];
+    }
+}
+
+} // namespace detail
+
+/**
+ * Write the dot product of each v1 and v2 element pair into out, which must
+ * hold v1.size() values.
+ */
+template <typename T, std::size_t D>
+void dot(const soa<vec<T, D>>& v1, const soa<vec<T, D>>& v2, T* out) {
+    constexpr std::size_t l = soa<vec<T, D>>::lanes;
+
+    const std::size_t n = v1.size();
+
+    for (std::size_t i = 0; i < v1.capacity(); i += l) {
+        T block[l];
+
+        detail::dot_block<l>(v1.streams(), v2.streams(), i, block, std::make_index_sequence<D>());
+
+        for (std::size_t k = 0; k < l && i + k < n; ++ k) {
+            out[i + k] = block[k];
+        }
+    }
+}
+
+/**
+ * Write the magnitude of each element of v into out, which must hold
+ * v.size() values.
+ */
+template <typename T, std::size_t D>
+void mag(const soa<vec<T, D>>& v, T* out) {
+    dot(v, v, out);
+
+    for (std::size_t i = 0; i < v.size(); ++ i) {
+        out[i] = std::sqrt(out[i]);
+    }
+}
+
+/**
+ * Write the cross product of each v1 and v2 element pair into out, which may
+ * be v1 or v2.
+ */
+template <typename T>
+void cross(const soa<vec<T, 3>>& v1, const soa<vec<T, 3>>& v2, soa<vec<T, 3>>* out) {
+    constexpr std::size_t l = soa<vec<T, 3>>::lanes;
+
+    out->resize(v1.size());
+
+    for (std::size_t i = 0; i < v1.capacity(); i += l) {
+        const T* ax = v1.stream(0) + i;
+        const T* ay = v1.stream(1) + i;
+        const T* az = v1.stream(2) + i;
+        const T* bx = v2.stream(0) + i;
+        const T* by = v2.stream(1) + i;
+        const T* bz = v2.stream(2) + i;
+
+        T block[3][l];
+
+        for (std::size_t k = 0; k < l; ++ k) {
+            block[0][k] = ay[k] * bz[k] - az[k] * by[k];
+            block[1][k] = az[k] * bx[k] - ax[k] * bz[k];
+            block[2][k] = ax[k] * by[k] - ay[k] * bx[k];
+        }
+
+        for (std::size_t d = 0; d < 3; ++ d) {
+            std::copy(block[d], block[d] + l, out->stream(d) + i);
+        }
+    }
+}
+
+/**
+ * Return the cross product of each v1 and v2 element pair.
+ */
+template <typename T>
+soa<vec<T, 3>> cross(const soa<vec<T, 3>>& v1, const soa<vec<T, 3>>& v2) {
+    soa<vec<T, 3>> result;
+
+    cross(v1, v2, &result);
+
+    return result;
+}
+
+/**
+ * Write each element of v normalized into out, which may be v. Null vectors
+ * stay null.
+ */
+template <typename T, std::size_t D>
+void normalize(const soa<vec<T, D>>& v, soa<vec<T, D>>* out) {
+    constexpr std::size_t l = soa<vec<T, D>>::lanes;
+
+    out->resize(v.size());
+
+    for (std::size_t i = 0; i < v.capacity(); i += l) {
+        T m[l];
+
+        detail::dot_block<l>(v.streams(), v.streams(), i, m, std::make_index_sequence<D>());
+
+        for (std::size_t k = 0; k < l; ++ k) {
+            m[k] = m[k] > T{0L} ? T{1L} / std::sqrt(m[k]) : T{0L};
+        }
+
+        for (std::size_t d = 0; d < D; ++ d) {
+            const T* a = v.stream(d) + i;
+            T* r = out->stream(d) + i;
+
+            for (std::size_t k = 0; k < l; ++ k) {
+                r[k] = a[k] * m[k];
+            }
+        }
+    }
+}
+
+/**
+ * Return each element of v normalized. Null vectors stay null.
+ */
+template <typename T, std::size_t D>
+soa<vec<T, D>> normalize(const soa<vec<T, D>>& v) {
+    soa<vec<T, D>> result;
+
+    normalize(v, &result);
+
+    return result;
+}
+
+/**
+ * Write each element of rhs transformed by the affine transformation lhs into
+ * out, which may be rhs.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void affine_map(const mat<T, R, C, L>& lhs, const soa<vec<T, D>>& rhs, soa<vec<T, D>>* out) {
+    static_assert(D <= R, "matrix row count must be greater or equal to vector dimension");
+    static_assert(D < C, "matrix column count must be greater than vector dimension");
+
+    constexpr std::size_t l = soa<vec<T, D>>::lanes;
+
+    T m[D][D + 1];
+
+    detail::rows_of<D, D>(lhs, m);
+
+    out->resize(rhs.size());
+
+    for (std::size_t i = 0; i < rhs.capacity(); i += l) {
+        T block[D][l];
+
+        for (std::size_t d = 0; d < D; ++ d) {
+            detail::row_block<l>(m[d], rhs.streams(), i, block[d], std::make_index_sequence<D>());
+        }
+
+        for (std::size_t d = 0; d < D; ++ d) {
+            std::copy(block[d], block[d] + l, out->stream(d) + i);
+        }
+    }
+
+    out->clear_padding();
+}
+
+/**
+ * Return each element of rhs transformed by the affine transformation lhs.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+soa<vec<T, D>> affine_map(const mat<T, R, C, L>& lhs, const soa<vec<T, D>>& rhs) {
+    soa<vec<T, D>> result;
+
+    affine_map(lhs, rhs, &result);
+
+    return result;
+}
+
+/**
+ * Write each element of rhs transformed by the projective transformation lhs
+ * into out, which may be rhs. One reciprocal per element for the perspective
+ * division.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+void projective_map(const mat<T, R, C, L>& lhs, const soa<vec<T, D>>& rhs, soa<vec<T, D>>* out) {
+    static_assert(D < R, "matrix row count must be greater than vector dimension");
+    static_assert(D < C, "matrix column count must be greater than vector dimension");
+
+    constexpr std::size_t l = soa<vec<T, D>>::lanes;
+
+    T m[D + 1][D + 1];
+
+    detail::rows_of<D + 1, D>(lhs, m);
+
+    out->resize(rhs.size());
+
+    for (std::size_t i = 0; i < rhs.capacity(); i += l) {
+        T block[D + 1][l];
+
+        for (std::size_t d = 0; d <= D; ++ d) {
+            detail::row_block<l>(m[d], rhs.streams(), i, block[d], std::make_index_sequence<D>());
+        }
+
+        for (std::size_t k = 0; k < l; ++ k) {
+            block[D][k] = T{1L} / block[D][k];
+        }
+
+        for (std::size_t d = 0; d < D; ++ d) {
+            T* r = out->stream(d) + i;
+
+            for (std::size_t k = 0; k < l; ++ k) {
+                r[k] = block[d][k] * block[D][k];
+            }
+        }
+    }
+
+    out->clear_padding();
+}
+
+/**
+ * Return each element of rhs transformed by the projective transformation
+ * lhs.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L, std::size_t D>
+soa<vec<T, D>> projective_map(const mat<T, R, C, L>& lhs, const soa<vec<T, D>>& rhs) {
+    soa<vec<T, D>> result;
+
+    projective_map(lhs, rhs, &result);
+
+    return result;
+}
+
+} // namespace math
+} // namespace ee
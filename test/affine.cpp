@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * mul_affine, inv_affine and inv_rigid against the general operator* and inv,
+ * on random affine and rigid transformations.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+#include "../constants.hpp"
+#include "../mat_functions.hpp"
+#include "../quat_functions.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+constexpr std::size_t c_count = 10000;
+
+int g_failures = 0;
+
+/**
+ * Largest absolute difference between a and b, relative to the largest
+ * component of b.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+T max_diff(const mat<T, R, C, L>& a, const mat<T, R, C, L>& b) {
+    T diff{};
+    T scale{1L};
+
+    for (std::size_t i = 0; i < a.size; ++ i) {
+        diff = std::max(diff, std::abs(a.data[i] - b.data[i]));
+        scale = std::max(scale, std::abs(b.data[i]));
+    }
+
+    return diff / scale;
+}
+
+template <typename T>
+void check(const char* type, const char* name, T diff, T tolerance) {
+    const bool ok = diff <= tolerance;
+
+    std::printf("%-7s %-30s max diff %-12g %s\n", type, name, static_cast<double>(diff), ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+template <typename T>
+mat<T, 4, 4> random_rigid(std::mt19937& g) {
+    std::normal_distribution<T> n;
+    std::uniform_real_distribution<T> u(T{-10L}, T{10L});
+
+    mat<T, 4, 4> M = mat_from(normalize(quat<T>{n(g), n(g), n(g), n(g)}));
+
+    M(0, 3) = u(g);
+    M(1, 3) = u(g);
+    M(2, 3) = u(g);
+
+    return M;
+}
+
+/**
+ * Rotation, non uniform scale in [0.5, 2] and shear, with a translation.
+ */
+template <typename T>
+mat<T, 4, 4> random_affine(std::mt19937& g) {
+    std::uniform_real_distribution<T> scale(T{0.5L}, T{2L});
+    std::uniform_real_distribution<T> shear(T{-0.5L}, T{0.5L});
+
+    mat<T, 4, 4> S = c_identity<mat<T, 4, 4>>;
+
+    S(0, 0) = scale(g);
+    S(1, 1) = scale(g);
+    S(2, 2) = scale(g);
+    S(0, 1) = shear(g);
+    S(0, 2) = shear(g);
+    S(1, 2) = shear(g);
+
+    return random_rigid<T>(g) * S;
+}
+
+template <typename T>
+void run(const char* type) {
+    // Both paths round differently, seen up to about 11 epsilons.
+    const T tolerance = std::numeric_limits<T>::epsilon() * T{64L};
+
+    std::mt19937 g(42);
+
+    T mul_diff{};
+    T mul_row_major_diff{};
+    T inv_affine_diff{};
+    T inv_rigid_diff{};
+    T inv_3x4_diff{};
+    T inv_rigid_3x4_diff{};
+
+    for (std::size_t i = 0; i < c_count; ++ i) {
+        const mat<T, 4, 4> A = random_affine<T>(g);
+        const mat<T, 4, 4> B = random_affine<T>(g);
+        const mat<T, 4, 4> R = random_rigid<T>(g);
+
+        const mat<T, 4, 4> A_inv = inv(A);
+        const mat<T, 4, 4> R_inv = inv(R);
+
+        mul_diff = std::max(mul_diff, max_diff(mul_affine(A, B), A * B));
+        mul_row_major_diff = std::max(mul_row_major_diff, max_diff(
+            to_layout<column_major>(mul_affine(to_layout<row_major>(A), to_layout<row_major>(B))), mul_affine(A, B)));
+        inv_affine_diff = std::max(inv_affine_diff, max_diff(inv_affine(A), A_inv));
+        inv_rigid_diff = std::max(inv_rigid_diff, max_diff(inv_rigid(R), R_inv));
+        inv_3x4_diff = std::max(inv_3x4_diff, max_diff(inv(affine_from(A)), affine_from(A_inv)));
+        inv_rigid_3x4_diff = std::max(inv_rigid_3x4_diff, max_diff(inv_rigid(affine_from(R)), affine_from(R_inv)));
+    }
+
+    check(type, "mul_affine vs operator*", mul_diff, tolerance);
+    check(type, "mul_affine row-major", mul_row_major_diff, T{0L});
+    check(type, "inv_affine vs inv", inv_affine_diff, tolerance);
+    check(type, "inv_rigid vs inv", inv_rigid_diff, tolerance);
+    check(type, "inv(mat3x4) vs inv", inv_3x4_diff, tolerance);
+    check(type, "inv_rigid(mat3x4) vs inv", inv_rigid_3x4_diff, tolerance);
+}
+
+} // namespace
+
+int main() {
+    run<float>("float");
+    run<double>("double");
+
+    return g_failures == 0 ? 0 : 1;
+}
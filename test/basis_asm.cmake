@@ -0,0 +1,31 @@
+# Fail when a function of basis_asm.cpp multiplies, ASM being its assembly.
+# Usage : cmake -DASM=<file> -P basis_asm.cmake
+
+file(STRINGS "${ASM}" lines)
+
+set(function "")
+set(functions 0)
+set(failures "")
+
+foreach(line IN LISTS lines)
+    if(line MATCHES "^_?(ee_math_basis_asm_[A-Za-z0-9_]+):")
+        set(function "${CMAKE_MATCH_1}")
+        math(EXPR functions "${functions} + 1")
+    elseif(line MATCHES "^[ \t]*\\.cfi_endproc|^[ \t]*\\.size[ \t]")
+        set(function "")
+    elseif(function AND line MATCHES "^[ \t]+(v?mul[a-z]*|imul[a-z]*)[ \t]")
+        string(STRIP "${line}" line)
+        list(APPEND failures "${function} : ${line}")
+    endif()
+endforeach()
+
+if(functions EQUAL 0)
+    message(FATAL_ERROR "no ee_math_basis_asm_ function found in ${ASM}")
+endif()
+
+if(failures)
+    string(REPLACE ";" "\n" failures "${failures}")
+    message(FATAL_ERROR "basis changes must not multiply :\n${failures}")
+endif()
+
+message(STATUS "${functions} basis changes, no multiplication")
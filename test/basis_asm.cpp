@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Compiled to assembly only, see basis_asm.cmake : basis changes are signed
+ * permutations, none of these functions may multiply.
+ */
+
+#include "../basis_functions.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+// Every axis moved and two of them negated.
+using from = basis<zneg, xpos, yneg>;
+using to = basis<ypos, zneg, xneg>;
+
+using vec3f = vec<float, 3>;
+using vec3d = vec<double, 3>;
+using mat3x3f = mat<float, 3, 3>;
+using mat3x3d = mat<double, 3, 3>;
+using mat4x4f = mat<float, 4, 4>;
+using mat4x4d = mat<double, 4, 4>;
+using quatf = quat<float>;
+using quatd = quat<double>;
+
+} // namespace
+
+#define EE_MATH_BASIS_ASM(type) \
+    extern "C" void ee_math_basis_asm_to_##type(const type* in, type* out) { \
+        *out = to_basis<to>(*in); \
+    } \
+    extern "C" void ee_math_basis_asm_from_##type(const type* in, type* out) { \
+        *out = from_basis<from>(*in); \
+    } \
+    extern "C" void ee_math_basis_asm_change_##type(const type* in, type* out) { \
+        *out = change_basis<from, to>(*in); \
+    }
+
+EE_MATH_BASIS_ASM(vec3f)
+EE_MATH_BASIS_ASM(vec3d)
+EE_MATH_BASIS_ASM(mat3x3f)
+EE_MATH_BASIS_ASM(mat3x3d)
+EE_MATH_BASIS_ASM(mat4x4f)
+EE_MATH_BASIS_ASM(mat4x4d)
+EE_MATH_BASIS_ASM(quatf)
+EE_MATH_BASIS_ASM(quatd)
@@ -0,0 +1,223 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Constant evaluation of sin, cos, tan, atan2, acos and sqrt : tables computed
+ * at compile time, compared at run time to libm in long double rounded to the
+ * result type, within 1 ulp where long double has a 64 bits mantissa (a few
+ * elsewhere). Constant evaluation of sin, cos and tan beyond the range of
+ * their reduction must fail, which static_asserts check.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <type_traits>
+
+#include "../functions.hpp"
+
+namespace {
+
+int g_failures = 0;
+
+/**
+ * Whether sin, cos and tan of X::value are constant expressions.
+ */
+template <typename X, typename = void>
+struct is_const_sin_cos_tan : std::false_type {};
+
+template <typename X>
+struct is_const_sin_cos_tan<X, std::void_t<std::integral_constant<bool,
+    (ee::math::sin(X::value) + ee::math::cos(X::value) + ee::math::tan(X::value) == 0)>>> : std::true_type {};
+
+struct in_range_double {
+    constexpr static double value = 1.0e6;
+};
+
+struct in_range_float {
+    constexpr static float value = -1.0e6f;
+};
+
+struct beyond_range_double {
+    constexpr static double value = 1.0e10;
+};
+
+struct beyond_range_float {
+    constexpr static float value = -1.0e10f;
+};
+
+struct beyond_range_max {
+    constexpr static double value = std::numeric_limits<double>::max();
+};
+
+static_assert(is_const_sin_cos_tan<in_range_double>::value && is_const_sin_cos_tan<in_range_float>::value,
+    "sin, cos and tan must be constant expressions within range");
+static_assert(! is_const_sin_cos_tan<beyond_range_double>::value && ! is_const_sin_cos_tan<beyond_range_float>::value
+    && ! is_const_sin_cos_tan<beyond_range_max>::value,
+    "sin, cos and tan must not be constant expressions beyond range");
+
+constexpr std::size_t c_size = 2048;
+
+/**
+ * Arguments and results of f, computed at compile time.
+ */
+template <typename T>
+struct table {
+    T x[c_size];
+    T y[c_size];
+    T result[c_size];
+};
+
+template <typename T, typename G, typename F>
+constexpr table<T> make_table(G arguments, F f) {
+    table<T> t{};
+
+    for (std::size_t i = 0; i < c_size; ++ i) {
+        arguments(i, &t.x[i], &t.y[i]);
+
+        t.result[i] = f(t.x[i], t.y[i]);
+    }
+
+    return t;
+}
+
+/**
+ * Arguments : half of them evenly spaced in [-lo, lo), half a geometric
+ * sweep from min to max (both signs when negative is set).
+ */
+template <typename T>
+constexpr auto sweep(T lo, T min, T max, bool negative) {
+    return [=](std::size_t i, T* x, T* y) {
+        *y = T{0L};
+
+        if (i < c_size / 2) {
+            *x = lo * (T{2L} * static_cast<T>(i) / static_cast<T>(c_size / 2) - T{1L}) + lo * T{0.00137L};
+
+            return;
+        }
+
+        const std::size_t k = (i - c_size / 2) / (negative ? 2 : 1);
+        const std::size_t count = c_size / (negative ? 4 : 2);
+
+        // min * (max / min)^(k / count), by repeated products.
+        long double v = min;
+        long double ratio = 1.0L;
+        long double step = static_cast<long double>(max) / min;
+
+        for (std::size_t bit = count; bit > 1; bit /= 2) {
+            step = ee::math::detail::const_sqrt(step);
+
+            if ((k / (bit / 2)) % 2 == 1) {
+                ratio *= step;
+            }
+        }
+
+        v *= ratio;
+
+        *x = static_cast<T>(negative && i % 2 == 1 ? - v : v);
+    };
+}
+
+template <typename T>
+constexpr auto grid(T lo) {
+    return [=](std::size_t i, T* x, T* y) {
+        constexpr std::size_t side = 32;
+
+        // y rows then x, each with 0, and infinities on the last row.
+        *y = i / side % side == 0 ? T{0L} : lo * (T{2L} * static_cast<T>(i / side % side) / side - T{1L});
+        *x = i % side == 0 ? T{0L} : lo * (T{2L} * static_cast<T>(i % side) / side - T{1L}) + T{0.01L};
+
+        if (i >= side * side) {
+            *x = i % 3 == 0 ? std::numeric_limits<T>::infinity() : i % 3 == 1 ? - std::numeric_limits<T>::infinity() : *x;
+            *y = i % 5 == 0 ? - std::numeric_limits<T>::infinity() : *y * T{3L};
+        }
+    };
+}
+
+template <typename T>
+constexpr auto near_one() {
+    return [](std::size_t i, T* x, T* y) {
+        *y = T{0L};
+
+        // Evenly spaced in [-1, 1], then within some epsilons of -1 and 1.
+        if (i < c_size / 2) {
+            *x = T{2L} * static_cast<T>(i) / static_cast<T>(c_size / 2) - T{1L};
+        }
+        else {
+            const T d = static_cast<T>((i - c_size / 2) / 2) * std::numeric_limits<T>::epsilon();
+
+            *x = i % 2 == 0 ? T{1L} - d : T{-1L} + d;
+        }
+    };
+}
+
+/**
+ * Distance from a to b in ulps of b.
+ */
+template <typename T>
+T ulps(T a, T b) {
+    if (a == b || (std::isnan(a) && std::isnan(b))) {
+        return T{0L};
+    }
+
+    const T m = std::abs(b);
+    const T ulp = std::isinf(m) ? std::numeric_limits<T>::infinity() :
+        std::nextafter(m, std::numeric_limits<T>::infinity()) - m;
+
+    return std::abs(a - b) / ulp;
+}
+
+template <typename T, typename F>
+void check(const char* type, const char* name, const table<T>& t, F reference) {
+    const T tolerance = std::numeric_limits<long double>::digits >= 64 ? T{1L} : T{4L};
+
+    T diff{};
+
+    for (std::size_t i = 0; i < c_size; ++ i) {
+        diff = std::max(diff, ulps(t.result[i], static_cast<T>(reference(
+            static_cast<long double>(t.x[i]), static_cast<long double>(t.y[i])))));
+    }
+
+    const bool ok = diff <= tolerance;
+
+    std::printf("%-7s %-8s max diff %-8g ulp %s\n", type, name, static_cast<double>(diff), ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+template <typename T>
+void run(const char* type) {
+    constexpr auto trig_arguments = sweep<T>(T{64L}, T{1e-6L}, T{1e6L}, true);
+
+    constexpr table<T> sin_table = make_table<T>(trig_arguments, [](T x, T) { return ee::math::sin(x); });
+    constexpr table<T> cos_table = make_table<T>(trig_arguments, [](T x, T) { return ee::math::cos(x); });
+    constexpr table<T> tan_table = make_table<T>(trig_arguments, [](T x, T) { return ee::math::tan(x); });
+    constexpr table<T> atan2_table = make_table<T>(grid<T>(T{4L}), [](T x, T y) { return ee::math::atan2(y, x); });
+    constexpr table<T> acos_table = make_table<T>(near_one<T>(), [](T x, T) { return ee::math::acos(x); });
+    constexpr table<T> sqrt_table = make_table<T>(sweep<T>(T{1000L}, T{1e-30L}, T{1e30L}, false),
+        [](T x, T) { return ee::math::sqrt(x < T{0L} ? - x : x); });
+
+    check(type, "sin", sin_table, [](long double x, long double) { return std::sin(x); });
+    check(type, "cos", cos_table, [](long double x, long double) { return std::cos(x); });
+    check(type, "tan", tan_table, [](long double x, long double) { return std::tan(x); });
+    check(type, "atan2", atan2_table, [](long double x, long double y) { return std::atan2(y, x); });
+    check(type, "acos", acos_table, [](long double x, long double) { return std::acos(x); });
+    check(type, "sqrt", sqrt_table, [](long double x, long double) { return std::sqrt(std::abs(x)); });
+}
+
+} // namespace
+
+int main() {
+    run<float>("float");
+    run<double>("double");
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * 4x4 inverses (the block-wise native kernel, inv_from_minors and try_inv)
+ * against the adjugate of cofactor expansion, on random and singular
+ * matrices. Built with and without EE_MATH_SIMD.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <utility>
+
+#include "../constants.hpp"
+#include "../mat_functions.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+constexpr std::size_t c_count = 10000;
+
+int g_failures = 0;
+
+/**
+ * Largest absolute difference between a and b, relative to the largest
+ * component of b.
+ */
+template <typename T, typename L>
+T max_diff(const mat<T, 4, 4, L>& a, const mat<T, 4, 4, L>& b) {
+    T diff{};
+    T scale{1L};
+
+    for (std::size_t i = 0; i < a.size; ++ i) {
+        diff = std::max(diff, std::abs(a.data[i] - b.data[i]));
+        scale = std::max(scale, std::abs(b.data[i]));
+    }
+
+    return diff / scale;
+}
+
+template <typename T>
+void check(const char* type, const char* name, T diff, T tolerance) {
+    const bool ok = diff <= tolerance;
+
+    std::printf("%-7s %-36s max diff %-12g %s\n", type, name, static_cast<double>(diff), ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+void check(const char* type, const char* name, bool ok) {
+    std::printf("%-7s %-36s %s\n", type, name, ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+/**
+ * Reference inverse : adjugate from cofactor expansion, over determinant from
+ * cofactor expansion.
+ */
+template <typename T>
+mat<T, 4, 4> cofactor_inv(const mat<T, 4, 4>& M) {
+    T d{};
+
+    for (std::size_t c = 0; c < 4; ++ c) {
+        d += ((c & 1) ? - T{1L} : T{1L}) * M(0, c) * det(cut(M, {0, c}));
+    }
+
+    return detail::inv(M, T{1L} / d, std::make_index_sequence<16>());
+}
+
+/**
+ * Entries in [-1, 1], diagonal pushed away from 0 so that the condition
+ * number stays small.
+ */
+template <typename T>
+mat<T, 4, 4> random_invertible(std::mt19937& g) {
+    std::uniform_real_distribution<T> u(T{-1L}, T{1L});
+
+    mat<T, 4, 4> M{};
+
+    for (std::size_t i = 0; i < M.size; ++ i) {
+        M.data[i] = u(g);
+    }
+
+    for (std::size_t d = 0; d < 4; ++ d) {
+        M(d, d) += std::copysign(T{3L}, M(d, d));
+    }
+
+    return M;
+}
+
+/**
+ * Small integer entries, one row or column being zero, a copy of another one
+ * or the sum of two others : every path computes determinant 0 exactly.
+ */
+template <typename T>
+mat<T, 4, 4> random_singular(std::mt19937& g, std::size_t i) {
+    std::uniform_int_distribution<int> u(-4, 4);
+    std::uniform_int_distribution<std::size_t> index(0, 3);
+
+    mat<T, 4, 4> M{};
+
+    for (std::size_t k = 0; k < M.size; ++ k) {
+        M.data[k] = static_cast<T>(u(g));
+    }
+
+    const std::size_t a = index(g);
+    const std::size_t b = (a + 1 + index(g) % 3) % 4;
+    const std::size_t c = (b + 1) % 4 == a ? (b + 2) % 4 : (b + 1) % 4;
+
+    for (std::size_t k = 0; k < 4; ++ k) {
+        switch (i % 4) {
+        case 0:
+            M(a, k) = T{0L};
+            break;
+        case 1:
+            M(k, a) = M(k, b);
+            break;
+        case 2:
+            M(a, k) = M(b, k) + M(c, k);
+            break;
+        default:
+            M(k, a) = M(k, b) - M(k, c);
+            break;
+        }
+    }
+
+    return M;
+}
+
+template <typename T>
+void run(const char* type) {
+    // Paths round differently, cofactor expansion being the least accurate.
+    const T tolerance = std::numeric_limits<T>::epsilon() * T{64L};
+
+    std::mt19937 g(42);
+
+    T inv_diff{};
+#if EE_MATH_SSE
+    T native_diff{};
+#endif
+    T minors_diff{};
+    T try_inv_diff{};
+    T try_inv_det_diff{};
+    T row_major_diff{};
+
+    for (std::size_t i = 0; i < c_count; ++ i) {
+        const mat<T, 4, 4> M = random_invertible<T>(g);
+        const mat<T, 4, 4> M_inv = cofactor_inv(M);
+
+        inv_diff = std::max(inv_diff, max_diff(inv(M), M_inv));
+
+#if EE_MATH_SSE
+        if constexpr (std::is_same<T, float>::value) {
+            mat<T, 4, 4> R{};
+            T d{};
+
+            simd::inv(M, &R, &d);
+
+            native_diff = std::max(native_diff, max_diff(R, M_inv));
+        }
+#endif
+
+        T s[6]{};
+        T c[6]{};
+        mat<T, 4, 4> R{};
+
+        const T d = detail::inv_minors(M, s, c);
+
+        detail::inv_from_minors(M, s, c, T{1L} / d, &R);
+
+        minors_diff = std::max(minors_diff, max_diff(R, M_inv));
+
+        T try_d{};
+
+        if (try_inv(M, &R, &try_d)) {
+            try_inv_diff = std::max(try_inv_diff, max_diff(R, M_inv));
+            try_inv_det_diff = std::max(try_inv_det_diff, std::abs(try_d - det(M)) / std::abs(det(M)));
+        }
+        else {
+            try_inv_diff = std::numeric_limits<T>::infinity();
+        }
+
+        const mat<T, 4, 4, row_major> M_row_major = to_layout<row_major>(M);
+
+        row_major_diff = std::max(row_major_diff, max_diff(inv(M_row_major), to_layout<row_major>(M_inv)));
+    }
+
+    check(type, "inv vs cofactors", inv_diff, tolerance);
+#if EE_MATH_SSE
+    if constexpr (std::is_same<T, float>::value) {
+        check(type, "simd::inv vs cofactors", native_diff, tolerance);
+    }
+#endif
+    check(type, "inv_from_minors vs cofactors", minors_diff, tolerance);
+    check(type, "try_inv vs cofactors", try_inv_diff, tolerance);
+    check(type, "try_inv determinant vs det", try_inv_det_diff, tolerance);
+    check(type, "inv row-major vs cofactors", row_major_diff, tolerance);
+
+    bool singular_ok = true;
+
+    for (std::size_t i = 0; i < c_count; ++ i) {
+        const mat<T, 4, 4> M = random_singular<T>(g, i);
+        const mat<T, 4, 4> sentinel = c_identity<mat<T, 4, 4>> * T{7L};
+
+        mat<T, 4, 4> R = sentinel;
+        T d{1L};
+
+        singular_ok = singular_ok && ! try_inv(M, &R, &d) && d == T{0L} && R == sentinel;
+
+        mat<T, 4, 4, row_major> R_row_major = to_layout<row_major>(sentinel);
+
+        singular_ok = singular_ok && ! try_inv(to_layout<row_major>(M), &R_row_major)
+            && R_row_major == to_layout<row_major>(sentinel);
+
+        T s[6]{};
+        T c[6]{};
+
+        singular_ok = singular_ok && detail::inv_minors(M, s, c) == T{0L};
+
+#if EE_MATH_SSE
+        if constexpr (std::is_same<T, float>::value) {
+            R = sentinel;
+
+            singular_ok = singular_ok && ! simd::inv(M, &R, &d) && d == T{0L} && R == sentinel;
+        }
+#endif
+    }
+
+    check(type, "singular matrices rejected", singular_ok);
+}
+
+} // namespace
+
+int main() {
+    std::printf("EE_MATH_SIMD %d\n", EE_MATH_SIMD);
+
+    run<float>("float");
+    run<double>("double");
+
+    return g_failures == 0 ? 0 : 1;
+}
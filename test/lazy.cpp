@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * Lazy expressions against the eager operators, and operands the eager
+ * operators reject (other shape, size or layout) rejected as well.
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <type_traits>
+#include <utility>
+
+#include "../lazy.hpp"
+#include "../operators.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+int g_failures = 0;
+
+template <typename LT, typename RT, typename = void>
+struct has_add : std::false_type {};
+
+template <typename LT, typename RT>
+struct has_add<LT, RT, std::void_t<decltype(std::declval<const LT&>() + std::declval<const RT&>())>> : std::true_type {};
+
+template <typename LT, typename RT, typename = void>
+struct has_sub : std::false_type {};
+
+template <typename LT, typename RT>
+struct has_sub<LT, RT, std::void_t<decltype(std::declval<const LT&>() - std::declval<const RT&>())>> : std::true_type {};
+
+template <typename LT, typename RT>
+constexpr bool has_add_sub = has_add<LT, RT>::value && has_sub<LT, RT>::value;
+
+template <typename LT, typename RT>
+constexpr bool has_no_add_sub = ! has_add<LT, RT>::value && ! has_sub<LT, RT>::value;
+
+using mat4c = mat<double, 4, 4, column_major>;
+using mat4r = mat<double, 4, 4, row_major>;
+using lazy4c = lazy_ref<mat4c>;
+using lazy4r = lazy_ref<mat4r>;
+
+static_assert(has_add_sub<lazy4c, mat4c> && has_add_sub<mat4c, lazy4c> && has_add_sub<lazy4c, lazy4c>);
+static_assert(has_add_sub<lazy4r, mat4r> && has_add_sub<lazy4r, lazy4r>);
+
+// Same size, other layout.
+static_assert(has_no_add_sub<lazy4c, mat4r> && has_no_add_sub<mat4r, lazy4c> && has_no_add_sub<lazy4c, lazy4r>);
+
+// Same size, other shape.
+static_assert(has_no_add_sub<lazy_ref<mat<double, 2, 2>>, vec<double, 4>>);
+static_assert(has_no_add_sub<lazy_ref<vec<double, 4>>, quat<double>>);
+
+// Other value type.
+static_assert(has_no_add_sub<lazy4c, mat<float, 4, 4>>);
+
+// Deeper in an expression.
+static_assert(has_no_add_sub<decltype(std::declval<const lazy4c&>() * 2.0), mat4r>);
+
+template <typename M>
+void run(const char* name) {
+    M a{};
+    M b{};
+    M c{};
+
+    for (std::size_t i = 0; i < a.size; ++ i) {
+        a.data[i] = 0.25 * i - 1.0;
+        b.data[i] = 3.0 - 0.5 * i;
+        c.data[i] = 0.125 * i * i;
+    }
+
+    const M eager = a * 2.0 + b - c / 4.0;
+    const M lazy_result = lazy(a) * 2.0 + b - lazy(c) / 4.0;
+
+    bool ok = true;
+
+    for (std::size_t i = 0; i < a.size; ++ i) {
+        ok = ok && eager.data[i] == lazy_result.data[i];
+    }
+
+    std::printf("%-30s %s\n", name, ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    run<mat4c>("mat4x4 column major");
+    run<mat4r>("mat4x4 row major");
+    run<mat<double, 3, 4, row_major>>("mat3x4 row major");
+    run<vec<double, 3>>("vec3");
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,293 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * LU factorization and what goes through it (solve, det and inv from 5x5) on
+ * random matrices against cofactor expansion and the identity, and on rank
+ * deficient ones which must be flagged singular.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+#include "../constants.hpp"
+#include "../mat_functions.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+constexpr std::size_t c_count = 1000;
+
+int g_failures = 0;
+
+template <typename T>
+void check(const char* type, std::size_t D, const char* name, T diff, T tolerance) {
+    const bool ok = diff <= tolerance;
+
+    std::printf("%-7s %zux%zu %-32s max diff %-12g %s\n", type, D, D, name, static_cast<double>(diff),
+        ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+void check(const char* type, std::size_t D, const char* name, bool ok) {
+    std::printf("%-7s %zux%zu %-32s %s\n", type, D, D, name, ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+template <typename X>
+auto max_abs(const X& x) {
+    typename X::value_type result{};
+
+    for (std::size_t i = 0; i < x.size; ++ i) {
+        result = std::max(result, std::abs(x.data[i]));
+    }
+
+    return result;
+}
+
+/**
+ * Determinant from cofactor expansion along the first row, down to the 4x4
+ * overload.
+ */
+template <typename T, std::size_t D>
+T cofactor_det(const mat<T, D, D>& M) {
+    if constexpr (D <= 4) {
+        return det(M);
+    }
+    else {
+        T result{};
+
+        for (std::size_t c = 0; c < D; ++ c) {
+            result += ((c & 1) ? - T{1L} : T{1L}) * M(0, c) * cofactor_det(cut(M, {0, c}));
+        }
+
+        return result;
+    }
+}
+
+/**
+ * mat or vec, entries in [-1, 1].
+ */
+template <typename X>
+X random(std::mt19937& g) {
+    std::uniform_real_distribution<typename X::value_type> u(-1, 1);
+
+    X x{};
+
+    for (std::size_t i = 0; i < x.size; ++ i) {
+        x.data[i] = u(g);
+    }
+
+    return x;
+}
+
+/**
+ * Diagonal pushed away from 0 so that the condition number stays small.
+ */
+template <typename T, std::size_t D>
+mat<T, D, D> random_invertible(std::mt19937& g) {
+    mat<T, D, D> M = random<mat<T, D, D>>(g);
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        M(d, d) += std::copysign(T{static_cast<long double>(D)}, M(d, d));
+    }
+
+    return M;
+}
+
+/**
+ * Small integer entries, a zero row or column, or a column copy or
+ * difference of others.
+ */
+template <typename T, std::size_t D>
+mat<T, D, D> random_rank_deficient(std::mt19937& g, std::size_t i) {
+    std::uniform_int_distribution<int> u(-4, 4);
+    std::uniform_int_distribution<std::size_t> index(0, D - 1);
+
+    mat<T, D, D> M{};
+
+    for (std::size_t k = 0; k < M.size; ++ k) {
+        M.data[k] = static_cast<T>(u(g));
+    }
+
+    const std::size_t a = index(g);
+    const std::size_t b = (a + 1) % D;
+    const std::size_t c = (a + 2) % D;
+
+    for (std::size_t k = 0; k < D; ++ k) {
+        switch (i % 4) {
+        case 0:
+            M(a, k) = T{0L};
+            break;
+        case 1:
+            M(k, a) = T{0L};
+            break;
+        case 2:
+            M(k, a) = M(k, b);
+            break;
+        default:
+            M(k, a) = M(k, b) - M(k, c);
+            break;
+        }
+    }
+
+    return M;
+}
+
+template <typename T, std::size_t D>
+void run(const char* type) {
+    const T eps = std::numeric_limits<T>::epsilon();
+    const T tolerance = eps * T{static_cast<long double>(16 * D)};
+
+    std::mt19937 g(42);
+
+    T factors_diff{};
+    T identity_diff{};
+    T residual{};
+    T try_inv_diff{};
+    T det_diff{};
+    T row_major_diff{};
+
+    for (std::size_t i = 0; i < c_count; ++ i) {
+        const mat<T, D, D> M = random_invertible<T, D>(g);
+        const vec<T, D> b = random<vec<T, D>>(g);
+
+        const auto f = lu(M);
+
+        // P ∙ M = L ∙ U
+        mat<T, D, D> PM{};
+        mat<T, D, D> LU{};
+
+        for (std::size_t r = 0; r < D; ++ r) {
+            for (std::size_t c = 0; c < D; ++ c) {
+                PM(r, c) = M(f.perm(r), c);
+
+                for (std::size_t k = 0; k <= std::min(r, c); ++ k) {
+                    LU(r, c) += (k == r ? T{1L} : f.lu(r, k)) * f.lu(k, c);
+                }
+            }
+        }
+
+        factors_diff = std::max(factors_diff, max_abs(PM - LU) / max_abs(M));
+
+        const mat<T, D, D> M_inv = inv(M);
+
+        identity_diff = std::max(identity_diff, max_abs(M * M_inv - c_identity<mat<T, D, D>>));
+
+        const vec<T, D> x = solve(M, b);
+
+        residual = std::max(residual, max_abs(M * x - b) / (max_abs(M) * max_abs(x)));
+
+        mat<T, D, D> R{};
+        T d{};
+
+        try_inv_diff = try_inv(M, &R, &d) ?
+            std::max(try_inv_diff, max_abs(R - M_inv) / max_abs(M_inv)) : std::numeric_limits<T>::infinity();
+
+        if constexpr (D <= 6) {
+            const T cofactor_d = cofactor_det(M);
+
+            det_diff = std::max(det_diff, std::abs(det(M) - cofactor_d) / std::abs(cofactor_d));
+        }
+
+        const auto f_row_major = lu(to_layout<row_major>(M));
+
+        row_major_diff = std::max(row_major_diff, max_abs(f_row_major.lu - f.lu));
+    }
+
+    check(type, D, "P M vs L U", factors_diff, tolerance);
+    check(type, D, "M inv(M) vs identity", identity_diff, tolerance);
+    check(type, D, "solve residual", residual, tolerance);
+    check(type, D, "try_inv vs inv", try_inv_diff, T{0L});
+    if constexpr (D <= 6) {
+        check(type, D, "det vs cofactors", det_diff, tolerance);
+    }
+    check(type, D, "row-major lu", row_major_diff, T{0L});
+
+    bool singular_ok = true;
+
+    for (std::size_t i = 0; i < c_count; ++ i) {
+        const mat<T, D, D> M = random_rank_deficient<T, D>(g, i);
+        const mat<T, D, D> sentinel = c_identity<mat<T, D, D>> * T{7L};
+
+        mat<T, D, D> R = sentinel;
+
+        singular_ok = singular_ok && lu(M).singular && ! try_inv(M, &R) && R == sentinel;
+    }
+
+    check(type, D, "rank deficient flagged singular", singular_ok);
+}
+
+/**
+ * det of the LU factorization against cofactor expansion at 4x4, where det()
+ * itself does not use it : random matrices, which need row swaps, and
+ * permutation matrices, which test parity exactly.
+ */
+template <typename T>
+void run_parity(const char* type) {
+    const T tolerance = std::numeric_limits<T>::epsilon() * T{256L};
+
+    std::mt19937 g(42);
+
+    T det_diff{};
+
+    for (std::size_t i = 0; i < c_count; ++ i) {
+        const mat<T, 4, 4> M = random<mat<T, 4, 4>>(g);
+        const T d = det(M);
+
+        det_diff = std::max(det_diff, std::abs(det(lu(M)) - d) / std::pow(max_abs(M), T{4L}));
+    }
+
+    check(type, 4, "det(lu) vs cofactors", det_diff, tolerance);
+
+    bool parity_ok = true;
+
+    vec<std::size_t, 4> p{0, 1, 2, 3};
+
+    do {
+        mat<T, 4, 4> P{};
+
+        for (std::size_t r = 0; r < 4; ++ r) {
+            P(r, p(r)) = T{1L};
+        }
+
+        const auto f = lu(P);
+
+        parity_ok = parity_ok && ! f.singular && det(f) == det(P) && f.parity == det(P);
+    } while (std::next_permutation(p.data, p.data + 4));
+
+    check(type, 4, "parity of permutations", parity_ok);
+}
+
+template <typename T>
+void run_all(const char* type) {
+    run_parity<T>(type);
+    run<T, 5>(type);
+    run<T, 6>(type);
+    run<T, 7>(type);
+    run<T, 8>(type);
+}
+
+} // namespace
+
+int main() {
+    run_all<float>("float");
+    run_all<double>("double");
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * gather and scatter round trips of vec, quat and mat in 2 to 16 lanes, full
+ * and partial, whichever of the transposition by blocks, the block shuffles
+ * or the lane by lane path they take. Built for SSE2, AVX2 and AVX-512, the
+ * widest register size changing the path.
+ */
+
+#include <cstddef>
+#include <cstdio>
+
+#include "../pack.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+int g_failures = 0;
+
+std::size_t g_paths[3] = {};
+
+/**
+ * Shuffle indices pick lanes of two packs only.
+ */
+constexpr bool shuffle_indices_in_range() {
+    for (std::size_t n = 2; n <= 16; n *= 2) {
+        for (std::size_t s = 2; s <= 16; ++ s) {
+            for (std::size_t d = 0; d < s; ++ d) {
+                for (std::size_t j = 0; j < s; ++ j) {
+                    for (std::size_t l = 0; l < n; ++ l) {
+                        if (detail::gather_index(s, n, d, j, l) >= 2 * n) {
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            for (std::size_t j = 0; j < s; ++ j) {
+                for (std::size_t t = 1; t < s; ++ t) {
+                    for (std::size_t k = 0; k < n; ++ k) {
+                        if (detail::scatter_index(s, n, j, t, k) >= 2 * n) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static_assert(shuffle_indices_in_range(), "shuffle index out of range");
+
+/**
+ * Component d of element l, distinct and exact in float.
+ */
+template <typename T>
+T value(std::size_t l, std::size_t d) {
+    return static_cast<T>(l * 64 + d + 1);
+}
+
+template <typename E, std::size_t N>
+bool round_trip() {
+    using T = typename E::value_type;
+
+    g_paths[detail::c_transpose_by_blocks<E, N> ? 0 : detail::c_gather_by_shuffles<E, N> ? 1 : 2] += 1;
+
+    // One more element, which scatters must leave untouched.
+    E p[N + 1]{};
+    E sentinel{};
+
+    for (std::size_t d = 0; d < E::size; ++ d) {
+        sentinel.data[d] = T{-1L};
+    }
+
+    for (std::size_t l = 0; l < N; ++ l) {
+        for (std::size_t d = 0; d < E::size; ++ d) {
+            p[l].data[d] = value<T>(l, d);
+        }
+    }
+
+    p[N] = sentinel;
+
+    bool ok = true;
+
+    for (std::size_t n = 1; n <= N; ++ n) {
+        const wide<E, N> w = gather<N>(p, n);
+
+        for (std::size_t l = 0; l < N; ++ l) {
+            for (std::size_t d = 0; d < E::size; ++ d) {
+                ok = ok && w.data[d][l] == (l < n ? value<T>(l, d) : T{0L});
+            }
+        }
+
+        E q[N + 1];
+
+        for (std::size_t l = 0; l <= N; ++ l) {
+            q[l] = sentinel;
+        }
+
+        scatter(w, q, n);
+
+        for (std::size_t l = 0; l <= N; ++ l) {
+            for (std::size_t d = 0; d < E::size; ++ d) {
+                ok = ok && q[l].data[d] == (l < n ? value<T>(l, d) : T{-1L});
+            }
+        }
+    }
+
+    return ok;
+}
+
+template <typename E>
+void run(const char* type, const char* name) {
+    const bool ok = round_trip<E, 2>() && round_trip<E, 4>() && round_trip<E, 8>() && round_trip<E, 16>();
+
+    std::printf("%-7s %-10s 2 to 16 lanes %s\n", type, name, ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+template <typename T>
+void run_all(const char* type) {
+    run<vec<T, 2>>(type, "vec2");
+    run<vec<T, 3>>(type, "vec3");
+    run<vec<T, 4>>(type, "vec4");
+    run<quat<T>>(type, "quat");
+    run<mat<T, 2, 2>>(type, "mat2x2");
+    run<mat<T, 3, 3>>(type, "mat3x3");
+    run<mat<T, 3, 4>>(type, "mat3x4");
+    run<mat<T, 4, 4>>(type, "mat4x4");
+}
+
+} // namespace
+
+int main() {
+#if defined(__AVX512F__)
+    if (! __builtin_cpu_supports("avx512f")) {
+        std::printf("no AVX-512, skipped\n");
+
+        return 0;
+    }
+#elif defined(__AVX2__)
+    if (! __builtin_cpu_supports("avx2")) {
+        std::printf("no AVX2, skipped\n");
+
+        return 0;
+    }
+#endif
+
+    std::printf("widest registers of %zu bytes\n", detail::c_register_size);
+
+    run_all<float>("float");
+    run_all<double>("double");
+
+    std::printf("paths : %zu by blocks, %zu by shuffles, %zu lane by lane\n", g_paths[0], g_paths[1], g_paths[2]);
+
+    return g_failures == 0 ? 0 : 1;
+}
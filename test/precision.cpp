@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+/**
+ * sin, cos and sincos of the fast and fastest policies against libm, across
+ * the end of their exact argument reduction (2^16 pi / 2, about 1.03e5) and
+ * far beyond it, where they must fall back to libm.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+
+#include "../functions.hpp"
+
+using namespace ee::math;
+
+namespace {
+
+int g_failures = 0;
+
+template <typename T>
+void check(const char* type, const char* name, T diff, T tolerance) {
+    const bool ok = diff <= tolerance;
+
+    std::printf("%-7s %-36s max diff %-12g %s\n", type, name, static_cast<double>(diff), ok ? "ok" : "FAILED");
+
+    if (! ok) {
+        ++ g_failures;
+    }
+}
+
+/**
+ * Largest difference of sin, cos and sincos with policy P from libm.
+ */
+template <typename T, typename P>
+T max_diff(T x) {
+    const sin_cos<T> sc = ee::math::sincos(x, P{});
+
+    return std::max({
+        std::abs(ee::math::sin(x, P{}) - std::sin(x)),
+        std::abs(ee::math::cos(x, P{}) - std::cos(x)),
+        std::abs(sc.sin - std::sin(x)),
+        std::abs(sc.cos - std::cos(x))});
+}
+
+template <typename T, typename P>
+void run(const char* type, const char* policy, T tolerance) {
+    const T boundary = static_cast<T>(65536.0L * 1.57079632679489661923L);
+
+    T near_diff{};
+    T beyond_diff{};
+
+    // Both sides of the boundary, by a step unrelated to pi, and the values
+    // next to it.
+    for (T x = boundary * T{0.5L}; x < boundary * T{1.5L}; x += T{7.31L}) {
+        near_diff = std::max({near_diff, max_diff<T, P>(x), max_diff<T, P>(- x)});
+    }
+
+    T x = boundary;
+
+    for (int i = 0; i < 64; ++ i) {
+        near_diff = std::max(near_diff, max_diff<T, P>(x));
+        x = std::nextafter(x, std::numeric_limits<T>::max());
+    }
+
+    // Far beyond : libm results, to the bit.
+    for (const T v : {T{2e5L}, T{-2e5L}, T{1e7L}, T{1e10L}, T{-1e20L}, T{1e30L}, std::numeric_limits<T>::max()}) {
+        beyond_diff = std::max(beyond_diff, max_diff<T, P>(v));
+    }
+
+    std::printf("%-7s %s\n", type, policy);
+    check(type, "around the reduction boundary", near_diff, tolerance);
+    check(type, "beyond it", beyond_diff, T{0L});
+
+    const T inf = std::numeric_limits<T>::infinity();
+    const bool nan_ok = std::isnan(ee::math::sin(inf, P{})) && std::isnan(ee::math::cos(- inf, P{})) &&
+        std::isnan(ee::math::sincos(std::numeric_limits<T>::quiet_NaN(), P{}).sin);
+
+    check(type, "not finite gives NaN", nan_ok ? T{0L} : T{1L}, T{0L});
+}
+
+} // namespace
+
+int main() {
+    // Policy error plus the argument rounding of float near 1e5.
+    run<float, fast>("float", "fast", 2e-6f);
+    run<float, fastest>("float", "fastest", 5e-5f);
+    run<double, fast>("double", "fast", 2e-9);
+    run<double, fastest>("double", "fastest", 4e-5);
+
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ee {
+namespace math {
+
+/**
+ * Work stealing thread pool for batch functions.
+ * parallel_for splits [0, n) into chunks of grain indices, each participant
+ * (the pool threads and the calling one) getting a contiguous share of them in
+ * its own queue. Participants run their own chunks in order and, once done,
+ * steal from the back of the others' queues, so uneven chunks still balance.
+ * One parallel_for runs at a time, concurrent calls wait their turn. f must
+ * not throw.
+ * A parallel_for called from f on the same pool runs its whole range inline,
+ * on the thread running f. f must not otherwise wait on the pool, e.g. through
+ * a call to another pool whose own chunks call back into this one : that
+ * still deadlocks.
+ */
+class thread_pool {
+public:
+    /**
+     * thread_count participants, the calling thread being one of them.
+     */
+    explicit thread_pool(std::size_t thread_count = std::thread::hardware_concurrency()) {
+        thread_count = std::max<std::size_t>(thread_count, 1);
+
+        for (std::size_t i = 0; i < thread_count; ++ i) {
+            m_queues.emplace_back(new queue);
+        }
+
+        for (std::size_t i = 1; i < thread_count; ++ i) {
+            m_threads.emplace_back([this, i] { loop(i); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+
+        m_wake.notify_all();
+
+        for (auto& t : m_threads) {
+            t.join();
+        }
+    }
+
+    /**
+     * Number of participants, calling thread included.
+     */
+    std::size_t size() const {
+        return m_queues.size();
+    }
+
+    /**
+     * Call f(begin, end) over [0, n), by chunks of grain indices, and return
+     * once all of them are done.
+     */
+    template <typename F>
+    void parallel_for(std::size_t n, std::size_t grain, F&& f) {
+        grain = std::max<std::size_t>(grain, 1);
+
+        if (n <= grain || size() == 1 || running() == this) {
+            if (n != 0) {
+                f(std::size_t{0}, n);
+            }
+
+            return;
+        }
+
+        using G = std::remove_reference_t<F>;
+
+        run(n, grain, [](void* context, std::size_t begin, std::size_t end) {
+            (*static_cast<G*>(context))(begin, end);
+        }, const_cast<void*>(static_cast<const void*>(std::addressof(f))));
+    }
+
+private:
+    struct range {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct queue {
+        std::mutex mutex;
+        std::deque<range> ranges;
+    };
+
+    using call_type = void (*)(void*, std::size_t, std::size_t);
+
+    /**
+     * Pool which chunks the current thread is running, if any.
+     */
+    static const thread_pool*& running() {
+        static thread_local const thread_pool* pool = nullptr;
+
+        return pool;
+    }
+
+    void run(std::size_t n, std::size_t grain, call_type call, void* context) {
+        std::lock_guard<std::mutex> run_lock(m_run_mutex);
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            // Late wakers of the previous run must be gone before its queues
+            // and call are replaced.
+            m_done.wait(lock, [this] { return m_active == 0; });
+
+            const std::size_t chunks = (n + grain - 1) / grain;
+
+            for (std::size_t q = 0; q < size(); ++ q) {
+                std::lock_guard<std::mutex> queue_lock(m_queues[q]->mutex);
+
+                for (std::size_t c = chunks * q / size(); c < chunks * (q + 1) / size(); ++ c) {
+                    m_queues[q]->ranges.push_back({c * grain, std::min(n, (c + 1) * grain)});
+                }
+            }
+
+            m_call = call;
+            m_context = context;
+            ++ m_generation;
+        }
+
+        m_wake.notify_all();
+
+        work(0);
+
+        // Queues are empty, wait for chunks still running elsewhere.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_active == 0; });
+    }
+
+    void loop(std::size_t index) {
+        std::size_t generation = 0;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_generation != generation; });
+
+                if (m_stop) {
+                    return;
+                }
+
+                generation = m_generation;
+                ++ m_active;
+            }
+
+            work(index);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                -- m_active;
+            }
+
+            m_done.notify_all();
+        }
+    }
+
+    void work(std::size_t index) {
+        const thread_pool* outer = running();
+        running() = this;
+
+        range r;
+
+        while (pop(index, &r) || steal(index, &r)) {
+            m_call(m_context, r.begin, r.end);
+        }
+
+        running() = outer;
+    }
+
+    bool pop(std::size_t index, range* r) {
+        queue& q = *m_queues[index];
+        std::lock_guard<std::mutex> lock(q.mutex);
+
+        if (q.ranges.empty()) {
+            return false;
+        }
+
+        *r = q.ranges.front();
+        q.ranges.pop_front();
+
+        return true;
+    }
+
+    bool steal(std::size_t index, range* r) {
+        for (std::size_t i = 1; i < size(); ++ i) {
+            queue& q = *m_queues[(index + i) % size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+
+            if (!q.ranges.empty()) {
+                *r = q.ranges.back();
+                q.ranges.pop_back();
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_run_mutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    call_type m_call = nullptr;
+    void* m_context = nullptr;
+    std::size_t m_generation = 0;
+    std::size_t m_active = 0;
+    bool m_stop = false;
+};
+
+} // namespace math
+} // namespace ee
@@ -0,0 +1,273 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+#include "constants.hpp"
+#include "mat.hpp"
+#include "operators.hpp"
+#include "quat.hpp"
+#include "vec.hpp"
+#include "vec_functions.hpp"
+
+/**
+ * Types carrying an invariant : unit<vec<T, D>> and unit<quat<T>> have a
+ * magnitude of 1, orthonormal<mat<T, N, N, L>> has orthonormal columns, its
+ * inverse being its transpose.
+ * Constructors establish the invariant, normalizing or orthonormalizing their
+ * argument, while as_unit and as_orthonormal take values already known to
+ * hold it. Functions of unit_functions.hpp then skip normalizations and full
+ * inversions, and keep the type when they preserve the invariant, e.g. unit
+ * quaternion or orthonormal matrix products.
+ * Debug builds (NDEBUG not defined) assert the invariant on construction, up
+ * to a tolerance catching wrong values rather than rounding drift. Products
+ * keeping the invariant are single products, their rounding adding up along
+ * chains : renormalize and reorthonormalize remove it.
+ * Both convert to the wrapped type, get() returning it.
+ */
+
+namespace ee {
+namespace math {
+
+namespace detail {
+
+/**
+ * Tag of constructors trusting their argument.
+ */
+struct trusted {};
+
+/**
+ * Tolerance of invariant checks on squared magnitudes and dot products : room
+ * for some 10^5 chained float products (10^7 and more in double) before
+ * renormalize or reorthonormalize has to be called.
+ */
+template <typename T>
+constexpr T c_invariant_tolerance = std::is_same<T, float>::value ? T{1e-2L} : T{1e-7L};
+
+template <typename T>
+constexpr bool is_near_one(T v) {
+    return v - T{1L} <= c_invariant_tolerance<T> && T{1L} - v <= c_invariant_tolerance<T>;
+}
+
+template <typename T>
+constexpr bool is_near_zero(T v) {
+    return v <= c_invariant_tolerance<T> && - v <= c_invariant_tolerance<T>;
+}
+
+/**
+ * Tell if M has orthonormal columns, up to the tolerance.
+ */
+template <typename T, std::size_t N, typename L>
+constexpr bool has_orthonormal_columns(const mat<T, N, N, L>& M) {
+    for (std::size_t i = 0; i < N; ++ i) {
+        for (std::size_t j = i; j < N; ++ j) {
+            T d{};
+
+            for (std::size_t r = 0; r < N; ++ r) {
+                d += M(r, i) * M(r, j);
+            }
+
+            if (! (i == j ? is_near_one(d) : is_near_zero(d))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * Normalized vec or quat.
+ */
+template <typename X>
+class unit {
+public:
+    static_assert(is_vec<X> || is_quat<X>, "X must be a vec or a quat");
+    static_assert(std::is_floating_point<typename X::value_type>::value, "X must have floating point components");
+
+    using type       = X;
+    using value_type = typename X::value_type;
+
+    constexpr static std::size_t size = X::size;
+
+    /**
+     * Identity quaternion, or first axis.
+     */
+    constexpr unit() : m_value(identity()) {}
+
+    /**
+     * Normalize x, which must not be null.
+     */
+    constexpr explicit unit(const X& x) : unit(normalize(x), detail::trusted{}) {}
+
+    /**
+     * x, which must be normalized. See as_unit.
+     */
+    constexpr unit(const X& x, detail::trusted) : m_value(x) {
+        assert(detail::is_near_one(mag2(x)) && "unit : value is not normalized");
+    }
+
+    constexpr const X& get() const {
+        return m_value;
+    }
+
+    constexpr operator const X&() const {
+        return m_value;
+    }
+
+    constexpr value_type operator()(std::size_t i) const {
+        return m_value(i);
+    }
+
+    constexpr value_type operator[](std::size_t i) const {
+        return m_value(i);
+    }
+
+private:
+    constexpr static X identity() {
+        if constexpr (is_quat<X>) {
+            return c_identity<X>;
+        } else {
+            X result{};
+
+            result(0) = value_type{1L};
+
+            return result;
+        }
+    }
+
+    X m_value;
+};
+
+/**
+ * Square matrix with orthonormal columns : a rotation, or a reflection.
+ */
+template <typename M>
+class orthonormal {
+public:
+    static_assert(is_mat<M>, "M must be a mat");
+    static_assert(M::rows == M::columns, "M must be square");
+    static_assert(std::is_floating_point<typename M::value_type>::value, "M must have floating point components");
+
+    using type       = M;
+    using value_type = typename M::value_type;
+    using layout     = typename M::layout;
+
+    constexpr static std::size_t size    = M::size;
+    constexpr static std::size_t rows    = M::rows;
+    constexpr static std::size_t columns = M::columns;
+
+    /**
+     * Identity.
+     */
+    constexpr orthonormal() : m_value(c_identity<M>) {}
+
+    /**
+     * Orthonormalize columns of m, which must be linearly independent, by
+     * modified Gram-Schmidt : column c keeps the direction of its part
+     * orthogonal to the previous ones, e.g. to remove drift of a rotation.
+     */
+    constexpr explicit orthonormal(const M& m) : orthonormal(orthonormalize_columns(m), detail::trusted{}) {}
+
+    /**
+     * m, which must be orthonormal. See as_orthonormal.
+     */
+    constexpr orthonormal(const M& m, detail::trusted) : m_value(m) {
+        assert(detail::has_orthonormal_columns(m) && "orthonormal : columns are not orthonormal");
+    }
+
+    constexpr const M& get() const {
+        return m_value;
+    }
+
+    constexpr operator const M&() const {
+        return m_value;
+    }
+
+    constexpr value_type operator()(std::size_t r, std::size_t c) const {
+        return m_value(r, c);
+    }
+
+private:
+    constexpr static M orthonormalize_columns(const M& m) {
+        vec<value_type, rows> v[columns]{};
+
+        for (std::size_t c = 0; c < columns; ++ c) {
+            for (std::size_t r = 0; r < rows; ++ r) {
+                v[c](r) = m(r, c);
+            }
+
+            for (std::size_t p = 0; p < c; ++ p) {
+                v[c] = v[c] - dot(v[p], v[c]) * v[p];
+            }
+
+            v[c] = normalize(v[c]);
+        }
+
+        M result{};
+
+        for (std::size_t c = 0; c < columns; ++ c) {
+            for (std::size_t r = 0; r < rows; ++ r) {
+                result(r, c) = v[c](r);
+            }
+        }
+
+        return result;
+    }
+
+    M m_value;
+};
+
+/**
+ * A way to identify them.
+ */
+namespace detail {
+
+template <typename>
+struct is_unit_impl : std::false_type {};
+
+template <typename X>
+struct is_unit_impl<unit<X>> : std::true_type {};
+
+template <typename>
+struct is_orthonormal_impl : std::false_type {};
+
+template <typename M>
+struct is_orthonormal_impl<orthonormal<M>> : std::true_type {};
+
+} // namespace detail
+
+template <typename T>
+constexpr bool is_unit = detail::is_unit_impl<std::decay_t<T>>::value;
+
+template <typename T>
+constexpr bool is_orthonormal = detail::is_orthonormal_impl<std::decay_t<T>>::value;
+
+/**
+ * Wrap x, known to be normalized, without normalizing it.
+ */
+template <typename X>
+constexpr unit<X> as_unit(const X& x) {
+    return {x, detail::trusted{}};
+}
+
+/**
+ * Wrap m, known to be orthonormal, e.g. a rotation matrix.
+ */
+template <typename M>
+constexpr orthonormal<M> as_orthonormal(const M& m) {
+    return {m, detail::trusted{}};
+}
+
+} // namespace math
+} // namespace ee
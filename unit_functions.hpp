@@ -0,0 +1,369 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <ee_utils/templates.hpp>
+
+#include "basis.hpp"
+#include "basis_functions.hpp"
+#include "mat.hpp"
+#include "mat_functions.hpp"
+#include "operators.hpp"
+#include "quat.hpp"
+#include "quat_functions.hpp"
+#include "unit.hpp"
+#include "vec.hpp"
+#include "vec_functions.hpp"
+
+/**
+ * Functions taking unit and orthonormal values : what their invariant makes
+ * free is skipped, results keep the type when the invariant holds for them.
+ * Others take them through get() or their conversion.
+ */
+
+namespace ee {
+namespace math {
+
+using tutil::eif;
+
+namespace detail {
+
+/**
+ * Value wrapped by a unit or an orthonormal, t itself otherwise.
+ */
+template <typename T>
+constexpr const auto& unwrap(const T& t) {
+    if constexpr (is_unit<T> || is_orthonormal<T>) {
+        return t.get();
+    } else {
+        return t;
+    }
+}
+
+template <typename T>
+using unwrapped_t = std::decay_t<decltype(unwrap(std::declval<const T&>()))>;
+
+template <typename A, typename B>
+constexpr bool has_unit = is_unit<A> || is_unit<B>;
+
+template <typename A, typename B>
+constexpr bool has_wrapped = has_unit<A, B> || is_orthonormal<A> || is_orthonormal<B>;
+
+} // namespace detail
+
+/**
+ * Comparison operators.
+ */
+
+template <typename A, typename B>
+constexpr eif<detail::has_wrapped<A, B>, bool> operator==(const A& lhs, const B& rhs) {
+    return detail::unwrap(lhs) == detail::unwrap(rhs);
+}
+
+template <typename A, typename B>
+constexpr eif<detail::has_wrapped<A, B>, bool> operator!=(const A& lhs, const B& rhs) {
+    return ! (lhs == rhs);
+}
+
+/**
+ * Vectors and quaternions.
+ */
+
+/**
+ * Opposite, still normalized.
+ */
+template <typename X>
+constexpr unit<X> operator-(const unit<X>& u) {
+    return as_unit(- u.get());
+}
+
+/**
+ * Arithmetic operators, on the wrapped values.
+ */
+template <typename X, typename S>
+constexpr eif<is_num<S>, X> operator*(const unit<X>& lhs, S rhs) {
+    return lhs.get() * rhs;
+}
+
+template <typename S, typename X>
+constexpr eif<is_num<S>, X> operator*(S lhs, const unit<X>& rhs) {
+    return lhs * rhs.get();
+}
+
+template <typename X, typename S>
+constexpr eif<is_num<S>, X> operator/(const unit<X>& lhs, S rhs) {
+    return lhs.get() / rhs;
+}
+
+template <typename A, typename B>
+constexpr eif<detail::has_unit<A, B>, detail::unwrapped_t<A>> operator+(const A& lhs, const B& rhs) {
+    return detail::unwrap(lhs) + detail::unwrap(rhs);
+}
+
+template <typename A, typename B>
+constexpr eif<detail::has_unit<A, B>, detail::unwrapped_t<A>> operator-(const A& lhs, const B& rhs) {
+    return detail::unwrap(lhs) - detail::unwrap(rhs);
+}
+
+/**
+ * Return 1.
+ */
+template <typename X>
+constexpr auto mag2(const unit<X>&) {
+    return typename X::value_type{1L};
+}
+
+template <typename X>
+constexpr auto mag(const unit<X>&) {
+    return typename X::value_type{1L};
+}
+
+template <typename X, typename P>
+constexpr eif<is_precision<P>, typename X::value_type> mag(const unit<X>&, P) {
+    return typename X::value_type{1L};
+}
+
+/**
+ * Return u, already normalized.
+ */
+template <typename X>
+constexpr unit<X> normalize(const unit<X>& u) {
+    return u;
+}
+
+template <typename X, typename P>
+constexpr eif<is_precision<P>, unit<X>> normalize(const unit<X>& u, P) {
+    return u;
+}
+
+/**
+ * Return u with its rounding drift removed, by one Newton step of
+ * 1 / sqrt(mag2(u)) from 1 : a dot product and a scale.
+ * Products keeping u normalized round by a few ulps each, call it every few
+ * thousand of them along long chains (camera or skeleton updates).
+ */
+template <typename X>
+constexpr unit<X> renormalize(const unit<X>& u) {
+    using T = typename X::value_type;
+
+    return as_unit(u.get() * (T{1.5L} - T{0.5L} * mag2(u.get())));
+}
+
+template <typename A, typename B>
+constexpr eif<detail::has_unit<A, B>, typename detail::unwrapped_t<A>::value_type> dot(const A& lhs, const B& rhs) {
+    return dot(detail::unwrap(lhs), detail::unwrap(rhs));
+}
+
+template <typename A, typename B>
+constexpr eif<detail::has_unit<A, B>, detail::unwrapped_t<A>> cross(const A& lhs, const B& rhs) {
+    return cross(detail::unwrap(lhs), detail::unwrap(rhs));
+}
+
+/**
+ * Gram-Schmidt orthonormalize, i being normalized by type. Returned vector
+ * is normalized once.
+ */
+template <typename T, typename V>
+constexpr unit<vec<T, 3>> orthonormalize(const unit<vec<T, 3>>& i, const V& almost_j) {
+    return as_unit(orthonormalize(i.get(), static_cast<const vec<T, 3>&>(detail::unwrap(almost_j))));
+}
+
+/**
+ * Generate orthonormal vectors, i being normalized by type. Only k is
+ * normalized, j being the cross product of orthonormal i and k.
+ */
+template <typename T, typename V>
+void orthonormal_basis(const unit<vec<T, 3>>& i, const V& almost_j, unit<vec<T, 3>>* j, unit<vec<T, 3>>* k) {
+    *k = unit<vec<T, 3>>(cross(static_cast<const vec<T, 3>&>(detail::unwrap(almost_j)), i.get()));
+    *j = as_unit(cross(i.get(), k->get()));
+}
+
+/**
+ * Quaternions.
+ */
+
+/**
+ * Hamilton product, still normalized up to rounding (see renormalize).
+ */
+template <typename T>
+constexpr unit<quat<T>> operator*(const unit<quat<T>>& q1, const unit<quat<T>>& q2) {
+    return as_unit(q1.get() * q2.get());
+}
+
+template <typename T>
+constexpr const unit<quat<T>>& operator*=(unit<quat<T>>& lhs, const unit<quat<T>>& rhs) {
+    lhs = lhs * rhs;
+
+    return lhs;
+}
+
+template <typename T>
+constexpr unit<quat<T>> conjugate(const unit<quat<T>>& q) {
+    return as_unit(conjugate(q.get()));
+}
+
+/**
+ * Return the inverse of q : its conjugate, no division.
+ */
+template <typename T>
+constexpr unit<quat<T>> inv(const unit<quat<T>>& q) {
+    return conjugate(q);
+}
+
+/**
+ * Rotate v by q.
+ */
+template <typename T>
+constexpr vec<T, 3> rotate(const unit<quat<T>>& q, const vec<T, 3>& v) {
+    return rotate(q.get(), v);
+}
+
+/**
+ * Rotate v by q, a rotation keeping it normalized.
+ */
+template <typename T>
+constexpr unit<vec<T, 3>> rotate(const unit<quat<T>>& q, const unit<vec<T, 3>>& v) {
+    return as_unit(rotate(q.get(), v.get()));
+}
+
+/**
+ * Return a basis vector of the rotation q, normalized.
+ */
+template <typename T, typename D>
+constexpr unit<vec<T, 3>> basis_vector(const unit<quat<T>>& q, D d) {
+    return as_unit(basis_vector(q.get(), d));
+}
+
+/**
+ * Return the rotation matrix of q : orthonormal when square.
+ */
+template <std::size_t R, std::size_t C, typename T>
+constexpr auto mat_from(const unit<quat<T>>& q) {
+    if constexpr (R == C) {
+        return as_orthonormal(mat_from<R, C>(q.get()));
+    } else {
+        return mat_from<R, C>(q.get());
+    }
+}
+
+template <typename T>
+constexpr orthonormal<mat<T, 4, 4>> mat_from(const unit<quat<T>>& q) {
+    return mat_from<4, 4>(q);
+}
+
+/**
+ * Return the normalized quaternion of rotation m.
+ */
+template <typename T, std::size_t N, typename L>
+unit<quat<T>> quat_from(const orthonormal<mat<T, N, N, L>>& m) {
+    return as_unit(quat_from(m.get()));
+}
+
+template <typename T>
+unit<quat<T>> nlerp(const unit<quat<T>>& q1, const unit<quat<T>>& q2, T t) {
+    return as_unit(nlerp(q1.get(), q2.get(), t));
+}
+
+template <typename T>
+unit<quat<T>> slerp(const unit<quat<T>>& q1, const unit<quat<T>>& q2, T t) {
+    return as_unit(slerp(q1.get(), q2.get(), t));
+}
+
+/**
+ * Matrices.
+ */
+
+/**
+ * Return the transpose, still orthonormal.
+ */
+template <typename M>
+constexpr orthonormal<M> transpose(const orthonormal<M>& m) {
+    return as_orthonormal(transpose(m.get()));
+}
+
+/**
+ * Return the inverse of m : its transpose.
+ */
+template <typename M>
+constexpr orthonormal<M> inv(const orthonormal<M>& m) {
+    return transpose(m);
+}
+
+/**
+ * Return m with its rounding drift removed, by one step of Björck
+ * orthonormalization, m (3 I - mᵀ m) / 2 : two matrix products.
+ * Like renormalize, call it every few thousand products along long chains.
+ */
+template <typename M>
+constexpr orthonormal<M> reorthonormalize(const orthonormal<M>& m) {
+    using T = typename M::value_type;
+
+    return as_orthonormal(m.get() * (T{1.5L} * c_identity<M> - T{0.5L} * (transpose(m.get()) * m.get())));
+}
+
+/**
+ * Product, still orthonormal up to rounding (see reorthonormalize).
+ */
+template <typename M>
+constexpr orthonormal<M> operator*(const orthonormal<M>& lhs, const orthonormal<M>& rhs) {
+    return as_orthonormal(lhs.get() * rhs.get());
+}
+
+template <typename M>
+constexpr const orthonormal<M>& operator*=(orthonormal<M>& lhs, const orthonormal<M>& rhs) {
+    lhs = lhs * rhs;
+
+    return lhs;
+}
+
+/**
+ * Products with others, on the wrapped matrix.
+ */
+template <typename M, typename B, typename = eif<! is_orthonormal<B> && ! is_unit<B>>>
+constexpr auto operator*(const orthonormal<M>& lhs, const B& rhs) {
+    return lhs.get() * rhs;
+}
+
+template <typename A, typename M, typename = eif<! is_orthonormal<A> && ! is_num<A>>>
+constexpr auto operator*(const A& lhs, const orthonormal<M>& rhs) {
+    return lhs * rhs.get();
+}
+
+/**
+ * Product with a normalized vector, which it keeps normalized.
+ */
+template <typename M, typename T, std::size_t D>
+constexpr unit<vec<T, D>> operator*(const orthonormal<M>& lhs, const unit<vec<T, D>>& rhs) {
+    return as_unit(lhs.get() * rhs.get());
+}
+
+template <typename M, typename V>
+constexpr auto linear_map(const orthonormal<M>& lhs, const V& rhs) {
+    if constexpr (is_unit<V> && V::size == M::rows) {
+        return as_unit(linear_map(lhs.get(), rhs.get()));
+    } else {
+        return linear_map(lhs.get(), detail::unwrap(rhs));
+    }
+}
+
+template <typename M, typename V>
+constexpr auto affine_map(const orthonormal<M>& lhs, const V& rhs) {
+    return affine_map(lhs.get(), detail::unwrap(rhs));
+}
+
+template <typename M>
+constexpr auto det(const orthonormal<M>& m) {
+    return det(m.get());
+}
+
+} // namespace math
+} // namespace ee
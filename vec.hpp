@@ -14,6 +14,8 @@
 
 #include <ee_utils/componentwise.hpp>
 
+#include "common.hpp"
+
 namespace ee {
 namespace math {
 
@@ -24,7 +26,7 @@ namespace math {
  */
 template <typename T, std::size_t D>
 struct vec {
-    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(is_num<T>, "T must be arithmetic type or pack");
     static_assert(D > 0, "D must be at least 1");
 
     using value_type      = T;
@@ -83,7 +85,7 @@ struct vec {
  */
 template <typename T>
 struct vec<T, 1> {
-    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(is_num<T>, "T must be arithmetic type or pack");
 
     using value_type      = T;
     using reference       = value_type&;
@@ -131,7 +133,7 @@ struct vec<T, 1> {
  */
 template <typename T>
 struct vec<T, 2> {
-    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(is_num<T>, "T must be arithmetic type or pack");
 
     using value_type      = T;
     using reference       = value_type&;
@@ -181,7 +183,7 @@ struct vec<T, 2> {
  */
 template <typename T>
 struct vec<T, 3> {
-    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(is_num<T>, "T must be arithmetic type or pack");
 
     using value_type      = T;
     using reference       = value_type&;
@@ -233,7 +235,7 @@ struct vec<T, 3> {
  */
 template <typename T>
 struct vec<T, 4> {
-    static_assert(std::is_arithmetic<T>::value, "T must be arithmetic type");
+    static_assert(is_num<T>, "T must be arithmetic type or pack");
 
     using value_type      = T;
     using reference       = value_type&;
@@ -9,8 +9,12 @@
 
 #include <cmath>
 
+#include "common.hpp"
+#include "functions.hpp"
 #include "vec.hpp"
+#include "quat.hpp"
 #include "iterators.hpp"
+#include "simd.hpp"
 
 namespace ee {
 namespace math {
@@ -21,6 +25,12 @@ namespace math {
  */
 template <typename V>
 constexpr typename V::value_type mag2(const V& v) {
+    if constexpr (simd::is_native<V>) {
+        if (! is_constant_evaluated()) {
+            return simd::dot(v, v);
+        }
+    }
+
     typename V::value_type ms{};
 
     for (auto e : v) {
@@ -35,8 +45,16 @@ constexpr typename V::value_type mag2(const V& v) {
  * Works with vec as well as quat.
  */
 template <typename V>
-typename V::value_type mag(const V& v) {
-    return std::sqrt(mag2(v));
+constexpr typename V::value_type mag(const V& v) {
+    return sqrt(mag2(v));
+}
+
+/**
+ * Return the magnitude of a given vector, with precision policy P.
+ */
+template <typename V, typename P>
+constexpr eif<is_precision<P>, typename V::value_type> mag(const V& v, P p) {
+    return sqrt(mag2(v), p);
 }
 
 /**
@@ -44,7 +62,7 @@ typename V::value_type mag(const V& v) {
  * Works with vec as well as quat.
  */
 template <typename V>
-V normalize(const V& v) {
+constexpr V normalize(const V& v) {
     typename V::value_type m = mag(v);
 
     V r = v / m;
@@ -52,11 +70,30 @@ V normalize(const V& v) {
     return r;
 }
 
+/**
+ * Return the normalized vector relative to the given one, with precision
+ * policy P. Approximations multiply by rsqrt of the squared magnitude.
+ */
+template <typename V, typename P>
+constexpr eif<is_precision<P>, V> normalize(const V& v, P p) {
+    if constexpr (std::is_same<P, precise>::value) {
+        return normalize(v);
+    } else {
+        return v * rsqrt(mag2(v), p);
+    }
+}
+
 /**
  * Return the dot product of v1 and v2.
  */
 template <typename T, std::size_t D>
 constexpr T dot(const vec<T, D>& v1, const vec<T, D>& v2) {
+    if constexpr (simd::is_native<vec<T, D>>) {
+        if (! is_constant_evaluated()) {
+            return simd::dot(v1, v2);
+        }
+    }
+
     T ms{};
 
     for (std::size_t i = 0; i < D; ++ i) {
@@ -66,6 +103,26 @@ constexpr T dot(const vec<T, D>& v1, const vec<T, D>& v2) {
     return ms;
 }
 
+/**
+ * Return the dot product of q1 and q2, seen as 4D vectors.
+ */
+template <typename T>
+constexpr T dot(const quat<T>& q1, const quat<T>& q2) {
+    if constexpr (simd::is_native<quat<T>>) {
+        if (! is_constant_evaluated()) {
+            return simd::dot(q1, q2);
+        }
+    }
+
+    T ms{};
+
+    for (std::size_t i = 0; i < 4; ++ i) {
+        ms += q1(i) * q2(i);
+    }
+
+    return ms;
+}
+
 /**
  * Return the cross product of v1 and v2.
  */
@@ -85,7 +142,7 @@ constexpr vec<T, 3> cross(const vec<T, 3>& v1, const vec<T, 3>& v2) {
  * i, pointing to the same half plane (splitted by i) as almost_j is pointing.
  */
 template <typename T>
-vec<T, 3> orthonormalize(const vec<T, 3>& i, const vec<T, 3>& almost_j) {
+constexpr vec<T, 3> orthonormalize(const vec<T, 3>& i, const vec<T, 3>& almost_j) {
     return normalize(almost_j - dot(i, almost_j) * i);
 }
 
@@ -111,5 +168,43 @@ void orthonormal_basis(const vec<T, 3>& i, const vec<T, 3>& almost_j,
     *j = cross(i, *k);
 }
 
+namespace detail {
+
+/**
+ * Tell if simd::sincos is faster than libm calls for each component, which
+ * is the case for double from 3 components, or 2 with AVX. Float libm sincos
+ * calls are about as fast as the double lanes evaluation.
+ */
+template <typename T, std::size_t D>
+constexpr bool has_simd_sincos() {
+#if EE_MATH_SSE
+    return std::is_same<T, double>::value && D <= 4 && (D >= 3 || (D == 2 && simd::has_avx));
+#else
+    return false;
+#endif
+}
+
+template <typename P, typename T, std::size_t D>
+constexpr sin_cos<vec<T, D>> sincos(const vec<T, D>& v) {
+    sin_cos<vec<T, D>> result{};
+
+    if constexpr (std::is_same<P, precise>::value && has_simd_sincos<T, D>()) {
+        if (! is_constant_evaluated() && simd::sincos(v, &result.sin, &result.cos)) {
+            return result;
+        }
+    }
+
+    for (std::size_t d = 0; d < D; ++ d) {
+        const sin_cos<T> sc = ee::math::sincos(v(d), P{});
+
+        result.sin(d) = sc.sin;
+        result.cos(d) = sc.cos;
+    }
+
+    return result;
+}
+
+} // namespace detail
+
 } // namespace math
 } // namespace ee
@@ -0,0 +1,496 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include <ee_utils/templates.hpp>
+
+#include "common.hpp"
+#include "mat.hpp"
+#include "vec.hpp"
+
+/**
+ * Views : vec and mat over memory they do not own, e.g. GPU staging buffers or
+ * mapped files, read and written in place.
+ * vec_view<T, D> sees D components stride elements apart. mat_view<T, R, C, L>
+ * sees a matrix whose columns (column_major) or rows (row_major) are stride
+ * elements apart, components of each one being contiguous. A const T gives a
+ * read-only view.
+ * strided_view<V> sees an array of vec_view or mat_view V, elements stride
+ * bytes apart from offset bytes in a buffer, as interleaved vertex attributes.
+ * Like soa references, views are proxies : assigning to one writes the viewed
+ * components. They are cheap to copy, never own memory, which must outlive
+ * them, and convert to vec or mat when a copy is wanted.
+ * view_functions.hpp has operators and functions taking them.
+ */
+
+namespace ee {
+namespace math {
+
+using tutil::eif;
+
+/**
+ * Random access iterator over components stride elements apart. It keeps an
+ * index rather than moving its pointer, so end never points past the buffer.
+ */
+template <typename T>
+class strided_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = std::remove_const_t<T>;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = T*;
+    using reference         = T&;
+
+    constexpr strided_iterator(T* p, std::ptrdiff_t stride, difference_type index = 0)
+        : m_p(p), m_stride(stride), m_index(index) {}
+
+    constexpr reference operator*() const {
+        return m_p[m_index * m_stride];
+    }
+
+    constexpr reference operator[](difference_type n) const {
+        return m_p[(m_index + n) * m_stride];
+    }
+
+    constexpr strided_iterator& operator++() {
+        ++ m_index;
+
+        return *this;
+    }
+
+    constexpr strided_iterator operator++(int) {
+        strided_iterator result = *this;
+
+        ++ m_index;
+
+        return result;
+    }
+
+    constexpr strided_iterator& operator--() {
+        -- m_index;
+
+        return *this;
+    }
+
+    constexpr strided_iterator operator--(int) {
+        strided_iterator result = *this;
+
+        -- m_index;
+
+        return result;
+    }
+
+    constexpr strided_iterator& operator+=(difference_type n) {
+        m_index += n;
+
+        return *this;
+    }
+
+    constexpr strided_iterator& operator-=(difference_type n) {
+        m_index -= n;
+
+        return *this;
+    }
+
+    constexpr strided_iterator operator+(difference_type n) const {
+        return {m_p, m_stride, m_index + n};
+    }
+
+    constexpr strided_iterator operator-(difference_type n) const {
+        return {m_p, m_stride, m_index - n};
+    }
+
+    constexpr difference_type operator-(const strided_iterator& other) const {
+        return m_index - other.m_index;
+    }
+
+    constexpr bool operator==(const strided_iterator& other) const {
+        return m_index == other.m_index;
+    }
+
+    constexpr bool operator!=(const strided_iterator& other) const {
+        return m_index != other.m_index;
+    }
+
+    constexpr bool operator<(const strided_iterator& other) const {
+        return m_index < other.m_index;
+    }
+
+private:
+    T* m_p;
+    std::ptrdiff_t m_stride;
+    difference_type m_index;
+};
+
+/**
+ * View of a D dimensions vector.
+ */
+template <typename T, std::size_t D>
+class vec_view {
+public:
+    static_assert(is_num<std::remove_const_t<T>>, "T must be arithmetic type or pack");
+    static_assert(D > 0, "D must be at least 1");
+
+    using value_type = std::remove_const_t<T>;
+    using reference  = T&;
+    using pointer    = T*;
+    using iterator   = strided_iterator<T>;
+
+    constexpr static std::size_t size = D;
+
+    /**
+     * Components p[0], p[stride], ..., p[(D - 1) * stride].
+     */
+    constexpr explicit vec_view(pointer p, std::ptrdiff_t stride = 1) : m_data(p), m_stride(stride) {}
+
+    /**
+     * View of v, which must outlive it.
+     */
+    constexpr explicit vec_view(std::conditional_t<std::is_const<T>::value, const vec<value_type, D>, vec<value_type, D>>& v)
+        : m_data(&v.data[0]), m_stride(1) {}
+
+    constexpr explicit vec_view(const vec<value_type, D>&&) = delete;
+
+    /**
+     * Read-only view of a writable one.
+     */
+    template <typename U, typename = eif<std::is_same<const U, T>::value && ! std::is_same<U, T>::value>>
+    constexpr vec_view(const vec_view<U, D>& other) : m_data(other.data()), m_stride(other.stride()) {}
+
+    constexpr vec_view(const vec_view&) = default;
+
+    /**
+     * Write v to the viewed components.
+     */
+    constexpr const vec_view& operator=(const vec<value_type, D>& v) const {
+        for (std::size_t d = 0; d < D; ++ d) {
+            (*this)(d) = v(d);
+        }
+
+        return *this;
+    }
+
+    constexpr const vec_view& operator=(const vec_view& other) const {
+        return *this = static_cast<vec<value_type, D>>(other);
+    }
+
+    template <typename U, typename = eif<std::is_same<std::remove_const_t<U>, value_type>::value>>
+    constexpr const vec_view& operator=(const vec_view<U, D>& other) const {
+        return *this = static_cast<vec<value_type, D>>(other);
+    }
+
+    /**
+     * Copy of the viewed components.
+     */
+    constexpr operator vec<value_type, D>() const {
+        vec<value_type, D> result{};
+
+        for (std::size_t d = 0; d < D; ++ d) {
+            result(d) = (*this)(d);
+        }
+
+        return result;
+    }
+
+    constexpr reference operator()(std::size_t d) const {
+        return m_data[static_cast<std::ptrdiff_t>(d) * m_stride];
+    }
+
+    constexpr reference operator[](std::size_t index) const {
+        return (*this)(index);
+    }
+
+    constexpr pointer data() const {
+        return m_data;
+    }
+
+    constexpr std::ptrdiff_t stride() const {
+        return m_stride;
+    }
+
+    constexpr iterator begin() const {
+        return {m_data, m_stride};
+    }
+
+    constexpr iterator end() const {
+        return {m_data, m_stride, static_cast<std::ptrdiff_t>(D)};
+    }
+
+private:
+    pointer m_data;
+    std::ptrdiff_t m_stride;
+};
+
+template <typename T, std::size_t D>
+vec_view(vec<T, D>&) -> vec_view<T, D>;
+
+template <typename T, std::size_t D>
+vec_view(const vec<T, D>&) -> vec_view<const T, D>;
+
+/**
+ * View of a R x C matrix in layout L.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L = column_major>
+class mat_view {
+public:
+    static_assert(is_num<std::remove_const_t<T>>, "T must be arithmetic type or pack");
+    static_assert(R > 0, "R must be at least 1");
+    static_assert(C > 0, "C must be at least 1");
+    static_assert(is_layout<L>, "L must be column_major or row_major");
+
+    using value_type = std::remove_const_t<T>;
+    using layout     = L;
+    using reference  = T&;
+    using pointer    = T*;
+
+    constexpr static std::size_t size    = R * C;
+    constexpr static std::size_t rows    = R;
+    constexpr static std::size_t columns = C;
+
+    /**
+     * Columns (column_major) or rows (row_major) stride elements apart from p,
+     * packed by default.
+     */
+    constexpr explicit mat_view(pointer p, std::ptrdiff_t stride = std::is_same<L, column_major>::value ? R : C)
+        : m_data(p), m_stride(stride) {}
+
+    /**
+     * View of M, which must outlive it.
+     */
+    constexpr explicit mat_view(
+        std::conditional_t<std::is_const<T>::value, const mat<value_type, R, C, L>, mat<value_type, R, C, L>>& M)
+        : mat_view(&M.data[0]) {}
+
+    constexpr explicit mat_view(const mat<value_type, R, C, L>&&) = delete;
+
+    /**
+     * Read-only view of a writable one.
+     */
+    template <typename U, typename = eif<std::is_same<const U, T>::value && ! std::is_same<U, T>::value>>
+    constexpr mat_view(const mat_view<U, R, C, L>& other) : m_data(other.data()), m_stride(other.stride()) {}
+
+    constexpr mat_view(const mat_view&) = default;
+
+    /**
+     * Write M to the viewed components.
+     */
+    template <typename LO>
+    constexpr const mat_view& operator=(const mat<value_type, R, C, LO>& M) const {
+        for (std::size_t c = 0; c < C; ++ c) {
+            for (std::size_t r = 0; r < R; ++ r) {
+                (*this)(r, c) = M(r, c);
+            }
+        }
+
+        return *this;
+    }
+
+    constexpr const mat_view& operator=(const mat_view& other) const {
+        return *this = static_cast<mat<value_type, R, C, L>>(other);
+    }
+
+    template <typename U, typename LO, typename = eif<std::is_same<std::remove_const_t<U>, value_type>::value>>
+    constexpr const mat_view& operator=(const mat_view<U, R, C, LO>& other) const {
+        return *this = static_cast<mat<value_type, R, C, LO>>(other);
+    }
+
+    /**
+     * Copy of the viewed components.
+     */
+    constexpr operator mat<value_type, R, C, L>() const {
+        mat<value_type, R, C, L> result{};
+
+        for (std::size_t c = 0; c < C; ++ c) {
+            for (std::size_t r = 0; r < R; ++ r) {
+                result(r, c) = (*this)(r, c);
+            }
+        }
+
+        return result;
+    }
+
+    constexpr reference operator()(std::size_t r, std::size_t c) const {
+        if constexpr (std::is_same<L, column_major>::value) {
+            return m_data[static_cast<std::ptrdiff_t>(c) * m_stride + static_cast<std::ptrdiff_t>(r)];
+        } else {
+            return m_data[static_cast<std::ptrdiff_t>(r) * m_stride + static_cast<std::ptrdiff_t>(c)];
+        }
+    }
+
+    /**
+     * Component index of a mat in layout L.
+     */
+    constexpr reference operator[](std::size_t index) const {
+        return (*this)(mat_i_to_r<L>(index, {R, C}), mat_i_to_c<L>(index, {R, C}));
+    }
+
+    constexpr pointer data() const {
+        return m_data;
+    }
+
+    constexpr std::ptrdiff_t stride() const {
+        return m_stride;
+    }
+
+private:
+    pointer m_data;
+    std::ptrdiff_t m_stride;
+};
+
+template <typename T, std::size_t R, std::size_t C, typename L>
+mat_view(mat<T, R, C, L>&) -> mat_view<T, R, C, L>;
+
+template <typename T, std::size_t R, std::size_t C, typename L>
+mat_view(const mat<T, R, C, L>&) -> mat_view<const T, R, C, L>;
+
+/**
+ * A way to identify views.
+ */
+namespace detail {
+
+template <typename>
+struct is_vec_view_impl : std::false_type {};
+
+template <typename T, std::size_t D>
+struct is_vec_view_impl<vec_view<T, D>> : std::true_type {};
+
+template <typename>
+struct is_mat_view_impl : std::false_type {};
+
+template <typename T, std::size_t R, std::size_t C, typename L>
+struct is_mat_view_impl<mat_view<T, R, C, L>> : std::true_type {};
+
+} // namespace detail
+
+template <typename T>
+constexpr bool is_vec_view = detail::is_vec_view_impl<std::decay_t<T>>::value;
+
+template <typename T>
+constexpr bool is_mat_view = detail::is_mat_view_impl<std::decay_t<T>>::value;
+
+template <typename T>
+constexpr bool is_view = is_vec_view<T> || is_mat_view<T>;
+
+/**
+ * Array of count views V, element i at byte offset + i * stride of a buffer.
+ * Components of each element are contiguous.
+ */
+template <typename V>
+class strided_view {
+    static_assert(is_view<V>, "V must be a vec_view or a mat_view");
+
+    using byte = std::conditional_t<std::is_const<std::remove_pointer_t<typename V::pointer>>::value,
+        const unsigned char, unsigned char>;
+
+public:
+    using value_type = V;
+    using buffer     = std::conditional_t<std::is_const<byte>::value, const void*, void*>;
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = V;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = V;
+
+        constexpr iterator(const strided_view* view, std::size_t index) : m_view(view), m_index(index) {}
+
+        constexpr V operator*() const {
+            return (*m_view)[m_index];
+        }
+
+        constexpr iterator& operator++() {
+            ++ m_index;
+
+            return *this;
+        }
+
+        constexpr iterator operator++(int) {
+            iterator result = *this;
+
+            ++ m_index;
+
+            return result;
+        }
+
+        constexpr bool operator==(const iterator& other) const {
+            return m_index == other.m_index;
+        }
+
+        constexpr bool operator!=(const iterator& other) const {
+            return m_index != other.m_index;
+        }
+
+    private:
+        const strided_view* m_view;
+        std::size_t m_index;
+    };
+
+    /**
+     * stride defaults to packed elements.
+     */
+    strided_view(buffer p, std::size_t count, std::size_t stride = sizeof(typename V::value_type) * V::size,
+                 std::size_t offset = 0)
+        : m_data(static_cast<byte*>(p) + offset), m_size(count), m_stride(stride) {}
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    std::size_t stride() const {
+        return m_stride;
+    }
+
+    V operator[](std::size_t i) const {
+        return V(reinterpret_cast<typename V::pointer>(m_data + i * m_stride));
+    }
+
+    iterator begin() const {
+        return {this, 0};
+    }
+
+    iterator end() const {
+        return {this, m_size};
+    }
+
+private:
+    byte* m_data;
+    std::size_t m_size;
+    std::size_t m_stride;
+};
+
+/**
+ * begin/end, cbegin/cend of iterators.hpp for views.
+ */
+template <typename T, std::size_t D>
+constexpr auto begin(vec_view<T, D> v) noexcept {
+    return v.begin();
+}
+
+template <typename T, std::size_t D>
+constexpr auto end(vec_view<T, D> v) noexcept {
+    return v.end();
+}
+
+template <typename T, std::size_t D>
+constexpr auto cbegin(vec_view<T, D> v) noexcept {
+    return vec_view<const T, D>(v).begin();
+}
+
+template <typename T, std::size_t D>
+constexpr auto cend(vec_view<T, D> v) noexcept {
+    return vec_view<const T, D>(v).end();
+}
+
+} // namespace math
+} // namespace ee
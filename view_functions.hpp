@@ -0,0 +1,461 @@
+/**
+ * Copyright (c) 2018 Gauthier ARNOULD
+ * This file is released under the zlib License (Zlib).
+ * See file LICENSE or go to https://opensource.org/licenses/Zlib
+ * for full license details.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include <ee_utils/templates.hpp>
+
+#include "common.hpp"
+#include "functions.hpp"
+#include "mat.hpp"
+#include "mat_functions.hpp"
+#include "operators.hpp"
+#include "vec.hpp"
+#include "vec_functions.hpp"
+#include "view.hpp"
+
+/**
+ * Operators and functions taking views, alone or mixed with vec and mat,
+ * reading components in place : no copy of the operands is made. Results are
+ * vec and mat, but for as_transpose which gives a view of the same memory.
+ * Overloads only apply when an operand is a view, vec and mat keep theirs.
+ */
+
+namespace ee {
+namespace math {
+
+using tutil::eif;
+
+namespace detail {
+
+template <typename T>
+constexpr bool is_vec_like = is_vec<T> || is_vec_view<T>;
+
+template <typename T>
+constexpr bool is_mat_like = is_mat<T> || is_mat_view<T>;
+
+/**
+ * vec or mat a view, or vec or mat, reads as.
+ */
+template <typename T, typename = void>
+struct owned {
+    using type = T;
+};
+
+template <typename T, std::size_t D>
+struct owned<vec_view<T, D>> {
+    using type = vec<std::remove_const_t<T>, D>;
+};
+
+template <typename T, std::size_t R, std::size_t C, typename L>
+struct owned<mat_view<T, R, C, L>> {
+    using type = mat<std::remove_const_t<T>, R, C, L>;
+};
+
+template <typename T>
+using owned_t = typename owned<std::decay_t<T>>::type;
+
+/**
+ * Two vec-like or two mat-like operands of which at least one is a view.
+ */
+template <typename A, typename B>
+constexpr bool are_view_operands =
+    (is_view<A> || is_view<B>) && ((is_vec_like<A> && is_vec_like<B>) || (is_mat_like<A> && is_mat_like<B>));
+
+/**
+ * A matrix and a vector of which at least one is a view.
+ */
+template <typename M, typename V>
+constexpr bool are_map_view_operands = (is_view<M> || is_view<V>) && is_mat_like<M> && is_vec_like<V>;
+
+/**
+ * Component of t matching index i of E data, scalars being broadcasted.
+ */
+template <typename E, typename T>
+constexpr auto view_at(const T& t, std::size_t i) {
+    if constexpr (is_num<T>) {
+        return t;
+    } else if constexpr (is_mat<E>) {
+        using L = typename E::layout;
+
+        return t(mat_i_to_r<L>(i, {E::rows, E::columns}), mat_i_to_c<L>(i, {E::rows, E::columns}));
+    } else {
+        return t(i);
+    }
+}
+
+/**
+ * E which components are f of the ones of ts.
+ */
+template <typename E, typename F, typename... Ts>
+constexpr E view_cwise(F f, const Ts&... ts) {
+    E result{};
+
+    for (std::size_t i = 0; i < E::size; ++ i) {
+        result.data[i] = f(view_at<E>(ts, i)...);
+    }
+
+    return result;
+}
+
+template <typename A, typename B>
+constexpr void check_view_operands() {
+    static_assert(std::is_same<typename owned_t<A>::value_type, typename owned_t<B>::value_type>::value,
+        "operands must have the same value type");
+
+    if constexpr (is_mat_like<A>) {
+        static_assert(owned_t<A>::rows == owned_t<B>::rows && owned_t<A>::columns == owned_t<B>::columns,
+            "operands must have the same dimensions");
+    } else {
+        static_assert(owned_t<A>::size == owned_t<B>::size, "operands must have the same dimension");
+    }
+}
+
+} // namespace detail
+
+/**
+ * Comparison operators.
+ */
+
+/**
+ * Equal.
+ */
+template <typename A, typename B, typename = eif<detail::are_view_operands<A, B>>>
+constexpr bool operator==(const A& lhs, const B& rhs) {
+    detail::check_view_operands<A, B>();
+
+    using E = detail::owned_t<A>;
+
+    for (std::size_t i = 0; i < E::size; ++ i) {
+        if (detail::view_at<E>(lhs, i) != detail::view_at<E>(rhs, i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Different.
+ */
+template <typename A, typename B, typename = eif<detail::are_view_operands<A, B>>>
+constexpr bool operator!=(const A& lhs, const B& rhs) {
+    return ! (lhs == rhs);
+}
+
+/**
+ * Arithmetic operators.
+ */
+
+/**
+ * Opposite.
+ */
+template <typename V>
+constexpr eif<is_view<V>, detail::owned_t<V>> operator-(const V& rhs) {
+    return detail::view_cwise<detail::owned_t<V>>(opp, rhs);
+}
+
+/**
+ * Addition.
+ */
+template <typename A, typename B, typename = eif<detail::are_view_operands<A, B>>>
+constexpr auto operator+(const A& lhs, const B& rhs) {
+    detail::check_view_operands<A, B>();
+
+    return detail::view_cwise<detail::owned_t<A>>(add, lhs, rhs);
+}
+
+/**
+ * Subtraction.
+ */
+template <typename A, typename B, typename = eif<detail::are_view_operands<A, B>>>
+constexpr auto operator-(const A& lhs, const B& rhs) {
+    detail::check_view_operands<A, B>();
+
+    return detail::view_cwise<detail::owned_t<A>>(sub, lhs, rhs);
+}
+
+/**
+ * Scalar multiplication.
+ */
+template <typename V, typename S>
+constexpr eif<is_view<V> && is_num<S>, detail::owned_t<V>> operator*(const V& lhs, S rhs) {
+    return detail::view_cwise<detail::owned_t<V>>(mul, lhs, static_cast<typename V::value_type>(rhs));
+}
+
+template <typename S, typename V>
+constexpr eif<is_num<S> && is_view<V>, detail::owned_t<V>> operator*(S lhs, const V& rhs) {
+    return detail::view_cwise<detail::owned_t<V>>(mul, static_cast<typename V::value_type>(lhs), rhs);
+}
+
+/**
+ * Scalar division.
+ */
+template <typename V, typename S>
+constexpr eif<is_view<V> && is_num<S>, detail::owned_t<V>> operator/(const V& lhs, S rhs) {
+    return detail::view_cwise<detail::owned_t<V>>(div, lhs, static_cast<typename V::value_type>(rhs));
+}
+
+/**
+ * Matrix-vector multiplication.
+ */
+template <typename M, typename V, typename = eif<detail::are_map_view_operands<M, V>>>
+constexpr auto operator*(const M& lhs, const V& rhs) {
+    using T = typename detail::owned_t<M>::value_type;
+
+    constexpr std::size_t R = detail::owned_t<M>::rows;
+    constexpr std::size_t C = detail::owned_t<M>::columns;
+
+    static_assert(C == detail::owned_t<V>::size, "matrix column count must be the vector dimension");
+
+    vec<T, R> result{};
+
+    for (std::size_t r = 0; r < R; ++ r) {
+        for (std::size_t c = 0; c < C; ++ c) {
+            result(r) += lhs(r, c) * rhs(c);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Matrix-matrix multiplication, result has the layout of lhs.
+ */
+template <typename A, typename B,
+          typename = eif<(is_view<A> || is_view<B>) && detail::is_mat_like<A> && detail::is_mat_like<B>>,
+          typename = void>
+constexpr auto operator*(const A& lhs, const B& rhs) {
+    using T = typename detail::owned_t<A>::value_type;
+
+    constexpr std::size_t R  = detail::owned_t<A>::rows;
+    constexpr std::size_t LC = detail::owned_t<A>::columns;
+    constexpr std::size_t RC = detail::owned_t<B>::columns;
+
+    static_assert(LC == detail::owned_t<B>::rows, "lhs column count must be rhs row count");
+
+    mat<T, R, RC, typename detail::owned_t<A>::layout> result{};
+
+    for (std::size_t k = 0; k < RC; ++ k) {
+        for (std::size_t j = 0; j < R; ++ j) {
+            for (std::size_t i = 0; i < LC; ++ i) {
+                result(j, k) += lhs(j, i) * rhs(i, k);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Compound operators, writing to the viewed components.
+ */
+
+template <typename V, typename B, typename = eif<is_view<V> && detail::are_view_operands<V, B>>>
+constexpr V operator+=(V lhs, const B& rhs) {
+    lhs = lhs + rhs;
+
+    return lhs;
+}
+
+template <typename V, typename B, typename = eif<is_view<V> && detail::are_view_operands<V, B>>>
+constexpr V operator-=(V lhs, const B& rhs) {
+    lhs = lhs - rhs;
+
+    return lhs;
+}
+
+template <typename V, typename S, typename = eif<is_view<V> && is_num<S>>>
+constexpr V operator*=(V lhs, S rhs) {
+    lhs = lhs * rhs;
+
+    return lhs;
+}
+
+template <typename V, typename S, typename = eif<is_view<V> && is_num<S>>>
+constexpr V operator/=(V lhs, S rhs) {
+    lhs = lhs / rhs;
+
+    return lhs;
+}
+
+/**
+ * Vector functions.
+ */
+
+/**
+ * Return the dot product of v1 and v2.
+ */
+template <typename A, typename B, typename = eif<detail::are_view_operands<A, B> && detail::is_vec_like<A>>>
+constexpr auto dot(const A& v1, const B& v2) {
+    detail::check_view_operands<A, B>();
+
+    typename detail::owned_t<A>::value_type ms{};
+
+    for (std::size_t i = 0; i < detail::owned_t<A>::size; ++ i) {
+        ms += v1(i) * v2(i);
+    }
+
+    return ms;
+}
+
+/**
+ * Return the cross product of v1 and v2.
+ */
+template <typename A, typename B, typename = eif<detail::are_view_operands<A, B> && detail::is_vec_like<A>>>
+constexpr auto cross(const A& v1, const B& v2) {
+    detail::check_view_operands<A, B>();
+    static_assert(detail::owned_t<A>::size == 3, "cross product needs 3D vectors");
+
+    return detail::owned_t<A>{
+        v1(1) * v2(2) - v1(2) * v2(1),
+        v1(2) * v2(0) - v1(0) * v2(2),
+        v1(0) * v2(1) - v1(1) * v2(0)};
+}
+
+/**
+ * Return the normalized vector relative to the viewed one, mag and mag2 take
+ * views as is.
+ */
+template <typename T, std::size_t D>
+constexpr auto normalize(const vec_view<T, D>& v) {
+    return v / mag(v);
+}
+
+template <typename T, std::size_t D, typename P>
+constexpr eif<is_precision<P>, vec<std::remove_const_t<T>, D>> normalize(const vec_view<T, D>& v, P p) {
+    if constexpr (std::is_same<P, precise>::value) {
+        return normalize(v);
+    } else {
+        return v * rsqrt(mag2(v), p);
+    }
+}
+
+/**
+ * Matrix functions.
+ */
+
+/**
+ * Return the transpose of a viewed matrix, in the same layout.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto transpose(const mat_view<T, R, C, L>& M) {
+    return detail::transpose<std::remove_const_t<T>, R, C, L>(M, std::make_index_sequence<R * C>());
+}
+
+/**
+ * Return a view of the transpose in the other layout, over the same memory.
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto as_transpose(const mat_view<T, R, C, L>& M) {
+    return mat_view<T, C, R, transposed_layout<L>>(M.data(), M.stride());
+}
+
+/**
+ * Return the trace of a viewed square matrix.
+ */
+template <typename T, std::size_t D, typename L>
+constexpr auto trace(const mat_view<T, D, D, L>& M) {
+    std::remove_const_t<T> sum{};
+
+    for (std::size_t d = 0ul; d < D; ++ d) {
+        sum += M(d, d);
+    }
+
+    return sum;
+}
+
+/**
+ * Return the matrix obtained by removing row rc(0) and column rc(1).
+ */
+template <typename T, std::size_t R, std::size_t C, typename L>
+constexpr auto cut(const mat_view<T, R, C, L>& M, const vec<std::size_t, 2>& rc) {
+    static_assert(R > 1 && C > 1, "cannot cut a single row or column matrix");
+
+    return detail::cut<std::remove_const_t<T>, R, C, L>(M, rc, std::make_index_sequence<(R - 1) * (C - 1)>());
+}
+
+/**
+ * Return determinant of a viewed square matrix, as det of mat does : from 5x5
+ * floating point ones are copied for LU factorization.
+ */
+template <typename T, std::size_t D, typename L>
+constexpr auto det(const mat_view<T, D, D, L>& M) {
+    using U = std::remove_const_t<T>;
+
+    if constexpr (D == 1) {
+        return M(0, 0);
+    }
+    else if constexpr (D == 2) {
+        return M(0, 0) * M(1, 1) - M(0, 1) * M(1, 0);
+    }
+    else if constexpr (D >= 5 && std::is_floating_point<U>::value) {
+        return det(static_cast<mat<U, D, D, L>>(M));
+    }
+    else {
+        U result{U{0L}};
+
+        for (std::size_t d = 0ul; d < D; ++ d) {
+            result +=
+                ((d & 1) ? - U{1L} : U{1L})
+                * M(0, d)
+                * det(cut(M, {0, d}));
+        }
+
+        return result;
+    }
+}
+
+/**
+ * Transformations.
+ */
+
+template <std::size_t DO, typename M, typename V, typename = eif<detail::are_map_view_operands<M, V>>>
+constexpr auto linear_map_to(const M& lhs, const V& rhs) {
+    using W = detail::owned_t<M>;
+
+    return detail::linear_map_to<DO, typename W::value_type, W::rows, W::columns, detail::owned_t<V>::size>::from(
+        lhs, rhs);
+}
+
+template <typename M, typename V, typename = eif<detail::are_map_view_operands<M, V>>>
+constexpr auto linear_map(const M& lhs, const V& rhs) {
+    return linear_map_to<detail::owned_t<V>::size>(lhs, rhs);
+}
+
+template <std::size_t DO, typename M, typename V, typename = eif<detail::are_map_view_operands<M, V>>>
+constexpr auto affine_map_to(const M& lhs, const V& rhs) {
+    using W = detail::owned_t<M>;
+
+    return detail::affine_map_to<DO, typename W::value_type, W::rows, W::columns, detail::owned_t<V>::size>::from(
+        lhs, rhs);
+}
+
+template <typename M, typename V, typename = eif<detail::are_map_view_operands<M, V>>>
+constexpr auto affine_map(const M& lhs, const V& rhs) {
+    return affine_map_to<detail::owned_t<V>::size>(lhs, rhs);
+}
+
+template <std::size_t DO, typename M, typename V, typename = eif<detail::are_map_view_operands<M, V>>>
+constexpr auto projective_map_to(const M& lhs, const V& rhs) {
+    using W = detail::owned_t<M>;
+
+    return detail::projective_map_to<DO, typename W::value_type, W::rows, W::columns, detail::owned_t<V>::size>::from(
+        lhs, rhs);
+}
+
+template <typename M, typename V, typename = eif<detail::are_map_view_operands<M, V>>>
+constexpr auto projective_map(const M& lhs, const V& rhs) {
+    return projective_map_to<detail::owned_t<V>::size>(lhs, rhs);
+}
+
+} // namespace math
+} // namespace ee